@@ -8,8 +8,10 @@
  * 参考文档: https://ffmpeg.org/doxygen/trunk/filter_audio_8c-example.html
  */
 
+#include <chrono>
 #include <cstdlib>
 #include <cassert>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <glog/logging.h>
@@ -24,6 +26,36 @@ extern "C" {
 #include <libavutil/opt.h>
 }
 
+// 每次送入滤镜图的默认采样数，较大的块可以减少每块的固定开销
+constexpr int kDefaultChunkSamples = 4096;
+
+/**
+ * 送入滤镜图的frame的内存来源
+ */
+enum class FrameSource {
+    // 每块调用av_frame_get_buffer分配内存并复制数据
+    kFrameGetBuffer,
+    // 从AVBufferPool中复用内存并复制数据，避免每块一次分配
+    kBufferPool,
+    // 直接引用调用者的原始数据，既不分配也不复制
+    kWrapInput,
+};
+
+static const char* frameSourceName(FrameSource frameSource) {
+    switch (frameSource) {
+        case FrameSource::kFrameGetBuffer:
+            return "frame_get_buffer";
+        case FrameSource::kBufferPool:
+            return "buffer_pool";
+        case FrameSource::kWrapInput:
+            return "wrap_input";
+    }
+    return "unknown";
+}
+
+// 原始数据由调用者管理，引用计数归零时无需释放
+static void noopFree(void* opaque, uint8_t* data) {}
+
 /**
  * 对音频进行变速处理
  *
@@ -35,6 +67,8 @@ extern "C" {
  * @param channelCount 原始数据声道数
  * @param sampleRate 原始数据采样率
  * @param sampleFormat 原始数据格式
+ * @param chunkSamples 每次送入滤镜图的采样数
+ * @param frameSource frame的内存来源，kWrapInput时原始数据在函数返回前不能修改
  * @return 是否变速成功
  */
 bool timeStretch(const void* srcData,
@@ -44,7 +78,9 @@ bool timeStretch(const void* srcData,
                  float tempo = 1.0,
                  int64_t channelLayout = AV_CH_LAYOUT_MONO,
                  int sampleRate = 16000,
-                 AVSampleFormat sampleFormat = AV_SAMPLE_FMT_S16) {
+                 AVSampleFormat sampleFormat = AV_SAMPLE_FMT_S16,
+                 int chunkSamples = kDefaultChunkSamples,
+                 FrameSource frameSource = FrameSource::kWrapInput) {
     // Set up the filter graph.
     // The filter chain it uses is:
     // (input) -> abuffer -> atempo -> aformat -> abuffersink -> (output)
@@ -60,6 +96,10 @@ bool timeStretch(const void* srcData,
         LOG(ERROR) << "Invalid tempo param, tempo " << tempo;
         return false;
     }
+    if (chunkSamples <= 0) {
+        LOG(ERROR) << "Invalid chunk samples param, chunkSamples " << chunkSamples;
+        return false;
+    }
     AVFilterGraph* filterGraph = nullptr;
     const AVFilter* abuffer;
     AVFilterContext* abufferCtx = nullptr;
@@ -274,33 +314,73 @@ bool timeStretch(const void* srcData,
         }
     };
 
+    // kBufferPool: 每块从池中取一块内存，滤镜图释放frame后内存回到池中复用
+    // kWrapInput: 用一个AVBufferRef包装整块原始数据，每块只增加引用计数，
+    // 标记为只读，滤镜需要修改数据时会自行复制
+    AVBufferPool* bufferPool = nullptr;
+    AVBufferRef* inputBuffer = nullptr;
+    if (frameSource == FrameSource::kBufferPool) {
+        bufferPool = av_buffer_pool_init(chunkSamples * bytesPerSample, nullptr);
+    } else if (frameSource == FrameSource::kWrapInput) {
+        inputBuffer = av_buffer_create((uint8_t*) srcData, srcSize,
+                                       noopFree, nullptr, AV_BUFFER_FLAG_READONLY);
+    }
+    if (frameSource != FrameSource::kFrameGetBuffer && !bufferPool && !inputBuffer) {
+        LOG(ERROR) << "Error allocating the frame buffer";
+        free(tempDestData);
+        av_frame_free(&frame);
+        clearFFmpegFilters();
+        return false;
+    }
+    auto releaseFrameBuffers = [&bufferPool, &inputBuffer]() ->void {
+        // 仍被引用的内存在引用释放时才真正释放
+        if (bufferPool)
+            av_buffer_pool_uninit(&bufferPool);
+        if (inputBuffer)
+            av_buffer_unref(&inputBuffer);
+    };
+
     bool flushed = false;
     while (srcIndex < srcSize && !flushed) {
         frame->sample_rate = sampleRate;
         frame->format = sampleFormat;
         frame->channel_layout = channelLayout;
         frame->channels = 1;
-        frame->nb_samples = 1024;
+        frame->nb_samples = chunkSamples;
         // 存在srcSize - srcIndex < frame->nb_samples * bytesPerSamples的情况
         if (srcSize - srcIndex < frame->nb_samples * bytesPerSample) {
             flushed = true;
             int samplesLeft = int(srcSize - srcIndex) / bytesPerSample;
             frame->nb_samples = samplesLeft;
         }
-        err = av_frame_get_buffer(frame, 0);
+        int chunkSize = frame->nb_samples * bytesPerSample;
+        if (frameSource == FrameSource::kFrameGetBuffer) {
+            err = av_frame_get_buffer(frame, 0);
+        } else {
+            frame->buf[0] = bufferPool ? av_buffer_pool_get(bufferPool)
+                                       : av_buffer_ref(inputBuffer);
+            err = frame->buf[0] ? 0 : AVERROR(ENOMEM);
+            if (err >= 0) {
+                frame->data[0] = bufferPool ? frame->buf[0]->data
+                                            : frame->buf[0]->data + srcIndex;
+                frame->extended_data = frame->data;
+                frame->linesize[0] = chunkSize;
+            }
+        }
         if (err < 0) {
             LOG(ERROR) << "Error frame get buffer";
             free(tempDestData);
             av_frame_free(&frame);
+            releaseFrameBuffers();
             clearFFmpegFilters();
             return false;
         }
 
-        // 将数据复制进入frame中
-        memcpy(frame->extended_data[0],
-               ((char*)srcData) + srcIndex,
-               frame->nb_samples * bytesPerSample);
-        srcIndex += frame->nb_samples * bytesPerSample;
+        // 将数据复制进入frame中，kWrapInput时frame已经指向原始数据
+        if (!inputBuffer) {
+            memcpy(frame->extended_data[0], ((char*)srcData) + srcIndex, chunkSize);
+        }
+        srcIndex += chunkSize;
 
         // Send the frame to the input of the filter graph.
         err = av_buffersrc_add_frame(abufferCtx, frame);
@@ -324,12 +404,43 @@ bool timeStretch(const void* srcData,
     destSize = destIndex;
 
     clearFFmpegFilters();
+    releaseFrameBuffers();
     av_frame_free(&frame);
     return true;
 }
 
+/**
+ * 比较不同块大小和frame内存来源下每秒处理的块数
+ */
+static void benchmark(const void* srcData, size_t srcSize, float tempo) {
+    const int bytesPerSample = av_get_bytes_per_sample(AV_SAMPLE_FMT_S16);
+    const int iterations = 5;
+    for (int chunkSamples : {1024, 4096, 16384}) {
+        for (FrameSource frameSource : {FrameSource::kFrameGetBuffer,
+                                        FrameSource::kBufferPool,
+                                        FrameSource::kWrapInput}) {
+            size_t chunkSize = size_t(chunkSamples) * bytesPerSample;
+            size_t chunks = (srcSize + chunkSize - 1) / chunkSize * iterations;
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < iterations; i++) {
+                void* destData = nullptr;
+                size_t destSize = 0;
+                timeStretch(srcData, srcSize, &destData, destSize, tempo,
+                            AV_CH_LAYOUT_MONO, 16000, AV_SAMPLE_FMT_S16,
+                            chunkSamples, frameSource);
+                free(destData);
+            }
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            LOG(INFO) << "chunkSamples " << chunkSamples
+                      << " " << frameSourceName(frameSource)
+                      << ": " << chunks / elapsed.count() << " chunks/s";
+        }
+    }
+}
+
 int main(int argc, char* argv[]) {
-    assert(argc == 2);
+    // 用法: TimeStretchEffect <pcm文件> [--benchmark]
+    assert(argc == 2 || argc == 3);
     // Initialize Google’s logging library.
     google::InitGoogleLogging(argv[0]);
     FLAGS_stderrthreshold = google::GLOG_INFO;
@@ -343,6 +454,12 @@ int main(int argc, char* argv[]) {
     ifs.read((char*) bufferData, (long) bufferSize);
 
     float tempo = 0.6;
+    if (argc == 3 && strcmp(argv[2], "--benchmark") == 0) {
+        benchmark(bufferData, bufferSize, tempo);
+        free(bufferData);
+        return EXIT_SUCCESS;
+    }
+
     void* destData = nullptr;
     size_t destSize = 0;
     bool ret = timeStretch(bufferData, bufferSize, &destData, destSize, tempo);
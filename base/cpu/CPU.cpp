@@ -0,0 +1,79 @@
+//
+// Created by wang rl on 2022/7/4.
+//
+
+#include <cstdint>
+#include "base/cpu/CPU.h"
+
+#if defined(ARCH_CPU_X86_FAMILY)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>  // For _xgetbv()
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace mm {
+#if defined(ARCH_CPU_X86_FAMILY)
+    // Obtain the CPUID information for |leaf| and sub leaf 0.
+    static void CpuId(uint32_t leaf, uint32_t regs[4]) {
+#if defined(_MSC_VER)
+        __cpuidex(reinterpret_cast<int*>(regs), static_cast<int>(leaf), 0);
+#else
+        __cpuid_count(leaf, 0, regs[0], regs[1], regs[2], regs[3]);
+#endif
+    }
+
+    // Returns the contents of the extended control register 0, the bits of
+    // which tell us whether the OS saves the YMM registers on context switch.
+    static uint64_t XGetBV() {
+#if defined(_MSC_VER)
+        return _xgetbv(0);
+#else
+        uint32_t eax, edx;
+        __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+        return (static_cast<uint64_t>(edx) << 32) | eax;
+#endif
+    }
+#endif
+
+    CPU::CPU() {
+        initialize();
+    }
+
+    const CPU& CPU::Get() {
+        static const CPU cpu;
+        return cpu;
+    }
+
+    void CPU::initialize() {
+#if defined(ARCH_CPU_X86_FAMILY)
+        uint32_t regs[4] = {0, 0, 0, 0};
+        CpuId(0, regs);
+        const uint32_t max_leaf = regs[0];
+        if (max_leaf < 1)
+            return;
+
+        CpuId(1, regs);
+        const uint32_t ecx = regs[2];
+        const uint32_t edx = regs[3];
+
+        has_sse2_ = (edx & (1u << 26)) != 0;
+        has_sse41_ = (ecx & (1u << 19)) != 0;
+
+        // AVX instructions also require the OS to enable the YMM state, check
+        // both OSXSAVE and the XCR0 bits for XMM and YMM.
+        const bool os_saves_ymm = (ecx & (1u << 27)) != 0 &&
+                                  (XGetBV() & 6) == 6;
+        has_avx_ = os_saves_ymm && (ecx & (1u << 28)) != 0;
+        has_fma3_ = has_avx_ && (ecx & (1u << 12)) != 0;
+        has_f16c_ = has_avx_ && (ecx & (1u << 29)) != 0;
+
+        if (max_leaf >= 7) {
+            CpuId(7, regs);
+            has_avx2_ = has_avx_ && (regs[1] & (1u << 5)) != 0;
+        }
+#endif
+    }
+}
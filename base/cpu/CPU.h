@@ -0,0 +1,48 @@
+//
+// Created by wang rl on 2022/7/4.
+//
+
+#ifndef MULTIMEDIA_CPU_H
+#define MULTIMEDIA_CPU_H
+
+#include "base/utils/BuildConfig.h"
+
+namespace mm {
+    // Query information about the processor. The CPUID instruction is only
+    // executed once, the result is cached by Get().
+    class CPU {
+    public:
+        CPU();
+
+        // Returns the CPU of the current process, the flags are computed the first
+        // time this is called. Thread safe.
+        static const CPU& Get();
+
+        bool has_sse2() const { return has_sse2_; }
+
+        bool has_sse41() const { return has_sse41_; }
+
+        // The AVX and AVX2 flags also take the operating system support for saving
+        // the YMM registers into account.
+        bool has_avx() const { return has_avx_; }
+
+        bool has_avx2() const { return has_avx2_; }
+
+        bool has_fma3() const { return has_fma3_; }
+
+        bool has_f16c() const { return has_f16c_; }
+
+    private:
+        // Query the processor for CPUID information.
+        void initialize();
+
+        bool has_sse2_ = false;
+        bool has_sse41_ = false;
+        bool has_avx_ = false;
+        bool has_avx2_ = false;
+        bool has_fma3_ = false;
+        bool has_f16c_ = false;
+    };
+}
+
+#endif //MULTIMEDIA_CPU_H
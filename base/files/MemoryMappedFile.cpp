@@ -0,0 +1,138 @@
+//
+// Created by wang rl on 2022/7/18.
+//
+
+#include <glog/logging.h>
+#include "base/files/MemoryMappedFile.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace mm {
+    MemoryMappedFile::MemoryMappedFile() = default;
+
+    MemoryMappedFile::~MemoryMappedFile() {
+        CloseHandles();
+    }
+
+#if defined(_WIN32)
+    bool MemoryMappedFile::Initialize(const std::string& path) {
+        DCHECK(!valid_) << "Initialize() called twice";
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            DLOG(ERROR) << "Couldn't open " << path;
+            return false;
+        }
+        file_ = file;
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size)) {
+            DLOG(ERROR) << "Couldn't get the size of " << path;
+            CloseHandles();
+            return false;
+        }
+        length_ = static_cast<size_t>(size.QuadPart);
+        if (length_ == 0) {
+            // Empty files can't be mapped.
+            valid_ = true;
+            return true;
+        }
+
+        file_mapping_ = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (file_mapping_)
+            data_ = static_cast<uint8_t*>(MapViewOfFile(file_mapping_, FILE_MAP_READ, 0, 0, 0));
+        if (!data_) {
+            DLOG(ERROR) << "Couldn't map " << path;
+            CloseHandles();
+            return false;
+        }
+        valid_ = true;
+        return true;
+    }
+
+    void MemoryMappedFile::Advise(Access access) const {}
+
+    void MemoryMappedFile::CloseHandles() {
+        if (data_)
+            UnmapViewOfFile(data_);
+        if (file_mapping_)
+            CloseHandle(file_mapping_);
+        if (file_)
+            CloseHandle(file_);
+        data_ = nullptr;
+        file_mapping_ = nullptr;
+        file_ = nullptr;
+        length_ = 0;
+        valid_ = false;
+    }
+#else
+    bool MemoryMappedFile::Initialize(const std::string& path) {
+        DCHECK(!valid_) << "Initialize() called twice";
+        const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            DLOG(ERROR) << "Couldn't open " << path;
+            return false;
+        }
+
+        struct stat info{};
+        if (fstat(fd, &info) != 0 || info.st_size < 0) {
+            DLOG(ERROR) << "Couldn't get the size of " << path;
+            close(fd);
+            return false;
+        }
+        length_ = static_cast<size_t>(info.st_size);
+        if (length_ == 0) {
+            // Empty files can't be mapped.
+            close(fd);
+            valid_ = true;
+            return true;
+        }
+
+        void* data = mmap(nullptr, length_, PROT_READ, MAP_SHARED, fd, 0);
+        // The mapping keeps its own reference to the file.
+        close(fd);
+        if (data == MAP_FAILED) {
+            DLOG(ERROR) << "Couldn't map " << path;
+            length_ = 0;
+            return false;
+        }
+        data_ = static_cast<uint8_t*>(data);
+        valid_ = true;
+        return true;
+    }
+
+    void MemoryMappedFile::Advise(Access access) const {
+        if (!data_)
+            return;
+        int advice = MADV_NORMAL;
+        switch (access) {
+            case Access::kNormal:
+                advice = MADV_NORMAL;
+                break;
+            case Access::kSequential:
+                advice = MADV_SEQUENTIAL;
+                break;
+            case Access::kRandom:
+                advice = MADV_RANDOM;
+                break;
+        }
+        // Only a hint, failures don't matter.
+        madvise(data_, length_, advice);
+    }
+
+    void MemoryMappedFile::CloseHandles() {
+        if (data_)
+            munmap(data_, length_);
+        data_ = nullptr;
+        length_ = 0;
+        valid_ = false;
+    }
+#endif
+}
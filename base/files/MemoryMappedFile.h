@@ -0,0 +1,63 @@
+//
+// Created by wang rl on 2022/7/18.
+//
+
+#ifndef MULTIMEDIA_MEMORY_MAPPED_FILE_H
+#define MULTIMEDIA_MEMORY_MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace mm {
+    // Maps a whole file read-only into memory. Pages are loaded by the kernel on
+    // first access and shared with the page cache, so nothing is copied up
+    // front. The mapping is immutable and may be read by several threads, e.g.
+    // shared between readers through a std::shared_ptr.
+    class MemoryMappedFile {
+    public:
+        // How the mapping is going to be accessed, a hint for read-ahead.
+        enum class Access {
+            kNormal,
+            // Read mostly front to back, e.g. while decoding.
+            kSequential,
+            kRandom,
+        };
+
+        MemoryMappedFile();
+
+        ~MemoryMappedFile();
+
+        // Maps the file at |path|. Returns false if the file can't be opened or
+        // mapped. Must be called at most once.
+        bool Initialize(const std::string& path);
+
+        // Passes |access| to the kernel for the whole mapping, a no-op where
+        // that isn't supported.
+        void Advise(Access access) const;
+
+        const uint8_t* data() const { return data_; }
+
+        size_t length() const { return length_; }
+
+        // An empty file is valid, with a null data() and length() 0.
+        bool IsValid() const { return valid_; }
+
+        MemoryMappedFile(const MemoryMappedFile&) = delete;
+
+        MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+
+    private:
+        void CloseHandles();
+
+        uint8_t* data_ = nullptr;
+        size_t length_ = 0;
+        bool valid_ = false;
+#if defined(_WIN32)
+        void* file_ = nullptr;
+        void* file_mapping_ = nullptr;
+#endif
+    };
+}
+
+#endif //MULTIMEDIA_MEMORY_MAPPED_FILE_H
@@ -2,24 +2,143 @@
 // Created by wang rl on 2022/6/13.
 //
 
+#include <algorithm>
+#include <atomic>
 #include "base/utils/Bits.h"
 #include "base/memory/AlignedMemory.h"
 
+#if defined(__linux__)
+#include <mutex>
+#include <unordered_map>
+#include <sys/mman.h>
+#endif
+
 namespace mm {
-    void* AlignedAlloc(size_t size, size_t alignment) {
+    static std::atomic<size_t> gHugePageThreshold{kDefaultHugePageThreshold};
+
+    // Stored right before every heap allocation, so AlignedFree() knows what to
+    // account and where the underlying block starts.
+    struct AllocationHeader {
+        size_t size;
+        uint32_t offset;
+        uint32_t tag;
+    };
+
+    static constexpr size_t kHeaderSize = 16;
+
+    static_assert(sizeof(AllocationHeader) <= kHeaderSize,
+                  "AllocationHeader must fit in front of a 16 byte aligned block");
+
+#if defined(__linux__)
+    struct HugePageMapping {
+        size_t size;
+        size_t requestedSize;
+        MemoryTag tag;
+    };
+
+    // The live huge page mappings. free() can't tell these apart from heap
+    // memory, so AlignedFree() looks up 2 MB aligned pointers here; the map is
+    // only touched for large allocations.
+    static std::mutex gHugePageLock;
+
+    static std::unordered_map<void*, HugePageMapping>& HugePageMappings() {
+        static auto* mappings = new std::unordered_map<void*, HugePageMapping>();
+        return *mappings;
+    }
+
+    // Returns nullptr if the mapping fails, the caller falls back to the heap.
+    static void* HugePageAlloc(size_t requestedSize, MemoryTag tag) {
+        // Round up to whole huge pages, then over-allocate by one page to be able
+        // to cut out a 2 MB aligned range.
+        const size_t size = (requestedSize + kHugePageSize - 1) & ~(kHugePageSize - 1);
+        const size_t mappedSize = size + kHugePageSize;
+        void* mapped = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mapped == MAP_FAILED) {
+            DLOG(ERROR) << "mmap() of " << mappedSize << " bytes failed";
+            return nullptr;
+        }
+
+        const auto begin = reinterpret_cast<uintptr_t>(mapped);
+        const uintptr_t aligned = (begin + kHugePageSize - 1) & ~(kHugePageSize - 1);
+        if (aligned > begin)
+            munmap(mapped, aligned - begin);
+        if (const size_t tail = begin + mappedSize - (aligned + size))
+            munmap(reinterpret_cast<void*>(aligned + size), tail);
+
+        void* ptr = reinterpret_cast<void*>(aligned);
+        // Only a hint, the kernel may not support or may have disabled THP.
+        madvise(ptr, size, MADV_HUGEPAGE);
+
+        {
+            std::lock_guard<std::mutex> lock(gHugePageLock);
+            HugePageMappings().emplace(ptr, HugePageMapping{size, requestedSize, tag});
+        }
+        internal::RecordAllocation(tag, requestedSize);
+        return ptr;
+    }
+
+    // Returns false if |ptr| is not a huge page mapping.
+    static bool HugePageFree(void* ptr) {
+        if (!IsAligned(ptr, kHugePageSize))
+            return false;
+        HugePageMapping mapping;
+        {
+            std::lock_guard<std::mutex> lock(gHugePageLock);
+            auto it = HugePageMappings().find(ptr);
+            if (it == HugePageMappings().end())
+                return false;
+            mapping = it->second;
+            HugePageMappings().erase(it);
+        }
+        internal::RecordFree(mapping.tag, mapping.requestedSize);
+        munmap(ptr, mapping.size);
+        return true;
+    }
+#endif
+
+    void SetHugePageThreshold(size_t bytes) {
+        gHugePageThreshold.store(bytes, std::memory_order_relaxed);
+    }
+
+    size_t HugePageThreshold() {
+        return gHugePageThreshold.load(std::memory_order_relaxed);
+    }
+
+    void* AlignedAlloc(size_t size, size_t alignment, MemoryTag tag) {
         DCHECK_GT(size, 0U);
         DCHECK(IsPowerOfTwo(alignment));
         DCHECK_EQ(alignment % sizeof(void*), 0U);
         void* ptr = nullptr;
+#if defined(__linux__)
+        const size_t threshold = HugePageThreshold();
+        if (threshold > 0 && size >= threshold && alignment <= kHugePageSize)
+            ptr = HugePageAlloc(size, tag);
+        if (ptr)
+            return ptr;
+#endif
+        // Reserve room for the header in front of the returned block, keeping it
+        // aligned.
+        const size_t offset = std::max(alignment, kHeaderSize);
+        void* block = nullptr;
 #if defined(_MSC_VER)
-        ptr = _aligned_malloc(size, alignment);
+        block = _aligned_malloc(size + offset, alignment);
 #else
-        int ret = posix_memalign(&ptr, alignment, size);
+        int ret = posix_memalign(&block, alignment, size + offset);
         if (ret != 0) {
             DLOG(ERROR) << "posix_memalign() returned with error " << ret;
-            ptr = nullptr;
+            block = nullptr;
         }
 #endif
+        if (block) {
+            ptr = static_cast<uint8_t*>(block) + offset;
+            auto* header = reinterpret_cast<AllocationHeader*>(
+                    static_cast<uint8_t*>(ptr) - kHeaderSize);
+            header->size = size;
+            header->offset = static_cast<uint32_t>(offset);
+            header->tag = static_cast<uint32_t>(tag);
+            internal::RecordAllocation(tag, size);
+        }
 
         // Since aligned allocations may fail for non-memory related reasons, force a
         // crash if we encounter a failed allocation; maintaining consistent behavior
@@ -34,4 +153,22 @@ namespace mm {
         DCHECK(IsAligned(ptr, alignment));
         return ptr;
     }
+
+    void AlignedFree(void* ptr) {
+        if (!ptr)
+            return;
+#if defined(__linux__)
+        if (HugePageFree(ptr))
+            return;
+#endif
+        const auto* header = reinterpret_cast<const AllocationHeader*>(
+                static_cast<uint8_t*>(ptr) - kHeaderSize);
+        internal::RecordFree(static_cast<MemoryTag>(header->tag), header->size);
+        void* block = static_cast<uint8_t*>(ptr) - header->offset;
+#if defined(_MSC_VER)
+        _aligned_free(block);
+#else
+        free(block);
+#endif
+    }
 }
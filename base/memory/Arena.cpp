@@ -0,0 +1,85 @@
+//
+// Created by wang rl on 2022/7/15.
+//
+
+#include <algorithm>
+#include "base/utils/Bits.h"
+#include "base/memory/Arena.h"
+
+namespace mm {
+    Arena::Scope::Scope(Arena* arena)
+            : arena_(arena), chunk_(arena->chunk_), offset_(arena->offset_) {}
+
+    Arena::Scope::~Scope() {
+        DCHECK(arena_->chunk_ > chunk_ ||
+               (arena_->chunk_ == chunk_ && arena_->offset_ >= offset_))
+            << "Arena scopes must be destroyed in reverse order";
+        arena_->chunk_ = chunk_;
+        arena_->offset_ = offset_;
+    }
+
+    Arena::Arena(size_t chunk_size, MemoryTag tag) : chunk_size_(chunk_size), tag_(tag) {
+        CHECK_GT(chunk_size, 0U);
+    }
+
+    Arena::~Arena() = default;
+
+    void* Arena::Allocate(size_t size, size_t alignment) {
+        DCHECK(IsPowerOfTwo(alignment)) << alignment << " is not a power of 2";
+        // Bump the offset in the current chunk; if the allocation doesn't fit,
+        // continue with the next chunk left over from before a rewind, or add a
+        // new one.
+        for (; chunk_ < chunks_.size(); ++chunk_, offset_ = 0) {
+            const Chunk& chunk = chunks_[chunk_];
+            const auto base = reinterpret_cast<uintptr_t>(chunk.data.get());
+            const uintptr_t aligned = (base + offset_ + alignment - 1) & ~(alignment - 1);
+            if (aligned - base + size <= chunk.size) {
+                offset_ = aligned - base + size;
+                return reinterpret_cast<void*>(aligned);
+            }
+        }
+
+        // Chunks are aligned by kChunkAlignment, larger alignments may need
+        // padding.
+        const size_t padding = alignment > kChunkAlignment ? alignment : 0;
+        Chunk chunk;
+        chunk.size = std::max(chunk_size_, size + padding);
+        // AlignedAlloc() may require a multiple of the alignment as size.
+        chunk.size = (chunk.size + kChunkAlignment - 1) & ~(kChunkAlignment - 1);
+        chunk.data.reset(static_cast<uint8_t*>(
+                AlignedAlloc(chunk.size, kChunkAlignment, tag_)));
+        chunks_.push_back(std::move(chunk));
+        chunk_ = chunks_.size() - 1;
+        offset_ = 0;
+        return Allocate(size, alignment);
+    }
+
+    void Arena::Reset() {
+        chunk_ = 0;
+        offset_ = 0;
+    }
+
+    void Arena::Release() {
+        chunks_.clear();
+        Reset();
+    }
+
+    size_t Arena::bytes_used() const {
+        size_t used = offset_;
+        for (size_t i = 0; i < chunk_ && i < chunks_.size(); ++i)
+            used += chunks_[i].size;
+        return used;
+    }
+
+    size_t Arena::bytes_reserved() const {
+        size_t reserved = 0;
+        for (const Chunk& chunk : chunks_)
+            reserved += chunk.size;
+        return reserved;
+    }
+
+    Arena* Arena::ForCurrentThread() {
+        thread_local Arena arena(kDefaultChunkSize, MemoryTag::kDsp);
+        return &arena;
+    }
+}
@@ -0,0 +1,114 @@
+//
+// Created by wang rl on 2022/7/15.
+//
+
+#ifndef MULTIMEDIA_ARENA_H
+#define MULTIMEDIA_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "base/memory/AlignedMemory.h"
+
+namespace mm {
+    // A bump allocator for short-lived, aligned allocations, e.g. the buses of
+    // one decode or processing step, see AudioBus::Create(Arena*, ...). Memory
+    // comes from AlignedAlloc() in large chunks and is handed out by advancing
+    // an offset; individual allocations are never freed. Instead, Reset() or
+    // the end of a Scope rewinds the arena and the chunks are reused, so a
+    // steady state session doesn't call the system allocator at all.
+    //
+    // The DSP code in this tree has no per-call scratch buffers; mixFrom()
+    // keeps its channel pointers on the stack. A processing stage that does
+    // need scratch memory should take it from a Scope on ForCurrentThread().
+    //
+    // An Arena is not thread safe. Use one per thread, ForCurrentThread() keeps
+    // one for every thread that asks for it.
+    class Arena {
+    public:
+        // Size of the chunks requested from AlignedAlloc(). Larger allocations get
+        // a chunk of their own.
+        static constexpr size_t kDefaultChunkSize = 256 * 1024;
+
+        // Alignment of every chunk, the largest alignment Allocate() supports
+        // without padding a chunk.
+        static constexpr size_t kChunkAlignment = 64;
+
+        // Rewinds the arena to where it was at construction when destroyed, which
+        // releases all allocations made in between. Scopes must be destroyed in
+        // the reverse order of their construction.
+        class Scope {
+        public:
+            explicit Scope(Arena* arena);
+
+            ~Scope();
+
+            Scope(const Scope&) = delete;
+
+            Scope& operator=(const Scope&) = delete;
+
+        private:
+            Arena* const arena_;
+
+            const size_t chunk_;
+
+            const size_t offset_;
+        };
+
+        // The chunks are accounted under |tag|, see GetMemoryStats().
+        explicit Arena(size_t chunk_size = kDefaultChunkSize,
+                       MemoryTag tag = MemoryTag::kUntagged);
+
+        ~Arena();
+
+        // Returns |size| bytes aligned by |alignment|, which must be a power of
+        // two. The memory is valid until the arena is rewound past it.
+        void* Allocate(size_t size, size_t alignment);
+
+        template<typename T>
+        T* AllocateArray(size_t count, size_t alignment = alignof(T)) {
+            return static_cast<T*>(Allocate(sizeof(T) * count, alignment));
+        }
+
+        // Invalidates all allocations, keeping the chunks for reuse.
+        void Reset();
+
+        // Invalidates all allocations and frees the chunks.
+        void Release();
+
+        // Bytes handed out since the last Reset(), including alignment padding.
+        size_t bytes_used() const;
+
+        // Bytes held in chunks.
+        size_t bytes_reserved() const;
+
+        // Returns the arena of the calling thread, created on first use and
+        // destroyed when the thread exits. Its chunks count as MemoryTag::kDsp.
+        static Arena* ForCurrentThread();
+
+        Arena(const Arena&) = delete;
+
+        Arena& operator=(const Arena&) = delete;
+
+    private:
+        struct Chunk {
+            std::unique_ptr<uint8_t, AlignedFreeDeleter> data;
+            size_t size;
+        };
+
+        const size_t chunk_size_;
+
+        const MemoryTag tag_;
+
+        std::vector<Chunk> chunks_;
+
+        // The chunk allocations are taken from, and the bytes used in it. The
+        // chunks after |chunk_| are unused.
+        size_t chunk_ = 0;
+
+        size_t offset_ = 0;
+    };
+}
+
+#endif //MULTIMEDIA_ARENA_H
@@ -0,0 +1,196 @@
+//
+// Created by wang rl on 2022/7/16.
+//
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <vector>
+#include <glog/logging.h>
+#include "base/memory/MemoryStats.h"
+
+namespace mm {
+    namespace {
+        struct Totals {
+            int64_t allocations = 0;
+            int64_t frees = 0;
+            int64_t allocated_bytes = 0;
+            int64_t freed_bytes = 0;
+        };
+
+        // The counters of one thread. Only the owning thread writes them, so the
+        // updates are a plain load and store; GetMemoryStats() reads them from
+        // other threads, hence the atomics.
+        struct ThreadCounters {
+            std::atomic<int64_t> allocations[kMemoryTagCount] = {};
+            std::atomic<int64_t> frees[kMemoryTagCount] = {};
+            std::atomic<int64_t> allocated_bytes[kMemoryTagCount] = {};
+            std::atomic<int64_t> freed_bytes[kMemoryTagCount] = {};
+
+            // Change of the current bytes not yet published to gCurrentBytes.
+            int64_t pending_bytes[kMemoryTagCount] = {};
+        };
+
+        // Guards Threads() and gRetired.
+        std::mutex gLock;
+
+        std::vector<ThreadCounters*>& Threads() {
+            static auto* threads = new std::vector<ThreadCounters*>();
+            return *threads;
+        }
+
+        // Counters of the threads which have exited.
+        Totals gRetired[kMemoryTagCount];
+
+        std::atomic<int64_t> gCurrentBytes[kMemoryTagCount];
+
+        std::atomic<int64_t> gPeakBytes[kMemoryTagCount];
+
+        void Increment(std::atomic<int64_t>& counter, int64_t value) {
+            counter.store(counter.load(std::memory_order_relaxed) + value,
+                          std::memory_order_relaxed);
+        }
+
+        void Publish(int tag, int64_t bytes) {
+            const int64_t current =
+                    gCurrentBytes[tag].fetch_add(bytes, std::memory_order_relaxed) + bytes;
+            int64_t peak = gPeakBytes[tag].load(std::memory_order_relaxed);
+            while (current > peak &&
+                   !gPeakBytes[tag].compare_exchange_weak(peak, current,
+                                                          std::memory_order_relaxed)) {
+            }
+        }
+
+        // Registers the counters of the calling thread on first use and folds
+        // them into gRetired when the thread exits.
+        class ThreadRegistration {
+        public:
+            ThreadRegistration() {
+                std::lock_guard<std::mutex> lock(gLock);
+                Threads().push_back(&counters_);
+            }
+
+            ~ThreadRegistration();
+
+            ThreadCounters* counters() { return &counters_; }
+
+        private:
+            ThreadCounters counters_;
+        };
+
+        // Trivially destructible, so they remain usable while other thread_local
+        // objects are destroyed, e.g. a thread's Arena freeing its chunks.
+        thread_local ThreadCounters* tCounters = nullptr;
+        thread_local bool tExited = false;
+
+        ThreadRegistration::~ThreadRegistration() {
+            std::lock_guard<std::mutex> lock(gLock);
+            for (int tag = 0; tag < kMemoryTagCount; ++tag) {
+                gRetired[tag].allocations += counters_.allocations[tag].load();
+                gRetired[tag].frees += counters_.frees[tag].load();
+                gRetired[tag].allocated_bytes += counters_.allocated_bytes[tag].load();
+                gRetired[tag].freed_bytes += counters_.freed_bytes[tag].load();
+                Publish(tag, counters_.pending_bytes[tag]);
+            }
+            auto& threads = Threads();
+            threads.erase(std::find(threads.begin(), threads.end(), &counters_));
+            tCounters = nullptr;
+            tExited = true;
+        }
+
+        ThreadCounters* CurrentThreadCounters() {
+            if (!tCounters && !tExited) {
+                thread_local ThreadRegistration registration;
+                tCounters = registration.counters();
+            }
+            return tCounters;
+        }
+
+        void Record(MemoryTag memoryTag, bool allocation, size_t size) {
+            const int tag = static_cast<int>(memoryTag);
+            DCHECK_GE(tag, 0);
+            DCHECK_LT(tag, kMemoryTagCount);
+            const int64_t bytes = allocation ? int64_t(size) : -int64_t(size);
+            ThreadCounters* counters = CurrentThreadCounters();
+            if (!counters) {
+                // The thread is exiting, count directly into the totals.
+                std::lock_guard<std::mutex> lock(gLock);
+                if (allocation) {
+                    gRetired[tag].allocations++;
+                    gRetired[tag].allocated_bytes += bytes;
+                } else {
+                    gRetired[tag].frees++;
+                    gRetired[tag].freed_bytes -= bytes;
+                }
+                Publish(tag, bytes);
+                return;
+            }
+
+            if (allocation) {
+                Increment(counters->allocations[tag], 1);
+                Increment(counters->allocated_bytes[tag], bytes);
+            } else {
+                Increment(counters->frees[tag], 1);
+                Increment(counters->freed_bytes[tag], -bytes);
+            }
+            int64_t& pending = counters->pending_bytes[tag];
+            pending += bytes;
+            if (std::abs(pending) >= kMemoryStatsBatchBytes) {
+                Publish(tag, pending);
+                pending = 0;
+            }
+        }
+    }
+
+    const char* MemoryTagName(MemoryTag tag) {
+        switch (tag) {
+            case MemoryTag::kUntagged:
+                return "untagged";
+            case MemoryTag::kDecoder:
+                return "decoder";
+            case MemoryTag::kDsp:
+                return "dsp";
+            case MemoryTag::kCache:
+                return "cache";
+        }
+        return "unknown";
+    }
+
+    MemoryStats GetMemoryStats(MemoryTag memoryTag) {
+        const int tag = static_cast<int>(memoryTag);
+        CHECK_GE(tag, 0);
+        CHECK_LT(tag, kMemoryTagCount);
+
+        Totals totals;
+        {
+            std::lock_guard<std::mutex> lock(gLock);
+            totals = gRetired[tag];
+            for (const ThreadCounters* counters : Threads()) {
+                totals.allocations += counters->allocations[tag].load(std::memory_order_relaxed);
+                totals.frees += counters->frees[tag].load(std::memory_order_relaxed);
+                totals.allocated_bytes +=
+                        counters->allocated_bytes[tag].load(std::memory_order_relaxed);
+                totals.freed_bytes += counters->freed_bytes[tag].load(std::memory_order_relaxed);
+            }
+        }
+
+        MemoryStats stats;
+        stats.allocations = totals.allocations;
+        stats.frees = totals.frees;
+        stats.current_bytes = totals.allocated_bytes - totals.freed_bytes;
+        stats.peak_bytes = std::max(gPeakBytes[tag].load(std::memory_order_relaxed),
+                                    stats.current_bytes);
+        return stats;
+    }
+
+    namespace internal {
+        void RecordAllocation(MemoryTag tag, size_t size) {
+            Record(tag, true, size);
+        }
+
+        void RecordFree(MemoryTag tag, size_t size) {
+            Record(tag, false, size);
+        }
+    }
+}
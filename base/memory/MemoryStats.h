@@ -0,0 +1,62 @@
+//
+// Created by wang rl on 2022/7/16.
+//
+
+#ifndef MULTIMEDIA_MEMORY_STATS_H
+#define MULTIMEDIA_MEMORY_STATS_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace mm {
+    // What an allocation made through AlignedAlloc() is used for. The counters
+    // of every tag are kept separately, see GetMemoryStats().
+    enum class MemoryTag {
+        kUntagged,
+        // Decoded audio on its way out of a decoder, e.g. AudioFileReader packets.
+        kDecoder,
+        // Buffers of audio processing, e.g. arenas for scratch memory.
+        kDsp,
+        // Audio kept resident for later use, e.g. CompactAudioBus.
+        kCache,
+    };
+
+    constexpr int kMemoryTagCount = 4;
+
+    const char* MemoryTagName(MemoryTag tag);
+
+    // Counters of one tag since the start of the process. Sizes are the bytes
+    // requested from AlignedAlloc(), without alignment padding or page rounding.
+    struct MemoryStats {
+        // Bytes allocated and not freed yet.
+        int64_t current_bytes = 0;
+
+        // Highest |current_bytes| seen. Each thread batches small changes before
+        // publishing them, so this is approximate by up to
+        // kMemoryStatsBatchBytes per thread in either direction: it may miss a
+        // peak, and it may count bytes that never coexisted, e.g. when one
+        // thread publishes allocations after another thread already published
+        // the frees of memory it held earlier.
+        int64_t peak_bytes = 0;
+
+        int64_t allocations = 0;
+
+        int64_t frees = 0;
+    };
+
+    constexpr int64_t kMemoryStatsBatchBytes = 64 * 1024;
+
+    // Sums the counters of all threads. Allocating threads are never blocked:
+    // every thread counts into its own counters, the lock taken here only
+    // guards the list of threads.
+    MemoryStats GetMemoryStats(MemoryTag tag);
+
+    namespace internal {
+        // Called by AlignedAlloc() and AlignedFree().
+        void RecordAllocation(MemoryTag tag, size_t size);
+
+        void RecordFree(MemoryTag tag, size_t size);
+    }
+}
+
+#endif //MULTIMEDIA_MEMORY_STATS_H
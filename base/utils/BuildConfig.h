@@ -0,0 +1,34 @@
+//
+// Created by wang rl on 2022/7/4.
+//
+
+// This file adds defines about the processor architecture the code is being
+// compiled for, e.g.:
+//   ARCH_CPU_X86_FAMILY
+//   ARCH_CPU_ARM_FAMILY
+//   ARCH_CPU_64_BITS
+
+#ifndef MULTIMEDIA_BUILD_CONFIG_H
+#define MULTIMEDIA_BUILD_CONFIG_H
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define ARCH_CPU_X86_FAMILY 1
+#define ARCH_CPU_X86_64 1
+#define ARCH_CPU_64_BITS 1
+#elif defined(_M_IX86) || defined(__i386__)
+#define ARCH_CPU_X86_FAMILY 1
+#define ARCH_CPU_X86 1
+#define ARCH_CPU_32_BITS 1
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define ARCH_CPU_ARM_FAMILY 1
+#define ARCH_CPU_ARM64 1
+#define ARCH_CPU_64_BITS 1
+#elif defined(__arm__) || defined(_M_ARM)
+#define ARCH_CPU_ARM_FAMILY 1
+#define ARCH_CPU_ARMEL 1
+#define ARCH_CPU_32_BITS 1
+#else
+#error Please add support for your architecture in base/utils/BuildConfig.h
+#endif
+
+#endif //MULTIMEDIA_BUILD_CONFIG_H
@@ -2,28 +2,199 @@
 // Created by wang rl on 2022/6/9.
 //
 
+#include <algorithm>
+#include <cstring>
+#include "base/utils/BuildConfig.h"
 #include "common/Utilities.h"
 
+#if defined(ARCH_CPU_X86_FAMILY)
+#include <emmintrin.h>
+#endif
+
 namespace mm {
     constexpr float kScaleI16ToFloat = (1.0f / 32768.0f);
 
+    // Clipping the float before the conversion gives the same results as clipping
+    // the converted integer, but keeps the conversion defined for any input,
+    // including NaN, which becomes the lowest value.
+    static inline int16_t quantizePcm16(float fval) {
+        if (!(fval >= 0.0f)) fval = 0.0f;
+        else if (fval > 65535.0f) fval = 65535.0f;
+        auto sample = static_cast<int32_t>(fval);
+        sample -= 32768; // center at zero
+        return static_cast<int16_t>(sample);
+    }
+
+    // One step of a xorshift32 generator. The top bits of two consecutive steps
+    // make two uniform values in [1, 2), and their sum minus 3 is triangular
+    // noise in (-1, 1) LSB.
+    static inline uint32_t nextXorshift(uint32_t state) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    static inline float uniformFromBits(uint32_t bits) {
+        bits = (bits >> 9) | 0x3f800000;
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+#if defined(ARCH_CPU_X86_FAMILY)
+    static inline __m128i nextXorshift(__m128i state) {
+        state = _mm_xor_si128(state, _mm_slli_epi32(state, 13));
+        state = _mm_xor_si128(state, _mm_srli_epi32(state, 17));
+        return _mm_xor_si128(state, _mm_slli_epi32(state, 5));
+    }
+
+    static inline __m128 uniformFromBits(__m128i bits) {
+        return _mm_castsi128_ps(_mm_or_si128(_mm_srli_epi32(bits, 9),
+                                             _mm_set1_epi32(0x3f800000)));
+    }
+
+    // Same as the scalar quantizePcm16() for four samples.
+    static inline __m128i quantizePcm16(__m128 fval) {
+        fval = _mm_min_ps(_mm_max_ps(fval, _mm_setzero_ps()), _mm_set1_ps(65535.0f));
+        return _mm_sub_epi32(_mm_cvttps_epi32(fval), _mm_set1_epi32(32768));
+    }
+#endif
+
     void convertFloatToPcm16(const float *source, int16_t *destination, int32_t numSamples) {
-        for (int i = 0; i < numSamples; i++) {
+        int32_t i = 0;
+#if defined(ARCH_CPU_X86_FAMILY)
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 scale = _mm_set1_ps(32768.0f);
+        for (; i + 8 <= numSamples; i += 8) {
+            const __m128i low = quantizePcm16(
+                    _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(source + i), one), scale));
+            const __m128i high = quantizePcm16(
+                    _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(source + i + 4), one), scale));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(destination + i),
+                             _mm_packs_epi32(low, high));
+        }
+#endif
+        for (; i < numSamples; i++) {
             float fval = source[i];
             fval += 1.0; // to avoid discontinuity at 0.0 caused by truncation
             fval *= 32768.0f;
-            auto sample = static_cast<int32_t>(fval);
-            // clip to 16-bit range
-            if (sample < 0) sample = 0;
-            else if (sample > 0x0FFFF) sample = 0x0FFFF;
-            sample -= 32768; // center at zero
-            destination[i] = static_cast<int16_t>(sample);
+            destination[i] = quantizePcm16(fval);
+        }
+    }
+
+    void convertFloatToPcm16(const float *source, int16_t *destination, int32_t numSamples,
+                             Pcm16Dither &dither) {
+        int32_t i = 0;
+        if (dither.mMode == Pcm16Dither::Mode::kNoiseShaped) {
+            // Each sample depends on the error of the previous one of its
+            // channel, so this loop is scalar; nextNoise() still generates the
+            // noise for eight samples at a time.
+            for (; i < numSamples; i++) {
+                float &error = dither.mError[dither.mChannel];
+                const float wanted = (source[i] + 1.0f) * 32768.0f - error;
+                destination[i] = quantizePcm16(wanted + dither.nextNoise());
+                // Limit the feedback after clipping, where the error is large.
+                error = std::min(std::max(float(destination[i] + 32768) - wanted, -2.0f),
+                                 2.0f);
+                if (++dither.mChannel == dither.mChannelCount) dither.mChannel = 0;
+            }
+            return;
+        }
+
+        // Use up the noise left over from the previous call first.
+        for (; i < numSamples && dither.mNoiseIndex < Pcm16Dither::kLanes; i++) {
+            destination[i] = quantizePcm16((source[i] + 1.0f) * 32768.0f + dither.nextNoise());
+        }
+#if defined(ARCH_CPU_X86_FAMILY)
+        // Two independent groups of generators hide the latency of the
+        // xorshift steps.
+        __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dither.mState));
+        __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dither.mState + 4));
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 three = _mm_set1_ps(3.0f);
+        const __m128 scale = _mm_set1_ps(32768.0f);
+        for (; i + 8 <= numSamples; i += 8) {
+            low = nextXorshift(low);
+            high = nextXorshift(high);
+            const __m128 firstLow = uniformFromBits(low);
+            const __m128 firstHigh = uniformFromBits(high);
+            low = nextXorshift(low);
+            high = nextXorshift(high);
+            const __m128 noiseLow = _mm_sub_ps(_mm_add_ps(firstLow, uniformFromBits(low)), three);
+            const __m128 noiseHigh = _mm_sub_ps(_mm_add_ps(firstHigh, uniformFromBits(high)),
+                                                three);
+            const __m128i sampleLow = quantizePcm16(_mm_add_ps(
+                    _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(source + i), one), scale), noiseLow));
+            const __m128i sampleHigh = quantizePcm16(_mm_add_ps(
+                    _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(source + i + 4), one), scale), noiseHigh));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(destination + i),
+                             _mm_packs_epi32(sampleLow, sampleHigh));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dither.mState), low);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dither.mState + 4), high);
+#endif
+        for (; i < numSamples; i++) {
+            destination[i] = quantizePcm16((source[i] + 1.0f) * 32768.0f + dither.nextNoise());
         }
     }
 
     void convertPcm16ToFloat(const int16_t *source, float *destination, int32_t numSamples) {
+        // Compilers vectorize this loop by themselves.
         for (int i = 0; i < numSamples; i++) {
             destination[i] = source[i] * kScaleI16ToFloat;
         }
     }
-}
\ No newline at end of file
+
+    Pcm16Dither::Pcm16Dither(Mode mode, int32_t channelCount, uint32_t seed)
+            : mMode(mode),
+              mChannelCount(std::max(channelCount, 1)),
+              mSeed(seed ? seed : 1),
+              mError(mChannelCount) {
+        reset();
+    }
+
+    void Pcm16Dither::reset() {
+        // Decorrelate the generators by seeding them with consecutive outputs of
+        // one generator.
+        uint32_t state = mSeed;
+        for (uint32_t &laneState : mState) {
+            state = nextXorshift(state);
+            laneState = state;
+        }
+        mNoiseIndex = kLanes;
+        std::fill(mError.begin(), mError.end(), 0.0f);
+        mChannel = 0;
+    }
+
+    float Pcm16Dither::nextNoise() {
+        if (mNoiseIndex == kLanes) {
+#if defined(ARCH_CPU_X86_FAMILY)
+            // The same steps as the scalar loop below, for all lanes at once.
+            __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i *>(mState));
+            __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i *>(mState + 4));
+            low = nextXorshift(low);
+            high = nextXorshift(high);
+            const __m128 firstLow = uniformFromBits(low);
+            const __m128 firstHigh = uniformFromBits(high);
+            low = nextXorshift(low);
+            high = nextXorshift(high);
+            const __m128 three = _mm_set1_ps(3.0f);
+            _mm_storeu_ps(mNoise, _mm_sub_ps(_mm_add_ps(firstLow, uniformFromBits(low)), three));
+            _mm_storeu_ps(mNoise + 4,
+                          _mm_sub_ps(_mm_add_ps(firstHigh, uniformFromBits(high)), three));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(mState), low);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(mState + 4), high);
+#else
+            for (int lane = 0; lane < kLanes; lane++) {
+                mState[lane] = nextXorshift(mState[lane]);
+                const float first = uniformFromBits(mState[lane]);
+                mState[lane] = nextXorshift(mState[lane]);
+                mNoise[lane] = (first + uniformFromBits(mState[lane])) - 3.0f;
+            }
+#endif
+            mNoiseIndex = 0;
+        }
+        return mNoise[mNoiseIndex++];
+    }
+}
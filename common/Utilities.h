@@ -6,17 +6,34 @@
 #define MULTIMEDIA_UTILITIES_H
 
 #include <cstdint>
+#include <vector>
 
 namespace mm {
+    class Pcm16Dither;
+
     /**
      * Convert an array of floats to an array of 16-bit integers.
      *
+     * Values outside of [-1.0, 1.0) are clipped to the 16-bit range. This is
+     * vectorized where the CPU allows it; all versions give identical results.
+     *
      * @param source the input array.
      * @param destination the output array.
      * @param numSamples the number of values to convert.
      */
     void convertFloatToPcm16(const float *source, int16_t *destination, int32_t numSamples);
 
+    /**
+     * Same as above, but adds the dither of |dither| before quantizing.
+     *
+     * @param source the input array, interleaved if it has several channels.
+     * @param destination the output array.
+     * @param numSamples the number of values to convert.
+     * @param dither the dither state, carried over from the previous call.
+     */
+    void convertFloatToPcm16(const float *source, int16_t *destination, int32_t numSamples,
+                             Pcm16Dither &dither);
+
     /**
      * Convert an array of 16-bit integers to an array of floats.
      *
@@ -25,6 +42,71 @@ namespace mm {
      * @param numSamples the number of values to convert.
      */
     void convertPcm16ToFloat(const int16_t *source, float *destination, int32_t numSamples);
+
+    /**
+     * Dither state for converting a stream of float samples to 16-bit.
+     *
+     * Plain truncation to 16-bit turns the quantization error of quiet or
+     * fading signals into distortion. TPDF dither adds triangular noise of
+     * +-1 LSB before quantizing, which makes the error independent of the
+     * signal. Noise shaping additionally feeds the error of each sample back
+     * into the next one of the same channel, which moves the noise towards high
+     * frequencies where it is less audible.
+     *
+     * The noise comes from eight xorshift generators advanced in parallel, so
+     * it can be produced eight samples at a time. The output only depends on
+     * the seed and the input, not on the CPU or on how a stream is split into
+     * calls.
+     */
+    class Pcm16Dither {
+    public:
+        enum class Mode {
+            kTpdf,
+            kNoiseShaped,
+        };
+
+        /**
+         * @param mode the dither type.
+         * @param channelCount the number of interleaved channels of the stream,
+         *                     used to feed back the error per channel.
+         * @param seed the seed of the noise generator, must not be 0.
+         */
+        explicit Pcm16Dither(Mode mode = Mode::kTpdf, int32_t channelCount = 1,
+                             uint32_t seed = 1);
+
+        Mode getMode() const { return mMode; }
+
+        int32_t getChannelCount() const { return mChannelCount; }
+
+        /**
+         * Restart the noise sequence and forget the accumulated error.
+         */
+        void reset();
+
+    private:
+        friend void convertFloatToPcm16(const float *source, int16_t *destination,
+                                        int32_t numSamples, Pcm16Dither &dither);
+
+        static constexpr int kLanes = 8;
+
+        /**
+         * Return the dither of the next sample, in LSB.
+         */
+        float nextNoise();
+
+        const Mode mMode;
+        const int32_t mChannelCount;
+        const uint32_t mSeed;
+        uint32_t mState[kLanes];
+        // Noise generated for a group of kLanes samples which was only partly
+        // used by the previous call, starting at mNoiseIndex.
+        float mNoise[kLanes];
+        int32_t mNoiseIndex;
+        // Quantization error of the previous sample of each channel, in LSB.
+        std::vector<float> mError;
+        // Channel of the next sample.
+        int32_t mChannel;
+    };
 }
 
 #endif //MULTIMEDIA_UTILITIES_H
@@ -2,15 +2,24 @@
 // Created by wang rl on 2022/6/13.
 //
 
+#include <cmath>
 #include <glog/logging.h>
 #include "media/base/AudioBus.h"
+#include "media/base/AudioBusView.h"
 #include "media/base/AudioSampleTypes.h"
 #include "media/base/Limits.h"
+#include "media/base/VectorMath.h"
 
 namespace mm {
-    static bool IsAligned(void* ptr) {
-        return (reinterpret_cast<uintptr_t>(ptr) &
-                (AudioBus::kChannelAlignment - 1)) == 0U;
+    static void ValidateAlignment(int alignment) {
+        CHECK(AudioBus::IsValidAlignment(alignment))
+            << "Unsupported channel alignment " << alignment;
+    }
+
+    static void ValidateConfig(int channels, int frames) {
+        CHECK_GT(frames, 0);
+        CHECK_GT(channels, 0);
+        CHECK_LE(channels, static_cast<int>(kMaxChannels));
     }
 
     // In order to guarantee that the memory block for each channel starts at an
@@ -21,13 +30,15 @@ namespace mm {
     // in bytes and outputs the adjusted number of frames via |outAlignedFrames|.
     static int CalculateMemorySizeInternal(int channels,
                                            int frames,
+                                           int alignment,
                                            int* outAlignedFrames) {
         // Since our internal sample format is float, we can guarantee the alignment
         // by making the number of frames an integer multiple of
-        // AudioBus::kChannelAlignment / sizeof(float).
+        // |alignment| / sizeof(float). With kCacheLineAlignment this also pads
+        // every channel to whole cache lines.
         int alignedFrames =
-                int(((frames * sizeof(float) + AudioBus::kChannelAlignment - 1) &
-                     ~(AudioBus::kChannelAlignment - 1))) / sizeof(float);
+                int(((frames * sizeof(float) + alignment - 1) &
+                     ~(size_t(alignment) - 1))) / sizeof(float);
 
         if (outAlignedFrames)
             *outAlignedFrames = alignedFrames;
@@ -35,57 +46,77 @@ namespace mm {
         return sizeof(float) * channels * alignedFrames;
     }
 
-    std::unique_ptr<AudioBus> AudioBus::Create(int channels, int frames) {
-        return std::unique_ptr<AudioBus>(new AudioBus(channels, frames));
+    bool AudioBus::IsValidAlignment(int alignment) {
+        return alignment == kSSEAlignment || alignment == kAVXAlignment ||
+               alignment == kCacheLineAlignment;
+    }
+
+    std::unique_ptr<AudioBus> AudioBus::Create(int channels, int frames,
+                                               int alignment, MemoryTag tag) {
+        return std::unique_ptr<AudioBus>(new AudioBus(channels, frames, alignment, tag));
+    }
+
+    std::unique_ptr<AudioBus> AudioBus::Create(Arena* arena, int channels, int frames,
+                                               int alignment) {
+        // Validate before sizing the allocation, a bad configuration would
+        // otherwise ask the arena for a huge block first.
+        ValidateConfig(channels, frames);
+        ValidateAlignment(alignment);
+        void* data = arena->Allocate(CalculateMemorySize(channels, frames, alignment),
+                                     alignment);
+        return std::unique_ptr<AudioBus>(new AudioBus(
+                channels, frames, static_cast<float*>(data), alignment));
     }
 
     std::unique_ptr<AudioBus> AudioBus::WrapVector(
             int frames,
-            const std::vector<float*>& channelData) {
-        return std::unique_ptr<AudioBus>(new AudioBus(frames, channelData));
+            const std::vector<float*>& channelData,
+            int alignment) {
+        return std::unique_ptr<AudioBus>(
+                new AudioBus(frames, channelData, alignment));
     }
 
     std::unique_ptr<AudioBus> AudioBus::WrapMemory(int channels,
                                                    int frames,
-                                                   void* data) {
-        // |data| must be aligned by AudioBus::kChannelAlignment.
-        CHECK(IsAligned(data));
+                                                   void* data,
+                                                   int alignment) {
+        // |data| must be aligned by |alignment|.
+        ValidateAlignment(alignment);
+        CHECK(IsAligned(data, alignment));
         return std::unique_ptr<AudioBus>(new AudioBus(
-                channels, frames, static_cast<float*>(data)));
+                channels, frames, static_cast<float*>(data), alignment));
     }
 
     std::unique_ptr<const AudioBus> AudioBus::WrapReadOnlyMemory(
-            int channels, int frames, const void* data) {
+            int channels, int frames, const void* data, int alignment) {
         // Note: const_cast is generally dangerous but is used in this case since
         // AudioBus accommodates both read-only and read/write use cases. A const
         // AudioBus object is returned to ensure no one accidentally writes to the
         // read-only data.
-        return WrapMemory(channels, frames, const_cast<void*>(data));
+        return WrapMemory(channels, frames, const_cast<void*>(data), alignment);
     }
 
-    int AudioBus::CalculateMemorySize(int channels, int frames) {
-        return CalculateMemorySizeInternal(channels, frames, nullptr);
-    }
-
-    static void ValidateConfig(int channels, int frames) {
-        CHECK_GT(frames, 0);
-        CHECK_GT(channels, 0);
-        CHECK_LE(channels, static_cast<int>(kMaxChannels));
+    int AudioBus::CalculateMemorySize(int channels, int frames, int alignment) {
+        ValidateAlignment(alignment);
+        return CalculateMemorySizeInternal(channels, frames, alignment, nullptr);
     }
 
     void AudioBus::copyTo(AudioBus* dest) const {
         copyPartialFramesTo(0, frames(), 0, dest);
     }
 
+    void AudioBus::copyTo(const AudioBusView& dest) const {
+        CHECK_EQ(channels(), dest.channels());
+        CHECK_LE(frames(), dest.frames());
+        for (int i = 0; i < channels(); i++)
+            memcpy(dest.channel(i), channel(i), sizeof(*channel(i)) * frames());
+    }
+
     void AudioBus::copyAndClipTo(AudioBus* dest) const {
         CHECK_EQ(channels(), dest->channels());
         CHECK_LE(frames(), dest->frames());
-        for (int i = 0; i < channels(); i++) {
-            float* destPtr = dest->channel(i);
-            const float* sourcePtr = channel(i);
-            for (int j = 0; j < frames(); j++)
-                destPtr[j] = Float32SampleTypeTraits::FromFloat(sourcePtr[j]);
-        }
+        for (int i = 0; i < channels(); i++)
+            vector_math::FCLAMP(channel(i), frames(), dest->channel(i));
     }
 
     void AudioBus::copyPartialFramesTo(int sourceStartFrame,
@@ -126,27 +157,113 @@ namespace mm {
 
     bool AudioBus::areFramesZero() const {
         for (size_t i = 0; i < mChannelData.size(); i++) {
-            for (int j = 0; j < mFrames; j++) {
-                if (mChannelData[i][j])
-                    return false;
-            }
+            if (!vector_math::IsZero(mChannelData[i], mFrames))
+                return false;
         }
         return true;
     }
 
     void AudioBus::scale(float volume) {
         if (volume > 0 && volume != 1) {
-            for (int i = 0; i < channels(); i++) {
-                // 可以使用硬件加速
-                for (int j = 0; j < mFrames; j++) {
-                    mChannelData[i][j] = mChannelData[i][j] * volume;
-                }
-            }
+            for (int i = 0; i < channels(); i++)
+                vector_math::FMUL(channel(i), volume, mFrames, channel(i));
         } else if (volume == 0) {
             zero();
         }
     }
 
+    void AudioBus::rampLinear(int startFrame, int frames, float startGain,
+                              float endGain) {
+        CheckOverflow(startFrame, frames, mFrames);
+        if (frames <= 0)
+            return;
+
+        const float increment = (endGain - startGain) / frames;
+        for (int i = 0; i < channels(); i++) {
+            float* data = channel(i) + startFrame;
+            vector_math::FRAMP(data, startGain, increment, frames, data);
+        }
+    }
+
+    void AudioBus::rampExponential(int startFrame, int frames, float startGain,
+                                   float endGain) {
+        CHECK_GT(startGain, 0);
+        CHECK_GT(endGain, 0);
+        CheckOverflow(startFrame, frames, mFrames);
+        if (frames <= 0)
+            return;
+
+        const auto ratio = float(std::pow(double(endGain) / startGain, 1.0 / frames));
+        for (int i = 0; i < channels(); i++) {
+            float* data = channel(i) + startFrame;
+            vector_math::FEXPRAMP(data, startGain, ratio, frames, data);
+        }
+    }
+
+    void AudioBus::fadeIn(int startFrame, int frames) {
+        rampLinear(startFrame, frames, 0, 1);
+    }
+
+    void AudioBus::fadeOut(int startFrame, int frames) {
+        rampLinear(startFrame, frames, 1, 0);
+    }
+
+    void AudioBus::crossfade(const AudioBus* from, const AudioBus* to,
+                             int startFrame, int frames) {
+        CHECK_EQ(channels(), from->channels());
+        CHECK_EQ(channels(), to->channels());
+        CheckOverflow(startFrame, frames, mFrames);
+        CHECK_LE(startFrame + frames, from->frames());
+        CHECK_LE(startFrame + frames, to->frames());
+        if (frames <= 0)
+            return;
+
+        // The angle goes from 0 to pi / 2 over the range.
+        constexpr double kHalfPi = 1.57079632679489661923;
+        const auto increment = float(kHalfPi / frames);
+        for (int i = 0; i < channels(); i++) {
+            vector_math::FCROSSFADE(from->channel(i) + startFrame,
+                                    to->channel(i) + startFrame, 0, increment,
+                                    frames, channel(i) + startFrame);
+        }
+    }
+
+    void AudioBus::accumulateFrom(const AudioBus* source, float gain) {
+        CHECK_EQ(channels(), source->channels());
+        CHECK_LE(frames(), source->frames());
+        if (gain == 0)
+            return;
+        for (int i = 0; i < channels(); i++)
+            vector_math::FMAC(source->channel(i), gain, mFrames, channel(i));
+    }
+
+    void AudioBus::mixFrom(const std::vector<const AudioBus*>& sources,
+                           const std::vector<float>& gains,
+                           bool clip) {
+        CHECK_EQ(sources.size(), gains.size());
+        for (const AudioBus* source : sources) {
+            CHECK_EQ(channels(), source->channels());
+            CHECK_LE(frames(), source->frames());
+        }
+
+        // mixFrom() runs per block, so avoid allocating the channel pointers for
+        // the usual handful of sources.
+        static const size_t kStackSources = 16;
+        const float* stackChannels[kStackSources];
+        std::vector<const float*> heapChannels;
+        const float** sourceChannels = stackChannels;
+        if (sources.size() > kStackSources) {
+            heapChannels.resize(sources.size());
+            sourceChannels = heapChannels.data();
+        }
+        for (int i = 0; i < channels(); i++) {
+            for (size_t k = 0; k < sources.size(); k++)
+                sourceChannels[k] = sources[k]->channel(i);
+            vector_math::FMIX(sourceChannels, gains.data(),
+                              int(sources.size()), mFrames, channel(i), clip);
+        }
+    }
+
     void AudioBus::swapChannels(int a, int b) {
         DCHECK(a < channels() && a >= 0);
         DCHECK(b < channels() && b >= 0);
@@ -158,50 +275,56 @@ namespace mm {
 
     }
 
-    AudioBus::AudioBus(int channels, int frames)
-            : mFrames(frames) {
+    AudioBus::AudioBus(int channels, int frames, int alignment, MemoryTag tag)
+            : mFrames(frames), mAlignment(alignment) {
         ValidateConfig(channels, mFrames);
+        ValidateAlignment(alignment);
 
         int alignedFrames = 0;
-        int size = CalculateMemorySizeInternal(channels, frames, &alignedFrames);
+        int size = CalculateMemorySizeInternal(channels, frames, alignment,
+                                               &alignedFrames);
 
-        mData.reset(static_cast<float*>(AlignedAlloc(
-                size, AudioBus::kChannelAlignment)));
+        mData.reset(static_cast<float*>(AlignedAlloc(size, alignment, tag)));
+        mMemorySize = size;
 
         buildChannelData(channels, alignedFrames, mData.get());
     }
 
-    AudioBus::AudioBus(int channels, int frames, float* data)
-            : mFrames(frames) {
+    AudioBus::AudioBus(int channels, int frames, float* data, int alignment)
+            : mFrames(frames), mAlignment(alignment) {
         // Since |data| may have come from an external source, ensure it's valid.
         CHECK(data);
         ValidateConfig(channels, frames);
+        ValidateAlignment(alignment);
 
         int alignedFrames = 0;
-        CalculateMemorySizeInternal(channels, frames, &alignedFrames);
+        CalculateMemorySizeInternal(channels, frames, alignment, &alignedFrames);
 
         buildChannelData(channels, alignedFrames, data);
     }
 
-    AudioBus::AudioBus(int frames, const std::vector<float*>& channelData)
-            : mChannelData(channelData), mFrames(frames) {
+    AudioBus::AudioBus(int frames, const std::vector<float*>& channelData,
+                       int alignment)
+            : mChannelData(channelData), mFrames(frames), mAlignment(alignment) {
         ValidateConfig(int(mChannelData.size()), mFrames);
+        ValidateAlignment(alignment);
 
         // Sanity check wrapped vector for alignment and channel count.
         for (size_t i = 0; i < mChannelData.size(); i++) {
-            DCHECK(IsAligned(mChannelData[i]));
+            DCHECK(IsAligned(mChannelData[i], alignment))
+                << "Channel " << i << " is not aligned by " << alignment;
         }
     }
 
     AudioBus::AudioBus(int channels)
-            : mChannelData(channels), mFrames(0) {
+            : mChannelData(channels), mFrames(0), mAlignment(kChannelAlignment) {
         CHECK_GT(channels, 0);
         for (size_t i = 0; i < mChannelData.size(); i++)
             mChannelData[i] = nullptr;
     }
 
     void AudioBus::buildChannelData(int channels, int alignedFrame, float* data) {
-        DCHECK(IsAligned(data));
+        DCHECK(IsAligned(data, mAlignment));
         DCHECK_EQ(mChannelData.size(), 0U);
         DCHECK_EQ(mChannelData.size(), 0U);
         // Initialize |mChannelData| with pointers into |data|.
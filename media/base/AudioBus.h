@@ -5,50 +5,96 @@
 #ifndef MULTIMEDIA_AUDIO_BUS_H
 #define MULTIMEDIA_AUDIO_BUS_H
 
+#include <memory>
 #include <vector>
 #include "base/memory/AlignedMemory.h"
+#include "base/memory/Arena.h"
+#include "media/base/AudioInterleave.h"
+
+// Default channel alignment in bytes, selectable per build. Must be 16, 32 or
+// 64; see AudioBus::kChannelAlignment.
+#ifndef MM_AUDIO_BUS_ALIGNMENT
+#define MM_AUDIO_BUS_ALIGNMENT 16
+#endif
 
 namespace mm {
+    class AudioBusView;
+
     // Represents a sequence of audio frames containing frames() audio samples for
     // each of channels() channels. The data is stored as a set of contiguous
     // float arrays with one array per channel. The memory for the arrays is either
     // allocated and owned by the AudioBus or it is provided to one of the factory
     // methods. AudioBus guarantees that it allocates memory such that float array
-    // for each channel is aligned by AudioBus::kChannelAlignment bytes, and it
-    // requires the same for memory passed its Wrap...() factory methods.
+    // for each channel is aligned by alignment() bytes, and it requires the same
+    // for memory passed its Wrap...() factory methods.
     class AudioBus {
     public:
-        // Guaranteed alignment of each channel's data; use 16-byte alignment for easy
-        // SSE optimizations.
         enum {
-            kChannelAlignment = 16  // 128 bits
+            // Alignment for SSE, the minimum alignment of any bus.
+            kSSEAlignment = 16,    // 128 bits
+            // Alignment for AVX and AVX2 aligned loads.
+            kAVXAlignment = 32,    // 256 bits
+            // Alignment for AVX-512 aligned loads, and one cache line: every
+            // channel starts on its own line and its length is padded to whole
+            // lines, so threads working on different channels never share one.
+            kCacheLineAlignment = 64,  // 512 bits
+            // Default alignment of each channel's data, chosen per build via
+            // MM_AUDIO_BUS_ALIGNMENT.
+            kChannelAlignment = MM_AUDIO_BUS_ALIGNMENT
         };
 
+        static_assert(kChannelAlignment == kSSEAlignment ||
+                      kChannelAlignment == kAVXAlignment ||
+                      kChannelAlignment == kCacheLineAlignment,
+                      "MM_AUDIO_BUS_ALIGNMENT must be 16, 32 or 64");
+
+        // Returns true if |alignment| is one of the supported channel alignments.
+        static bool IsValidAlignment(int alignment);
+
         // Creates a new AudioBus and allocates |channels| of length |frames|.
-        static std::unique_ptr<AudioBus> Create(int channels, int frames);
+        // Each channel is aligned by |alignment| bytes, which must be one of
+        // kSSEAlignment, kAVXAlignment or kCacheLineAlignment. The memory is
+        // accounted under |tag|, see GetMemoryStats().
+        static std::unique_ptr<AudioBus> Create(int channels, int frames,
+                                                int alignment = kChannelAlignment,
+                                                MemoryTag tag = MemoryTag::kUntagged);
+
+        // Same as above, but the channel data is allocated from |arena|. No
+        // allocation is freed by the bus; it must be destroyed before |arena| is
+        // reset or rewound past its memory. Meant for short-lived buses, e.g.
+        // inside an Arena::Scope on Arena::ForCurrentThread().
+        static std::unique_ptr<AudioBus> Create(Arena* arena, int channels, int frames,
+                                                int alignment = kChannelAlignment);
 
         // Creates a new AudioBus from an existing channel vector. Does not transfer
         // ownership of |channelData| to AudioBus; i.e., |channelData| must outlive
-        // the returned AudioBus. Each channel must be aligned by kChannelAlignment.
+        // the returned AudioBus. Each channel must be aligned by |alignment|.
         static std::unique_ptr<AudioBus> WrapVector(
                 int frames,
-                const std::vector<float*>& channelData);
+                const std::vector<float*>& channelData,
+                int alignment = kChannelAlignment);
 
         // Creates a new AudioBus by wrapping an existing block of memory. Block must
-        // be at least CalculateMemorySize() bytes in size. |data| must outlive the
-        // returned AudioBus. |data| must be aligned by kChannelAlignment.
+        // be at least CalculateMemorySize() bytes in size for the same |alignment|.
+        // |data| must outlive the returned AudioBus. |data| must be aligned by
+        // |alignment|.
         static std::unique_ptr<AudioBus> WrapMemory(int channels,
                                                     int frames,
-                                                    void* data);
+                                                    void* data,
+                                                    int alignment = kChannelAlignment);
 
-        static std::unique_ptr<const AudioBus> WrapReadOnlyMemory(int channels,
-                                                                  int frames,
-                                                                  const void* data);
+        static std::unique_ptr<const AudioBus> WrapReadOnlyMemory(
+                int channels,
+                int frames,
+                const void* data,
+                int alignment = kChannelAlignment);
 
         // Based on the given number of channels and frames, calculates the minimum
         // required size in bytes of a contiguous block of memory to be passed to
-        // AudioBus for storage of the audio data.
-        static int CalculateMemorySize(int channels, int frames);
+        // AudioBus for storage of the audio data. Each channel is padded to a
+        // multiple of |alignment| bytes.
+        static int CalculateMemorySize(int channels, int frames,
+                                       int alignment = kChannelAlignment);
 
         // Overwrites the sample values stored in this AudioBus instance with values
         // from a given interleaved |sourceBuffer| with expected layout
@@ -94,6 +140,10 @@ namespace mm {
         // AudioBus object must have the same frames() and channels().
         void copyTo(AudioBus* dest) const;
 
+        // Copies all frames into |dest|, which must have the same channels() and at
+        // least frames() frames. Use this to fill a sub-range of another bus.
+        void copyTo(const AudioBusView& dest) const;
+
         // Similar to above, but clips values to [-1, 1] during the copy process.
         void copyAndClipTo(AudioBus* dest) const;
 
@@ -107,7 +157,7 @@ namespace mm {
                                  AudioBus* dest) const;
 
         // Returns a raw pointer to the requested channel.  Pointer is guaranteed to
-        // have a 16-byte alignment.  Warning: Do not rely on having sane (i.e. not
+        // have an alignment() byte alignment.  Warning: Do not rely on having sane (i.e. not
         // inf, nan, or between [-1.0, 1.0]) values in the channel data.
         float* channel(int channel) { return mChannelData[channel]; }
 
@@ -119,6 +169,14 @@ namespace mm {
         // Returns the number of frames.
         int frames() const { return mFrames; }
 
+        // Returns the alignment in bytes of every channel.
+        int alignment() const { return mAlignment; }
+
+        // Returns the bytes of sample memory allocated by this bus, 0 if the
+        // memory was provided to a Wrap...() method or comes from an Arena.
+        // An FFmpegAudioBus reports the size of the frame buffers it references.
+        size_t memorySize() const { return mMemorySize; }
+
         // Helper method for zeroing out all channels of audio data.
         void zero();
 
@@ -133,6 +191,46 @@ namespace mm {
         // is provided, no adjustment is done.
         void scale(float volume);
 
+        // Multiplies frames [startFrame, startFrame + frames) by a gain going
+        // linearly from |startGain| to |endGain|. Frame k of the range is scaled
+        // by startGain + (endGain - startGain) * k / frames, i.e. |endGain| is
+        // reached by the first frame after the range, so ramps over adjacent
+        // ranges join without a step.
+        void rampLinear(int startFrame, int frames, float startGain, float endGain);
+
+        // Like rampLinear(), but the gain changes by a constant factor per frame,
+        // which is linear in dB. Both gains must be positive.
+        void rampExponential(int startFrame, int frames, float startGain,
+                             float endGain);
+
+        // Linear fade from silence, respectively to silence, over frames
+        // [startFrame, startFrame + frames).
+        void fadeIn(int startFrame, int frames);
+
+        void fadeOut(int startFrame, int frames);
+
+        // Overwrites frames [startFrame, startFrame + frames) with an
+        // equal-power crossfade from the same frames of |from| to those of |to|,
+        // which keeps the loudness of uncorrelated material constant. Both must
+        // have the same channels() and at least startFrame + frames frames, and
+        // either may be this bus.
+        void crossfade(const AudioBus* from, const AudioBus* to, int startFrame,
+                       int frames);
+
+        // Adds |source| scaled by |gain| to this bus. |source| must have the same
+        // channels() and at least frames() frames.
+        void accumulateFrom(const AudioBus* source, float gain = 1.0f);
+
+        // Overwrites this bus with the sum of |sources|, each scaled by the entry
+        // of |gains| with the same index, and clips the result to [-1, 1] if
+        // |clip| is set. Every source must have the same channels() and at least
+        // frames() frames. All sources are summed in a single pass over this
+        // bus, so its memory is written only once however many sources there
+        // are. This bus may be one of |sources| to mix on top of its contents.
+        void mixFrom(const std::vector<const AudioBus*>& sources,
+                     const std::vector<float>& gains,
+                     bool clip = false);
+
         // Swap channels identified by |a| and |b|.  The caller needs to make sure
         // the channels are valid.
         void swapChannels(int a, int b);
@@ -144,31 +242,43 @@ namespace mm {
         virtual ~AudioBus();
 
     protected:
-        AudioBus(int channels, int frames);
+        AudioBus(int channels, int frames, int alignment, MemoryTag tag);
 
-        AudioBus(int channels, int frames, float* data);
+        AudioBus(int channels, int frames, float* data, int alignment);
 
-        AudioBus(int frames, const std::vector<float*>& channelData);
+        AudioBus(int frames, const std::vector<float*>& channelData, int alignment);
 
         explicit AudioBus(int channels);
 
+        // For subclasses which keep sample memory of their own alive.
+        void setMemorySize(size_t size) { mMemorySize = size; }
+
     private:
+        // AudioBusPool shrinks recycled buses to the requested frame count.
+        friend class AudioBusPool;
+        // AudioBusView shares |mChannelData| and the conversion helpers below.
+        friend class AudioBusView;
+
         // Helper method for building |mChannelData| from a block of memory. |data|
         // must be at least CalculateMemorySize(...) bytes in size.
         void buildChannelData(int channels, int alignedFrame, float* data);
 
         static void CheckOverflow(int startFrame, int frames, int totalFrames);
 
+        // The conversion helpers work on the raw |channels| channel pointers so
+        // they serve AudioBus and AudioBusView alike.
         template<class SourceSampleTypeTraits>
         static void CopyConvertFromInterleavedSourceToAudioBus(
                 const typename SourceSampleTypeTraits::ValueType* sourceBuffer,
                 int writeOffsetInFrames,
                 int numFramesToWrite,
-                AudioBus* dest);
+                int channels,
+                float* const* dest);
 
         template<class TargetSampleTypeTraits>
         static void CopyConvertFromAudioBusToInterleavedTarget(
-                const AudioBus* source,
+                const float* const* source,
+                int channels,
                 int readOffsetInFrames,
                 int numFramesToRead,
                 typename TargetSampleTypeTraits::ValueType* destBuffer);
@@ -184,6 +294,12 @@ namespace mm {
         std::vector<float*> mChannelData;
 
         int mFrames; // 数量
+
+        // Alignment in bytes of every entry of |mChannelData|.
+        int mAlignment;
+
+        // Size of |mData|, or as set by a subclass.
+        size_t mMemorySize = 0;
     };
 
     // template implementation
@@ -205,7 +321,8 @@ namespace mm {
             int writeOffsetInFrames, int numFramesToWrite) {
         CheckOverflow(writeOffsetInFrames, numFramesToWrite, mFrames);
         CopyConvertFromInterleavedSourceToAudioBus<SourceSampleTypeTraits>(
-                sourceBuffer, writeOffsetInFrames, numFramesToWrite, this);
+                sourceBuffer, writeOffsetInFrames, numFramesToWrite, channels(),
+                mChannelData.data());
     }
 
     // Delegates to toInterleavedPartial().
@@ -225,17 +342,32 @@ namespace mm {
             typename TargetSampleTypeTraits::ValueType* dest) const {
         CheckOverflow(readOffsetInFrames, numFramesToRead, mFrames);
         CopyConvertFromAudioBusToInterleavedTarget<TargetSampleTypeTraits>(
-                this, readOffsetInFrames, numFramesToRead, dest);
+                mChannelData.data(), channels(), readOffsetInFrames,
+                numFramesToRead, dest);
     }
 
     template<class SourceSampleTypeTraits>
     void AudioBus::CopyConvertFromInterleavedSourceToAudioBus(
             const typename SourceSampleTypeTraits::ValueType* sourceBuffer,
             int writeOffsetInFrames, int numFramesToWrite,
-            AudioBus* dest) {
-        const int channels = dest->channels();
+            int channels, float* const* dest) {
+        // Mono, stereo, 5.1 and 7.1 layouts of the common formats have a
+        // vectorized version which reads |sourceBuffer| only once.
+        if (audio_interleave::Kernels<SourceSampleTypeTraits>::Deinterleave(
+                sourceBuffer, channels, numFramesToWrite, dest,
+                writeOffsetInFrames)) {
+            return;
+        }
+
+        // A single channel is not interleaved at all.
+        if (channels == 1) {
+            SourceSampleTypeTraits::ToFloatArray(sourceBuffer, numFramesToWrite,
+                                                 dest[0] + writeOffsetInFrames);
+            return;
+        }
+
         for (int ch = 0; ch < channels; ch++) {
-            float* channelData = dest->channel(ch);
+            float* channelData = dest[ch];
             for (int targetFrameIndex = writeOffsetInFrames,
                          readPosInSource = ch;
                  targetFrameIndex < writeOffsetInFrames + numFramesToWrite;
@@ -249,13 +381,25 @@ namespace mm {
 
     template<class TargetSampleTypeTraits>
     void AudioBus::CopyConvertFromAudioBusToInterleavedTarget(
-            const AudioBus* source,
+            const float* const* source,
+            int channels,
             int readOffsetInFrames,
             int numFramesToRead,
             typename TargetSampleTypeTraits::ValueType* destBuffer) {
-        const int channels = source->channels();
+        if (audio_interleave::Kernels<TargetSampleTypeTraits>::Interleave(
+                source, readOffsetInFrames, channels, numFramesToRead,
+                destBuffer)) {
+            return;
+        }
+
+        if (channels == 1) {
+            TargetSampleTypeTraits::FromFloatArray(source[0] + readOffsetInFrames,
+                                                   numFramesToRead, destBuffer);
+            return;
+        }
+
         for (int ch = 0; ch < channels; ch++) {
-            const float* channelData = source->channel(ch);
+            const float* channelData = source[ch];
             for (int sourceFrameIndex = readOffsetInFrames, writePosInDest = ch;
                  sourceFrameIndex < readOffsetInFrames + numFramesToRead;
                  sourceFrameIndex++, writePosInDest += channels) {
@@ -0,0 +1,106 @@
+//
+// Created by wang rl on 2022/7/6.
+//
+
+#include <glog/logging.h>
+#include "media/base/AudioBusPool.h"
+
+namespace mm {
+    // (channels, alignment, aligned frames)
+    using SizeClass = std::tuple<int, int, int>;
+
+    struct AudioBusPool::State {
+        State(int maxFreeBusesPerClass, MemoryTag tag)
+                : maxFreeBusesPerClass(maxFreeBusesPerClass), tag(tag) {}
+
+        const int maxFreeBusesPerClass;
+
+        const MemoryTag tag;
+
+        mutable std::mutex lock;
+        std::map<SizeClass, std::vector<std::unique_ptr<AudioBus>>> freeBuses;
+        int64_t allocations = 0;
+        int64_t reuses = 0;
+    };
+
+    static SizeClass GetSizeClass(int channels, int frames, int alignment) {
+        return {channels, alignment,
+                AudioBus::CalculateMemorySize(1, frames, alignment) /
+                int(sizeof(float))};
+    }
+
+    AudioBusPool::Recycler::Recycler(std::weak_ptr<State> state)
+            : mState(std::move(state)) {}
+
+    void AudioBusPool::Recycler::operator()(AudioBus* bus) const {
+        std::unique_ptr<AudioBus> owned(bus);
+        std::shared_ptr<State> state = mState.lock();
+        if (!state || !bus)
+            return;
+
+        const SizeClass sizeClass = GetSizeClass(bus->channels(), bus->frames(),
+                                                     bus->alignment());
+        std::lock_guard<std::mutex> auto_lock(state->lock);
+        auto& buses = state->freeBuses[sizeClass];
+        if (int(buses.size()) < state->maxFreeBusesPerClass)
+            buses.push_back(std::move(owned));
+    }
+
+    AudioBusPool::AudioBusPool(int maxFreeBusesPerClass, MemoryTag tag)
+            : mState(std::make_shared<State>(maxFreeBusesPerClass, tag)) {
+        CHECK_GE(maxFreeBusesPerClass, 0);
+    }
+
+    AudioBusPool::~AudioBusPool() = default;
+
+    AudioBusPool::ScopedAudioBus AudioBusPool::Create(int channels, int frames,
+                                                      int alignment) {
+        CHECK_GT(frames, 0);
+        const SizeClass sizeClass = GetSizeClass(channels, frames, alignment);
+        std::unique_ptr<AudioBus> bus;
+        {
+            std::lock_guard<std::mutex> auto_lock(mState->lock);
+            auto it = mState->freeBuses.find(sizeClass);
+            if (it != mState->freeBuses.end() && !it->second.empty()) {
+                bus = std::move(it->second.back());
+                it->second.pop_back();
+                mState->reuses++;
+            } else {
+                mState->allocations++;
+            }
+        }
+
+        if (!bus) {
+            // Allocate the whole size class so the bus can serve any frame count
+            // of its class later on.
+            bus = AudioBus::Create(channels, std::get<2>(sizeClass), alignment,
+                                   mState->tag);
+        }
+        bus->mFrames = frames;
+        DCHECK(GetSizeClass(channels, bus->frames(), alignment) == sizeClass);
+        return ScopedAudioBus(bus.release(), Recycler(mState));
+    }
+
+    void AudioBusPool::clear() {
+        std::lock_guard<std::mutex> auto_lock(mState->lock);
+        mState->freeBuses.clear();
+    }
+
+    int64_t AudioBusPool::allocations() const {
+        std::lock_guard<std::mutex> auto_lock(mState->lock);
+        return mState->allocations;
+    }
+
+    int64_t AudioBusPool::reuses() const {
+        std::lock_guard<std::mutex> auto_lock(mState->lock);
+        return mState->reuses;
+    }
+
+    int AudioBusPool::freeBuses() const {
+        std::lock_guard<std::mutex> auto_lock(mState->lock);
+        size_t count = 0;
+        for (const auto& it : mState->freeBuses)
+            count += it.second.size();
+        return int(count);
+    }
+}
@@ -0,0 +1,81 @@
+//
+// Created by wang rl on 2022/7/6.
+//
+
+#ifndef MULTIMEDIA_AUDIO_BUS_POOL_H
+#define MULTIMEDIA_AUDIO_BUS_POOL_H
+
+#include <cstdint>
+#include <map>
+#include <tuple>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "media/base/AudioBus.h"
+
+namespace mm {
+    // Recycles AudioBus objects to avoid an aligned allocation for every decoded
+    // packet. Buses are grouped by size class, i.e. by channel count, channel
+    // alignment and frame count rounded up to that alignment, so a released bus can serve
+    // any later request of the same class without touching the allocator.
+    //
+    // Buses are handed out as ScopedAudioBus, whose deleter puts the bus back
+    // into the pool. They may outlive the pool, in which case they are simply
+    // deleted. All methods are thread safe.
+    class AudioBusPool {
+    private:
+        struct State;
+
+    public:
+        // Deleter of ScopedAudioBus. A default constructed Recycler deletes the
+        // bus, so a ScopedAudioBus may also own buses that never were pooled.
+        class Recycler {
+        public:
+            Recycler() = default;
+
+            explicit Recycler(std::weak_ptr<State> state);
+
+            void operator()(AudioBus* bus) const;
+
+        private:
+            std::weak_ptr<State> mState;
+        };
+
+        using ScopedAudioBus = std::unique_ptr<AudioBus, Recycler>;
+
+        // At most |maxFreeBusesPerClass| released buses are kept for each size
+        // class; buses released beyond that are deleted. The buses are accounted
+        // under |tag|, see GetMemoryStats(); free buses count as well.
+        explicit AudioBusPool(int maxFreeBusesPerClass = 64,
+                              MemoryTag tag = MemoryTag::kUntagged);
+
+        AudioBusPool(const AudioBusPool&) = delete;
+
+        AudioBusPool& operator=(const AudioBusPool&) = delete;
+
+        ~AudioBusPool();
+
+        // Returns a bus with |channels| channels of |frames| frames aligned by
+        // |alignment|. The contents are undefined, like those of
+        // AudioBus::Create().
+        ScopedAudioBus Create(int channels, int frames,
+                              int alignment = AudioBus::kChannelAlignment);
+
+        // Deletes all buses which are currently not in use.
+        void clear();
+
+        // Number of buses this pool had to allocate.
+        int64_t allocations() const;
+
+        // Number of Create() calls served by a recycled bus.
+        int64_t reuses() const;
+
+        // Number of buses waiting to be reused.
+        int freeBuses() const;
+
+    private:
+        std::shared_ptr<State> mState;
+    };
+}
+
+#endif //MULTIMEDIA_AUDIO_BUS_POOL_H
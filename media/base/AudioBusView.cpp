@@ -0,0 +1,85 @@
+//
+// Created by wang rl on 2022/7/8.
+//
+
+#include <cstring>
+#include <glog/logging.h>
+#include "media/base/AudioBusView.h"
+#include "media/base/VectorMath.h"
+
+namespace mm {
+    AudioBusView::AudioBusView(AudioBus* bus)
+            : AudioBusView(bus->mChannelData.data(), bus->channels(), 0,
+                           bus->frames()) {}
+
+    AudioBusView::AudioBusView(AudioBus* bus, int startFrame, int frames)
+            : AudioBusView(bus->mChannelData.data(), bus->channels(), startFrame,
+                           frames) {
+        CheckRange(startFrame, frames, bus->frames());
+    }
+
+    AudioBusView::AudioBusView(float* const* channelData, int channels,
+                               int startFrame, int frames)
+            : mChannelData(channelData),
+              mChannels(channels),
+              mStartFrame(startFrame),
+              mFrames(frames) {
+        DCHECK(mChannelData);
+    }
+
+    AudioBusView AudioBusView::subView(int startFrame, int frames) const {
+        CheckRange(startFrame, frames, mFrames);
+        return AudioBusView(mChannelData, mChannels, mStartFrame + startFrame,
+                            frames);
+    }
+
+    void AudioBusView::CheckRange(int startFrame, int frames, int totalFrames) {
+        CHECK_GE(startFrame, 0);
+        CHECK_GE(frames, 0);
+        CHECK_LE(startFrame, totalFrames - frames);
+    }
+
+    void AudioBusView::zero() const {
+        zeroFramesPartial(0, mFrames);
+    }
+
+    void AudioBusView::zeroFramesPartial(int startFrame, int frames) const {
+        CheckRange(startFrame, frames, mFrames);
+        if (frames <= 0)
+            return;
+
+        for (int i = 0; i < mChannels; i++)
+            memset(channel(i) + startFrame, 0, frames * sizeof(float));
+    }
+
+    bool AudioBusView::areFramesZero() const {
+        for (int i = 0; i < mChannels; i++) {
+            if (!vector_math::IsZero(channel(i), mFrames))
+                return false;
+        }
+        return true;
+    }
+
+    void AudioBusView::scale(float volume) const {
+        if (volume > 0 && volume != 1) {
+            for (int i = 0; i < mChannels; i++)
+                vector_math::FMUL(channel(i), volume, mFrames, channel(i));
+        } else if (volume == 0) {
+            zero();
+        }
+    }
+
+    void AudioBusView::copyTo(const AudioBusView& dest) const {
+        CHECK_EQ(mChannels, dest.channels());
+        CHECK_LE(mFrames, dest.frames());
+        for (int i = 0; i < mChannels; i++)
+            memcpy(dest.channel(i), channel(i), sizeof(float) * mFrames);
+    }
+
+    void AudioBusView::copyAndClipTo(const AudioBusView& dest) const {
+        CHECK_EQ(mChannels, dest.channels());
+        CHECK_LE(mFrames, dest.frames());
+        for (int i = 0; i < mChannels; i++)
+            vector_math::FCLAMP(channel(i), mFrames, dest.channel(i));
+    }
+}
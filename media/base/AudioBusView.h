@@ -0,0 +1,142 @@
+//
+// Created by wang rl on 2022/7/8.
+//
+
+#ifndef MULTIMEDIA_AUDIO_BUS_VIEW_H
+#define MULTIMEDIA_AUDIO_BUS_VIEW_H
+
+#include "media/base/AudioBus.h"
+
+namespace mm {
+    // A non-owning view of the frames [startFrame, startFrame + frames) of every
+    // channel of an AudioBus. A view is a few pointers and integers: creating,
+    // copying and narrowing it never allocates or touches sample data, so
+    // sub-ranges of a bus can be processed in place, e.g. to feed fixed-size
+    // blocks to DSP code or to assemble one bus out of decoded packets.
+    //
+    // Like a pointer, a view does not propagate constness to the samples. The
+    // viewed AudioBus must outlive the view, and frame indices passed to the
+    // methods below are relative to the start of the view.
+    class AudioBusView {
+    public:
+        // Views all frames of |bus|.
+        explicit AudioBusView(AudioBus* bus);
+
+        // Views |frames| frames of |bus| starting at |startFrame|.
+        AudioBusView(AudioBus* bus, int startFrame, int frames);
+
+        // Returns a view of |frames| frames starting at |startFrame| of this view.
+        AudioBusView subView(int startFrame, int frames) const;
+
+        // Returns a raw pointer to the first frame of the requested channel. The
+        // pointer is only aligned if the view starts at an aligned frame.
+        float* channel(int channel) const {
+            return mChannelData[channel] + mStartFrame;
+        }
+
+        int channels() const { return mChannels; }
+
+        int frames() const { return mFrames; }
+
+        // Offset of the view in the underlying AudioBus.
+        int startFrame() const { return mStartFrame; }
+
+        // Same as the AudioBus methods of the same name, restricted to the view.
+        void zero() const;
+
+        void zeroFramesPartial(int startFrame, int frames) const;
+
+        bool areFramesZero() const;
+
+        void scale(float volume) const;
+
+        // Copies the view into |dest|, which must have the same channels() and at
+        // least frames() frames. The views may belong to the same bus but must
+        // not overlap.
+        void copyTo(const AudioBusView& dest) const;
+
+        // Similar to above, but clips values to [-1, 1] during the copy process.
+        void copyAndClipTo(const AudioBusView& dest) const;
+
+        template<class SourceSampleTypeTraits>
+        void fromInterleaved(
+                const typename SourceSampleTypeTraits::ValueType* sourceBuffer,
+                int numFramesToWrite) const;
+
+        template<class SourceSampleTypeTraits>
+        void fromInterleavedPartial(
+                const typename SourceSampleTypeTraits::ValueType* sourceBuffer,
+                int writeOffsetInFrames,
+                int numFramesToWrite) const;
+
+        template<class TargetSampleTypeTraits>
+        void toInterleaved(
+                int numFramesToRead,
+                typename TargetSampleTypeTraits::ValueType* destBuffer) const;
+
+        template<class TargetSampleTypeTraits>
+        void toInterleavedPartial(
+                int readOffsetInFrames,
+                int numFramesToRead,
+                typename TargetSampleTypeTraits::ValueType* destBuffer) const;
+
+    private:
+        // Like AudioBus::CheckOverflow(), but empty views are fine.
+        static void CheckRange(int startFrame, int frames, int totalFrames);
+
+        AudioBusView(float* const* channelData, int channels, int startFrame,
+                     int frames);
+
+        // Channel pointers of the viewed AudioBus, not offset by |mStartFrame|.
+        float* const* mChannelData;
+
+        int mChannels;
+
+        int mStartFrame;
+
+        int mFrames;
+    };
+
+    // template implementation
+    template<class SourceSampleTypeTraits>
+    void AudioBusView::fromInterleaved(
+            const typename SourceSampleTypeTraits::ValueType* sourceBuffer,
+            int numFramesToWrite) const {
+        fromInterleavedPartial<SourceSampleTypeTraits>(sourceBuffer, 0,
+                                                       numFramesToWrite);
+        zeroFramesPartial(numFramesToWrite, mFrames - numFramesToWrite);
+    }
+
+    template<class SourceSampleTypeTraits>
+    void AudioBusView::fromInterleavedPartial(
+            const typename SourceSampleTypeTraits::ValueType* sourceBuffer,
+            int writeOffsetInFrames, int numFramesToWrite) const {
+        CheckRange(writeOffsetInFrames, numFramesToWrite, mFrames);
+        AudioBus::CopyConvertFromInterleavedSourceToAudioBus<
+                SourceSampleTypeTraits>(
+                sourceBuffer, mStartFrame + writeOffsetInFrames,
+                numFramesToWrite, mChannels, mChannelData);
+    }
+
+    template<class TargetSampleTypeTraits>
+    void AudioBusView::toInterleaved(
+            int numFramesToRead,
+            typename TargetSampleTypeTraits::ValueType* destBuffer) const {
+        toInterleavedPartial<TargetSampleTypeTraits>(0, numFramesToRead,
+                                                     destBuffer);
+    }
+
+    template<class TargetSampleTypeTraits>
+    void AudioBusView::toInterleavedPartial(
+            int readOffsetInFrames,
+            int numFramesToRead,
+            typename TargetSampleTypeTraits::ValueType* destBuffer) const {
+        CheckRange(readOffsetInFrames, numFramesToRead, mFrames);
+        AudioBus::CopyConvertFromAudioBusToInterleavedTarget<
+                TargetSampleTypeTraits>(
+                mChannelData, mChannels, mStartFrame + readOffsetInFrames,
+                numFramesToRead, destBuffer);
+    }
+}
+
+#endif //MULTIMEDIA_AUDIO_BUS_VIEW_H
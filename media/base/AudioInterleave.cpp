@@ -0,0 +1,293 @@
+//
+// Created by wang rl on 2022/7/5.
+//
+
+#include "base/utils/BuildConfig.h"
+#include "media/base/AudioInterleave.h"
+
+#if defined(ARCH_CPU_X86_FAMILY)
+#include "media/base/SampleConversionSSE.h"
+#endif
+
+namespace mm {
+    namespace audio_interleave {
+#if defined(ARCH_CPU_X86_FAMILY)
+        // The traits each sample type is converted with by default.
+        template<typename SampleType>
+        struct TraitsFor;
+
+        template<>
+        struct TraitsFor<int16_t> {
+            using Type = SignedInt16SampleTypeTraits;
+        };
+
+        template<>
+        struct TraitsFor<int32_t> {
+            using Type = SignedInt32SampleTypeTraits;
+        };
+
+        template<>
+        struct TraitsFor<PackedInt24> {
+            using Type = SignedInt24PackedSampleTypeTraits;
+        };
+
+        template<>
+        struct TraitsFor<float> {
+            using Type = Float32SampleTypeTraits;
+        };
+
+        // Converts the four channels of four consecutive frames starting at
+        // |source|, which points into an interleaved buffer with |kChannels|
+        // channels. The result is one vector per channel.
+        template<int kChannels, class Traits>
+        static inline void LoadTransposed(const typename Traits::ValueType* source,
+                                          __m128 rows[4]) {
+            using Converter = sse::Converter<Traits>;
+            rows[0] = Converter::Load(source);
+            rows[1] = Converter::Load(source + kChannels);
+            rows[2] = Converter::Load(source + 2 * kChannels);
+            rows[3] = Converter::Load(source + 3 * kChannels);
+            _MM_TRANSPOSE4_PS(rows[0], rows[1], rows[2], rows[3]);
+        }
+
+        // Reverse of LoadTransposed(): |rows| holds four frames of four channels
+        // and is stored into the interleaved buffer at |dest|.
+        template<int kChannels, class Traits>
+        static inline void StoreTransposed(__m128 rows[4], typename Traits::ValueType* dest) {
+            using Converter = sse::Converter<Traits>;
+            _MM_TRANSPOSE4_PS(rows[0], rows[1], rows[2], rows[3]);
+            Converter::Store(rows[0], dest);
+            Converter::Store(rows[1], dest + kChannels);
+            Converter::Store(rows[2], dest + 2 * kChannels);
+            Converter::Store(rows[3], dest + 3 * kChannels);
+        }
+
+        // Processes the first |frames| & ~3 frames and returns how many frames
+        // were converted. |dest| already includes the frame offset.
+        template<int kChannels, class Traits>
+        static int DeinterleaveBlocks(const typename Traits::ValueType* source, int frames,
+                                      float* const dest[kChannels]) {
+            using Converter = sse::Converter<Traits>;
+            const int lastFrame = frames & ~3;
+            for (int frame = 0; frame < lastFrame; frame += 4) {
+                const typename Traits::ValueType* in = source + frame * kChannels;
+                if constexpr (kChannels == 1) {
+                    _mm_storeu_ps(dest[0] + frame, Converter::Load(in));
+                } else if constexpr (kChannels == 2) {
+                    const __m128 a = Converter::Load(in);
+                    const __m128 b = Converter::Load(in + 4);
+                    _mm_storeu_ps(dest[0] + frame, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+                    _mm_storeu_ps(dest[1] + frame, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+                } else {
+                    // Transpose blocks of 4 frames x 4 channels. For 5.1 the second
+                    // block starts at channel 2 and only its last two rows are
+                    // stored; this keeps every load inside its frame, so nothing is
+                    // read past the end of |source|.
+                    constexpr int kSecondGroup = kChannels - 4;
+                    __m128 rows[4];
+                    LoadTransposed<kChannels, Traits>(in, rows);
+                    for (int ch = 0; ch < 4; ++ch)
+                        _mm_storeu_ps(dest[ch] + frame, rows[ch]);
+                    LoadTransposed<kChannels, Traits>(in + kSecondGroup, rows);
+                    for (int ch = 4; ch < kChannels; ++ch)
+                        _mm_storeu_ps(dest[ch] + frame, rows[ch - kSecondGroup]);
+                }
+            }
+            return lastFrame;
+        }
+
+        template<int kChannels, class Traits>
+        static int InterleaveBlocks(const float* const source[kChannels], int frames,
+                                    typename Traits::ValueType* dest) {
+            using Converter = sse::Converter<Traits>;
+            const int lastFrame = frames & ~3;
+            for (int frame = 0; frame < lastFrame; frame += 4) {
+                typename Traits::ValueType* out = dest + frame * kChannels;
+                if constexpr (kChannels == 1) {
+                    Converter::Store(_mm_loadu_ps(source[0] + frame), out);
+                } else if constexpr (kChannels == 2) {
+                    const __m128 l = _mm_loadu_ps(source[0] + frame);
+                    const __m128 r = _mm_loadu_ps(source[1] + frame);
+                    Converter::Store(_mm_unpacklo_ps(l, r), out);
+                    Converter::Store(_mm_unpackhi_ps(l, r), out + 4);
+                } else {
+                    // Same blocking as DeinterleaveBlocks(). For 5.1 channels 2 and
+                    // 3 are written twice with identical values.
+                    constexpr int kSecondGroup = kChannels - 4;
+                    __m128 rows[4];
+                    for (int ch = 0; ch < 4; ++ch)
+                        rows[ch] = _mm_loadu_ps(source[ch] + frame);
+                    StoreTransposed<kChannels, Traits>(rows, out);
+                    for (int ch = 0; ch < 4; ++ch)
+                        rows[ch] = _mm_loadu_ps(source[kSecondGroup + ch] + frame);
+                    StoreTransposed<kChannels, Traits>(rows, out + kSecondGroup);
+                }
+            }
+            return lastFrame;
+        }
+
+        template<typename SampleType, class Traits = typename TraitsFor<SampleType>::Type>
+        static bool DeinterleaveSSE(const SampleType* source, int channels, int frames,
+                                    float* const* dest, int frameOffset) {
+            // Apply the offset up front; a local copy also tells the compiler the
+            // stores can't change the channel pointers.
+            float* out[8];
+            if (channels > 8)
+                return false;
+            for (int ch = 0; ch < channels; ++ch)
+                out[ch] = dest[ch] + frameOffset;
+
+            int frame = 0;
+            switch (channels) {
+                case 1:
+                    frame = DeinterleaveBlocks<1, Traits>(source, frames, out);
+                    break;
+                case 2:
+                    frame = DeinterleaveBlocks<2, Traits>(source, frames, out);
+                    break;
+                case 6:
+                    frame = DeinterleaveBlocks<6, Traits>(source, frames, out);
+                    break;
+                case 8:
+                    frame = DeinterleaveBlocks<8, Traits>(source, frames, out);
+                    break;
+                default:
+                    return false;
+            }
+
+            // Convert the remaining frames one by one.
+            for (; frame < frames; ++frame) {
+                for (int ch = 0; ch < channels; ++ch)
+                    out[ch][frame] = Traits::ToFloat(source[frame * channels + ch]);
+            }
+            return true;
+        }
+
+        template<typename SampleType, class Traits = typename TraitsFor<SampleType>::Type>
+        static bool InterleaveSSE(const float* const* source, int frameOffset,
+                                  int channels, int frames, SampleType* dest) {
+            const float* in[8];
+            if (channels > 8)
+                return false;
+            for (int ch = 0; ch < channels; ++ch)
+                in[ch] = source[ch] + frameOffset;
+
+            int frame = 0;
+            switch (channels) {
+                case 1:
+                    frame = InterleaveBlocks<1, Traits>(in, frames, dest);
+                    break;
+                case 2:
+                    frame = InterleaveBlocks<2, Traits>(in, frames, dest);
+                    break;
+                case 6:
+                    frame = InterleaveBlocks<6, Traits>(in, frames, dest);
+                    break;
+                case 8:
+                    frame = InterleaveBlocks<8, Traits>(in, frames, dest);
+                    break;
+                default:
+                    return false;
+            }
+
+            for (; frame < frames; ++frame) {
+                for (int ch = 0; ch < channels; ++ch)
+                    dest[frame * channels + ch] = Traits::FromFloat(in[ch][frame]);
+            }
+            return true;
+        }
+#endif
+
+        bool Deinterleave(const int16_t* source, int channels, int frames,
+                          float* const* dest, int frameOffset) {
+#if defined(ARCH_CPU_X86_FAMILY)
+            return DeinterleaveSSE(source, channels, frames, dest, frameOffset);
+#else
+            return false;
+#endif
+        }
+
+        bool Deinterleave(const int32_t* source, int channels, int frames,
+                          float* const* dest, int frameOffset) {
+#if defined(ARCH_CPU_X86_FAMILY)
+            return DeinterleaveSSE(source, channels, frames, dest, frameOffset);
+#else
+            return false;
+#endif
+        }
+
+        bool Deinterleave(const PackedInt24* source, int channels, int frames,
+                          float* const* dest, int frameOffset) {
+#if defined(ARCH_CPU_X86_FAMILY)
+            return DeinterleaveSSE(source, channels, frames, dest, frameOffset);
+#else
+            return false;
+#endif
+        }
+
+        bool Deinterleave(const float* source, int channels, int frames,
+                          float* const* dest, int frameOffset) {
+#if defined(ARCH_CPU_X86_FAMILY)
+            return DeinterleaveSSE(source, channels, frames, dest, frameOffset);
+#else
+            return false;
+#endif
+        }
+
+        bool DeinterleaveS24In32(const int32_t* source, int channels, int frames,
+                                 float* const* dest, int frameOffset) {
+#if defined(ARCH_CPU_X86_FAMILY)
+            return DeinterleaveSSE<int32_t, SignedInt24In32SampleTypeTraits>(
+                    source, channels, frames, dest, frameOffset);
+#else
+            return false;
+#endif
+        }
+
+        bool Interleave(const float* const* source, int frameOffset, int channels,
+                        int frames, int16_t* dest) {
+#if defined(ARCH_CPU_X86_FAMILY)
+            return InterleaveSSE(source, frameOffset, channels, frames, dest);
+#else
+            return false;
+#endif
+        }
+
+        bool Interleave(const float* const* source, int frameOffset, int channels,
+                        int frames, int32_t* dest) {
+#if defined(ARCH_CPU_X86_FAMILY)
+            return InterleaveSSE(source, frameOffset, channels, frames, dest);
+#else
+            return false;
+#endif
+        }
+
+        bool Interleave(const float* const* source, int frameOffset, int channels,
+                        int frames, PackedInt24* dest) {
+#if defined(ARCH_CPU_X86_FAMILY)
+            return InterleaveSSE(source, frameOffset, channels, frames, dest);
+#else
+            return false;
+#endif
+        }
+
+        bool Interleave(const float* const* source, int frameOffset, int channels,
+                        int frames, float* dest) {
+#if defined(ARCH_CPU_X86_FAMILY)
+            return InterleaveSSE(source, frameOffset, channels, frames, dest);
+#else
+            return false;
+#endif
+        }
+
+        bool InterleaveS24In32(const float* const* source, int frameOffset, int channels,
+                               int frames, int32_t* dest) {
+#if defined(ARCH_CPU_X86_FAMILY)
+            return InterleaveSSE<int32_t, SignedInt24In32SampleTypeTraits>(
+                    source, frameOffset, channels, frames, dest);
+#else
+            return false;
+#endif
+        }
+    }
+}
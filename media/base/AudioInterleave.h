@@ -0,0 +1,117 @@
+//
+// Created by wang rl on 2022/7/5.
+//
+
+#ifndef MULTIMEDIA_AUDIO_INTERLEAVE_H
+#define MULTIMEDIA_AUDIO_INTERLEAVE_H
+
+#include <cstdint>
+#include "media/base/AudioSampleTypes.h"
+
+namespace mm {
+    namespace audio_interleave {
+        // Vectorized conversion between interleaved samples and planar float for
+        // the common channel counts (mono, stereo, 5.1 and 7.1). Each sample
+        // format is converted in one pass over the interleaved buffer. The results
+        // are bit-exact with the SampleTypeTraits conversions.
+        //
+        // |dest| / |source| are the per channel float arrays and |frameOffset| is
+        // the first frame used in each of them. All functions return false,
+        // without touching any data, if there is no optimized version for
+        // |channels| on this CPU; the caller should then fall back to the generic
+        // code.
+        bool Deinterleave(const int16_t* source, int channels, int frames,
+                          float* const* dest, int frameOffset);
+
+        bool Deinterleave(const int32_t* source, int channels, int frames,
+                          float* const* dest, int frameOffset);
+
+        bool Deinterleave(const PackedInt24* source, int channels, int frames,
+                          float* const* dest, int frameOffset);
+
+        bool Deinterleave(const float* source, int channels, int frames,
+                          float* const* dest, int frameOffset);
+
+        // 24-bit samples in the low bits of int32_t, see
+        // SignedInt24In32SampleTypeTraits.
+        bool DeinterleaveS24In32(const int32_t* source, int channels, int frames,
+                                 float* const* dest, int frameOffset);
+
+        // Values outside of [-1, 1] are clipped.
+        bool Interleave(const float* const* source, int frameOffset, int channels,
+                        int frames, int16_t* dest);
+
+        bool Interleave(const float* const* source, int frameOffset, int channels,
+                        int frames, int32_t* dest);
+
+        bool Interleave(const float* const* source, int frameOffset, int channels,
+                        int frames, PackedInt24* dest);
+
+        bool Interleave(const float* const* source, int frameOffset, int channels,
+                        int frames, float* dest);
+
+        bool InterleaveS24In32(const float* const* source, int frameOffset, int channels,
+                               int frames, int32_t* dest);
+
+        // Maps a SampleTypeTraits to the optimized functions above. Formats
+        // without an optimized version always return false.
+        template<class SampleTypeTraits>
+        struct Kernels {
+            static bool Deinterleave(const typename SampleTypeTraits::ValueType*,
+                                     int, int, float* const*, int) {
+                return false;
+            }
+
+            static bool Interleave(const float* const*, int, int, int,
+                                   typename SampleTypeTraits::ValueType*) {
+                return false;
+            }
+        };
+
+        template<typename SampleType>
+        struct OptimizedKernels {
+            static bool Deinterleave(const SampleType* source, int channels, int frames,
+                                     float* const* dest, int frameOffset) {
+                return audio_interleave::Deinterleave(source, channels, frames,
+                                                      dest, frameOffset);
+            }
+
+            static bool Interleave(const float* const* source, int frameOffset,
+                                   int channels, int frames, SampleType* dest) {
+                return audio_interleave::Interleave(source, frameOffset, channels,
+                                                    frames, dest);
+            }
+        };
+
+        template<>
+        struct Kernels<SignedInt16SampleTypeTraits> : OptimizedKernels<int16_t> {
+        };
+
+        template<>
+        struct Kernels<SignedInt32SampleTypeTraits> : OptimizedKernels<int32_t> {
+        };
+
+        template<>
+        struct Kernels<SignedInt24PackedSampleTypeTraits> : OptimizedKernels<PackedInt24> {
+        };
+
+        template<>
+        struct Kernels<SignedInt24In32SampleTypeTraits> {
+            static bool Deinterleave(const int32_t* source, int channels, int frames,
+                                     float* const* dest, int frameOffset) {
+                return DeinterleaveS24In32(source, channels, frames, dest, frameOffset);
+            }
+
+            static bool Interleave(const float* const* source, int frameOffset,
+                                   int channels, int frames, int32_t* dest) {
+                return InterleaveS24In32(source, frameOffset, channels, frames, dest);
+            }
+        };
+
+        template<>
+        struct Kernels<Float32SampleTypeTraits> : OptimizedKernels<float> {
+        };
+    }
+}
+
+#endif //MULTIMEDIA_AUDIO_INTERLEAVE_H
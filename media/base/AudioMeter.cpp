@@ -0,0 +1,84 @@
+//
+// Created by wang rl on 2022/7/11.
+//
+
+#include <algorithm>
+#include <cmath>
+#include <glog/logging.h>
+#include "media/base/AudioMeter.h"
+#include "media/base/VectorMath.h"
+
+namespace mm {
+    // FSTATS() sums in single precision; feeding it blocks of this size and
+    // adding the block results in double precision keeps the RMS and DC offset
+    // of long streams and long buses accurate.
+    static const int kStatisticsBlockFrames = 4096;
+
+    AudioMeter::AudioMeter(int channels, float clipLevel)
+            : mClipLevel(clipLevel),
+              mChannels(channels),
+              mFrames(0) {
+        CHECK_GT(channels, 0);
+        CHECK_GT(clipLevel, 0);
+    }
+
+    void AudioMeter::update(const AudioBus* bus) {
+        CHECK_EQ(bus->channels(), channels());
+        for (int ch = 0; ch < bus->channels(); ++ch)
+            accumulate(ch, bus->channel(ch), bus->frames());
+        mFrames += bus->frames();
+    }
+
+    void AudioMeter::update(const AudioBusView& view) {
+        CHECK_EQ(view.channels(), channels());
+        for (int ch = 0; ch < view.channels(); ++ch)
+            accumulate(ch, view.channel(ch), view.frames());
+        mFrames += view.frames();
+    }
+
+    void AudioMeter::accumulate(int channel, const float* data, int frames) {
+        ChannelState& state = mChannels[channel];
+        for (int offset = 0; offset < frames; offset += kStatisticsBlockFrames) {
+            const vector_math::Statistics stats = vector_math::FSTATS(
+                    data + offset, std::min(kStatisticsBlockFrames, frames - offset),
+                    mClipLevel);
+            state.peak = std::max(state.peak, stats.peak);
+            state.sum += stats.sum;
+            state.sumSquares += stats.sum_squares;
+            state.clipped += stats.clipped;
+        }
+    }
+
+    AudioMeter::Levels AudioMeter::levels(int channel) const {
+        CHECK_GE(channel, 0);
+        CHECK_LT(channel, channels());
+        const ChannelState& state = mChannels[channel];
+        Levels levels;
+        if (mFrames == 0)
+            return levels;
+        levels.peak = state.peak;
+        levels.rms = float(std::sqrt(state.sumSquares / double(mFrames)));
+        levels.dcOffset = float(state.sum / double(mFrames));
+        levels.clippedSamples = state.clipped;
+        return levels;
+    }
+
+    float AudioMeter::peak() const {
+        float peak = 0;
+        for (const ChannelState& state : mChannels)
+            peak = std::max(peak, state.peak);
+        return peak;
+    }
+
+    int64_t AudioMeter::clippedSamples() const {
+        int64_t clipped = 0;
+        for (const ChannelState& state : mChannels)
+            clipped += state.clipped;
+        return clipped;
+    }
+
+    void AudioMeter::reset() {
+        std::fill(mChannels.begin(), mChannels.end(), ChannelState());
+        mFrames = 0;
+    }
+}
@@ -0,0 +1,79 @@
+//
+// Created by wang rl on 2022/7/11.
+//
+
+#ifndef MULTIMEDIA_AUDIO_METER_H
+#define MULTIMEDIA_AUDIO_METER_H
+
+#include <cstdint>
+#include <vector>
+#include "media/base/AudioBus.h"
+#include "media/base/AudioBusView.h"
+
+namespace mm {
+    // Measures the levels of each channel of a stream of audio: peak, RMS, DC
+    // offset and the number of clipped samples. Every channel is read once per
+    // update(), with vector_math::FSTATS(), so a meter is cheap enough to keep
+    // running on every decoded block. Consecutive updates accumulate until
+    // reset() is called.
+    class AudioMeter {
+    public:
+        struct Levels {
+            // Largest absolute sample value.
+            float peak = 0;
+
+            float rms = 0;
+
+            // Mean sample value.
+            float dcOffset = 0;
+
+            // Number of samples whose absolute value reached the clip level.
+            int64_t clippedSamples = 0;
+        };
+
+        // Samples with an absolute value of at least |clipLevel| are counted as
+        // clipped; the default matches the range AudioBus::copyAndClipTo() and
+        // the sample format conversions clamp to.
+        explicit AudioMeter(int channels, float clipLevel = 1.0f);
+
+        // Adds all frames of |bus|, which must have channels() channels.
+        void update(const AudioBus* bus);
+
+        void update(const AudioBusView& view);
+
+        // Levels of |channel| over all frames since construction or the last
+        // reset(). All zero if no frames were added yet.
+        Levels levels(int channel) const;
+
+        // Peak over all channels.
+        float peak() const;
+
+        // Total clipped samples over all channels.
+        int64_t clippedSamples() const;
+
+        // Number of frames added since construction or the last reset().
+        int64_t frames() const { return mFrames; }
+
+        int channels() const { return static_cast<int>(mChannels.size()); }
+
+        void reset();
+
+    private:
+        struct ChannelState {
+            float peak = 0;
+            double sum = 0;
+            double sumSquares = 0;
+            int64_t clipped = 0;
+        };
+
+        void accumulate(int channel, const float* data, int frames);
+
+        const float mClipLevel;
+
+        std::vector<ChannelState> mChannels;
+
+        int64_t mFrames;
+    };
+}
+
+#endif //MULTIMEDIA_AUDIO_METER_H
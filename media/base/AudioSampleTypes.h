@@ -9,6 +9,7 @@
 #include <cstdint>
 #include <limits>
 #include <type_traits>
+#include "media/base/SampleConversion.h"
 
 // To specify different sample formats, we provide a class for each sample
 // format that knows certain things about it, such as the C++ data type used
@@ -28,6 +29,8 @@
 //     converts it to the corresponding float value
 //   * A static method ConvertToDouble() that takes a ValueType sample value and
 //     converts it to the corresponding double value
+//   * Static methods FromFloatArray() and ToFloatArray() converting whole
+//     arrays, with exactly the same results as the per sample methods
 
 namespace mm {
     // For float or double.
@@ -60,6 +63,24 @@ namespace mm {
             return To<double>(source_value);
         }
 
+        static void FromFloatArray(const float* source, int count, SampleType* dest) {
+            if constexpr (sample_conversion::HasArrayConversion<SampleType>::value) {
+                sample_conversion::FromFloat(source, count, dest);
+            } else {
+                for (int i = 0; i < count; ++i)
+                    dest[i] = FromFloat(source[i]);
+            }
+        }
+
+        static void ToFloatArray(const SampleType* source, int count, float* dest) {
+            if constexpr (sample_conversion::HasArrayConversion<SampleType>::value) {
+                sample_conversion::ToFloat(source, count, dest);
+            } else {
+                for (int i = 0; i < count; ++i)
+                    dest[i] = ToFloat(source[i]);
+            }
+        }
+
     private:
         template<typename FloatType>
         static SampleType From(FloatType source_value) {
@@ -108,6 +129,17 @@ namespace mm {
             return To<double>(source_value);
         }
 
+        // Plain casts, which the compiler vectorizes by itself.
+        static void FromFloatArray(const float* source, int count, SampleType* dest) {
+            for (int i = 0; i < count; ++i)
+                dest[i] = FromFloat(source[i]);
+        }
+
+        static void ToFloatArray(const SampleType* source, int count, float* dest) {
+            for (int i = 0; i < count; ++i)
+                dest[i] = ToFloat(source[i]);
+        }
+
     private:
         template<typename FloatType>
         static SampleType From(FloatType source_value) {
@@ -154,6 +186,24 @@ namespace mm {
             return To<double>(source_value);
         }
 
+        static void FromFloatArray(const float* source, int count, SampleType* dest) {
+            if constexpr (sample_conversion::HasArrayConversion<SampleType>::value) {
+                sample_conversion::FromFloat(source, count, dest);
+            } else {
+                for (int i = 0; i < count; ++i)
+                    dest[i] = FromFloat(source[i]);
+            }
+        }
+
+        static void ToFloatArray(const SampleType* source, int count, float* dest) {
+            if constexpr (sample_conversion::HasArrayConversion<SampleType>::value) {
+                sample_conversion::ToFloat(source, count, dest);
+            } else {
+                for (int i = 0; i < count; ++i)
+                    dest[i] = ToFloat(source[i]);
+            }
+        }
+
     private:
         // We pre-compute the scaling factors for conversion at compile-time in order
         // to save computation time during runtime.
@@ -252,6 +302,113 @@ namespace mm {
         }
     };
 
+    // A 24-bit sample packed into three little-endian bytes, as found in WAV and
+    // AIFF files. Arrays of it have no padding.
+    struct PackedInt24 {
+        uint8_t bytes[3];
+    };
+
+    static_assert(sizeof(PackedInt24) == 3, "PackedInt24 must not be padded");
+
+    // For signed 24-bit samples, either packed (StorageType PackedInt24) or
+    // sign-extended into the low bits of an int32_t (StorageType int32_t).
+    // Scaling and clipping are those of FixedSampleTypeTraits for a 24-bit
+    // integer type.
+    // See also the aliases for commonly used types at the bottom of this file.
+    template<typename StorageType>
+    class SignedInt24SampleTypeTraits {
+        static_assert(std::is_same<StorageType, PackedInt24>::value ||
+                      std::is_same<StorageType, int32_t>::value,
+                      "Template is only valid for PackedInt24 and int32_t.");
+
+    public:
+        using ValueType = StorageType;
+
+        // The range of the sample values, not of StorageType.
+        static constexpr int32_t kMinValue = -(1 << 23);
+        static constexpr int32_t kMaxValue = (1 << 23) - 1;
+        static constexpr int32_t kZeroPointValue = 0;
+
+        static StorageType FromFloat(float source_value) {
+            return Store(From<float>(source_value));
+        }
+
+        static float ToFloat(StorageType source_value) {
+            return To<float>(Load(source_value));
+        }
+
+        static StorageType FromDouble(double source_value) {
+            return Store(From<double>(source_value));
+        }
+
+        static double ToDouble(StorageType source_value) {
+            return To<double>(Load(source_value));
+        }
+
+        static void FromFloatArray(const float* source, int count, StorageType* dest) {
+            if constexpr (std::is_same<StorageType, PackedInt24>::value) {
+                sample_conversion::FromFloat(source, count, dest);
+            } else {
+                sample_conversion::FromFloatS24In32(source, count, dest);
+            }
+        }
+
+        static void ToFloatArray(const StorageType* source, int count, float* dest) {
+            if constexpr (std::is_same<StorageType, PackedInt24>::value) {
+                sample_conversion::ToFloat(source, count, dest);
+            } else {
+                sample_conversion::ToFloatS24In32(source, count, dest);
+            }
+        }
+
+    private:
+        static StorageType Store(int32_t value) {
+            if constexpr (std::is_same<StorageType, PackedInt24>::value) {
+                const auto bits = static_cast<uint32_t>(value);
+                return {{static_cast<uint8_t>(bits), static_cast<uint8_t>(bits >> 8),
+                         static_cast<uint8_t>(bits >> 16)}};
+            } else {
+                return value;
+            }
+        }
+
+        static int32_t Load(StorageType value) {
+            if constexpr (std::is_same<StorageType, PackedInt24>::value) {
+                // Place the sample in the top bits and shift back to sign extend.
+                const uint32_t bits = (uint32_t(value.bytes[0]) << 8) |
+                                      (uint32_t(value.bytes[1]) << 16) |
+                                      (uint32_t(value.bytes[2]) << 24);
+                return static_cast<int32_t>(bits) >> 8;
+            } else {
+                return value;
+            }
+        }
+
+        // Same as FixedSampleTypeTraits::From() and To(); 2^23 - 1 and 2^23
+        // are exact in float, so one factor per sign is enough.
+        template<typename FloatType>
+        static int32_t From(FloatType source_value) {
+            if (source_value < 0) {
+                if (source_value <= FloatSampleTypeTraits<float>::kMinValue)
+                    return kMinValue;
+                return static_cast<int32_t>(
+                        source_value * static_cast<FloatType>(-kMinValue));
+            } else {
+                if (source_value >= FloatSampleTypeTraits<float>::kMaxValue)
+                    return kMaxValue;
+                return static_cast<int32_t>(
+                        source_value * static_cast<FloatType>(kMaxValue));
+            }
+        }
+
+        template<typename FloatType>
+        static FloatType To(int32_t source_value) {
+            const auto value = static_cast<FloatType>(source_value);
+            return value < 0 ? value * (FloatType(1) / static_cast<FloatType>(-kMinValue))
+                             : value * (FloatType(1) / static_cast<FloatType>(kMaxValue));
+        }
+    };
+
     // Aliases for commonly used sample formats.
     using Float32SampleTypeTraits = FloatSampleTypeTraits<float>;
     using Float32SampleTypeTraitsNoClip = FloatSampleTypeTraitsNoClip<float>;
@@ -259,6 +416,8 @@ namespace mm {
     using UnsignedInt8SampleTypeTraits = FixedSampleTypeTraits<uint8_t>;
     using SignedInt16SampleTypeTraits = FixedSampleTypeTraits<int16_t>;
     using SignedInt32SampleTypeTraits = FixedSampleTypeTraits<int32_t>;
+    using SignedInt24PackedSampleTypeTraits = SignedInt24SampleTypeTraits<PackedInt24>;
+    using SignedInt24In32SampleTypeTraits = SignedInt24SampleTypeTraits<int32_t>;
 }
 
 #endif //MULTIMEDIA_AUDIO_SAMPLE_TYPES_H
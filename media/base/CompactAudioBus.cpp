@@ -0,0 +1,151 @@
+//
+// Created by wang rl on 2022/7/14.
+//
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <glog/logging.h>
+#include "base/utils/BuildConfig.h"
+#include "media/base/CompactAudioBus.h"
+
+#if defined(ARCH_CPU_X86_FAMILY)
+#include "media/base/SampleConversionSSE.h"
+#endif
+
+namespace mm {
+    // Largest magnitude stored in a block; symmetric, so +peak and -peak both
+    // map to exact values.
+    static const float kSampleRange = 32767.0f;
+
+    // Returns the largest absolute value of |src|.
+    static float BlockPeak(const float* src, int len) {
+        int i = 0;
+        float peak = 0;
+#if defined(ARCH_CPU_X86_FAMILY)
+        const __m128 m_abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+        __m128 m_peak = _mm_setzero_ps();
+        for (; i + 4 <= len; i += 4)
+            m_peak = _mm_max_ps(m_peak, _mm_and_ps(_mm_loadu_ps(src + i), m_abs_mask));
+        m_peak = _mm_max_ps(m_peak, _mm_movehl_ps(m_peak, m_peak));
+        m_peak = _mm_max_ss(m_peak, _mm_shuffle_ps(m_peak, m_peak, 1));
+        peak = _mm_cvtss_f32(m_peak);
+#endif
+        for (; i < len; ++i)
+            peak = std::max(peak, std::fabs(src[i]));
+        return peak;
+    }
+
+    // Stores |src| * |inverse| rounded to the nearest integer. Both the vector
+    // and the scalar code round half to even and saturate, so the result does
+    // not depend on the alignment of a block.
+    static void CompactBlock(const float* src, int len, float inverse, int16_t* dest) {
+        int i = 0;
+#if defined(ARCH_CPU_X86_FAMILY)
+        const __m128 m_inverse = _mm_set1_ps(inverse);
+        for (; i + 8 <= len; i += 8) {
+            const __m128i low = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(src + i), m_inverse));
+            const __m128i high = _mm_cvtps_epi32(
+                    _mm_mul_ps(_mm_loadu_ps(src + i + 4), m_inverse));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i),
+                             _mm_packs_epi32(low, high));
+        }
+#endif
+        for (; i < len; ++i) {
+            const float value = std::nearbyint(src[i] * inverse);
+            dest[i] = static_cast<int16_t>(std::clamp(value, -32768.0f, 32767.0f));
+        }
+    }
+
+    static void ExpandBlock(const int16_t* src, int len, float scale, float* dest) {
+        int i = 0;
+#if defined(ARCH_CPU_X86_FAMILY)
+        const __m128 m_scale = _mm_set1_ps(scale);
+        for (; i + 4 <= len; i += 4)
+            _mm_storeu_ps(dest + i, _mm_mul_ps(sse::Int16AsFloat(src + i), m_scale));
+#endif
+        for (; i < len; ++i)
+            dest[i] = static_cast<float>(src[i]) * scale;
+    }
+
+    std::unique_ptr<CompactAudioBus> CompactAudioBus::Create(int channels, int frames) {
+        return std::unique_ptr<CompactAudioBus>(new CompactAudioBus(channels, frames));
+    }
+
+    size_t CompactAudioBus::CalculateMemorySize(int channels, int frames) {
+        const size_t blocks = (size_t(frames) + kBlockFrames - 1) / kBlockFrames;
+        return size_t(channels) * blocks * (kBlockFrames * sizeof(int16_t) + sizeof(float));
+    }
+
+    CompactAudioBus::CompactAudioBus(int channels, int frames)
+            : mChannels(channels),
+              mFrames(frames),
+              mBlocks((frames + kBlockFrames - 1) / kBlockFrames),
+              mChannelStride(size_t(mBlocks) * kBlockFrames),
+              mScales(size_t(channels) * mBlocks) {
+        CHECK_GT(channels, 0);
+        CHECK_GE(frames, 0);
+        const size_t size = std::max<size_t>(
+                sizeof(int16_t) * mChannelStride * size_t(channels),
+                AudioBus::kChannelAlignment);
+        mSamples.reset(static_cast<int16_t*>(
+                AlignedAlloc(size, AudioBus::kChannelAlignment, MemoryTag::kCache)));
+        zero();
+    }
+
+    void CompactAudioBus::zero() {
+        memset(mSamples.get(), 0, sizeof(int16_t) * mChannelStride * size_t(mChannels));
+        std::fill(mScales.begin(), mScales.end(), 0.0f);
+    }
+
+    void CompactAudioBus::fromAudioBus(const AudioBusView& source, int destStartFrame) {
+        CHECK_EQ(source.channels(), mChannels);
+        CHECK_GE(destStartFrame, 0);
+        CHECK_EQ(destStartFrame % kBlockFrames, 0);
+        CHECK_LE(source.frames(), mFrames - destStartFrame);
+
+        const int firstBlock = destStartFrame / kBlockFrames;
+        for (int ch = 0; ch < mChannels; ++ch) {
+            const float* in = source.channel(ch);
+            int16_t* out = mutableChannel(ch) + destStartFrame;
+            float* scales = &mScales[size_t(ch) * mBlocks + firstBlock];
+            for (int frame = 0; frame < source.frames(); frame += kBlockFrames) {
+                const int len = std::min(kBlockFrames, source.frames() - frame);
+                const float peak = BlockPeak(in + frame, len);
+                // Below about 1e-34 the inverse overflows to inf, which would
+                // turn samples into -32768. Such blocks are stored as silence.
+                const float inverse = kSampleRange / peak;
+                if (peak >= std::numeric_limits<float>::min() && std::isfinite(inverse)) {
+                    CompactBlock(in + frame, len, inverse, out + frame);
+                    *scales++ = peak / kSampleRange;
+                } else {
+                    std::fill(out + frame, out + frame + len, int16_t(0));
+                    *scales++ = 0;
+                }
+                // Don't leave stale samples in a partially written block.
+                std::fill(out + frame + len, out + frame + kBlockFrames, int16_t(0));
+            }
+        }
+    }
+
+    void CompactAudioBus::toAudioBus(int sourceStartFrame, const AudioBusView& dest) const {
+        CHECK_EQ(dest.channels(), mChannels);
+        CHECK_GE(sourceStartFrame, 0);
+        CHECK_LE(dest.frames(), mFrames - sourceStartFrame);
+
+        for (int ch = 0; ch < mChannels; ++ch) {
+            const int16_t* in = channel(ch);
+            float* out = dest.channel(ch);
+            int frame = sourceStartFrame;
+            const int endFrame = sourceStartFrame + dest.frames();
+            while (frame < endFrame) {
+                const int block = frame / kBlockFrames;
+                const int len = std::min((block + 1) * kBlockFrames, endFrame) - frame;
+                ExpandBlock(in + frame, len, blockScale(ch, block), out);
+                frame += len;
+                out += len;
+            }
+        }
+    }
+}
@@ -0,0 +1,100 @@
+//
+// Created by wang rl on 2022/7/14.
+//
+
+#ifndef MULTIMEDIA_COMPACT_AUDIO_BUS_H
+#define MULTIMEDIA_COMPACT_AUDIO_BUS_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "base/memory/AlignedMemory.h"
+#include "media/base/AudioBus.h"
+#include "media/base/AudioBusView.h"
+
+namespace mm {
+    // Planar storage of decoded audio at half the size of an AudioBus, meant
+    // for keeping large amounts of audio resident, e.g. a cache of decoded
+    // tracks. Every channel is split into blocks of kBlockFrames frames; each
+    // block stores int16_t samples plus one float scale derived from the block
+    // peak, so quiet passages keep their resolution. The error of a sample is
+    // at most half the scale of its block, i.e. about peak / 65534.
+    //
+    // Processing works on regular AudioBus blocks: fromAudioBus() compacts
+    // frames and toAudioBus() expands any range of frames again, both
+    // vectorized. Samples must be finite. The memory is accounted under
+    // MemoryTag::kCache.
+    class CompactAudioBus {
+    public:
+        static constexpr int kBlockFrames = 256;
+
+        // Creates a bus of |channels| channels of |frames| frames, all zero.
+        static std::unique_ptr<CompactAudioBus> Create(int channels, int frames);
+
+        // Bytes used for the samples and scales of a bus of the given size.
+        static size_t CalculateMemorySize(int channels, int frames);
+
+        int channels() const { return mChannels; }
+
+        int frames() const { return mFrames; }
+
+        size_t memorySize() const { return CalculateMemorySize(mChannels, mFrames); }
+
+        void zero();
+
+        // Compacts all frames of |source|, which must have channels() channels,
+        // into the frames starting at |destStartFrame|. |destStartFrame| must be
+        // a multiple of kBlockFrames, since every block is compacted as a whole;
+        // a partially written last block holds zeros after |source|.
+        void fromAudioBus(const AudioBusView& source, int destStartFrame = 0);
+
+        void fromAudioBus(const AudioBus* source, int destStartFrame = 0) {
+            fromAudioBus(AudioBusView(const_cast<AudioBus*>(source)), destStartFrame);
+        }
+
+        // Expands |dest|.frames() frames starting at |sourceStartFrame| into
+        // |dest|, which must have channels() channels. Any frame range works.
+        void toAudioBus(int sourceStartFrame, const AudioBusView& dest) const;
+
+        void toAudioBus(int sourceStartFrame, AudioBus* dest) const {
+            toAudioBus(sourceStartFrame, AudioBusView(dest));
+        }
+
+        // The compacted samples of |channel|, and the factor turning the samples
+        // of |block| back into float.
+        const int16_t* channel(int channel) const {
+            return mSamples.get() + size_t(channel) * mChannelStride;
+        }
+
+        float blockScale(int channel, int block) const {
+            return mScales[size_t(channel) * mBlocks + block];
+        }
+
+        CompactAudioBus(const CompactAudioBus&) = delete;
+
+        CompactAudioBus& operator=(const CompactAudioBus&) = delete;
+
+    private:
+        CompactAudioBus(int channels, int frames);
+
+        int16_t* mutableChannel(int channel) {
+            return mSamples.get() + size_t(channel) * mChannelStride;
+        }
+
+        const int mChannels;
+
+        const int mFrames;
+
+        // Number of blocks per channel, the last one may be partial.
+        const int mBlocks;
+
+        // Samples per channel, rounded up to whole blocks.
+        const size_t mChannelStride;
+
+        std::unique_ptr<int16_t, AlignedFreeDeleter> mSamples;
+
+        std::vector<float> mScales;
+    };
+}
+
+#endif //MULTIMEDIA_COMPACT_AUDIO_BUS_H
@@ -0,0 +1,242 @@
+//
+// Created by wang rl on 2022/7/12.
+//
+
+#ifndef MULTIMEDIA_INTERLEAVED_AUDIO_BUFFER_H
+#define MULTIMEDIA_INTERLEAVED_AUDIO_BUFFER_H
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <glog/logging.h>
+#include "base/memory/AlignedMemory.h"
+#include "media/base/AudioBus.h"
+#include "media/base/AudioBusView.h"
+#include "media/base/AudioSampleTypes.h"
+
+namespace mm {
+    // Holds frames() frames of channels() channels interleaved as
+    // [ch0, ch1, ..., chN, ch0, ch1, ...] in the sample format described by
+    // SampleTypeTraits, see AudioSampleTypes.h. Pipelines that only move PCM
+    // around, e.g. 16 kHz s16 speech, can keep their data in the native format
+    // instead of round tripping every block through a float AudioBus, and
+    // convert to and from an AudioBus only where float processing is needed.
+    //
+    // Like AudioBus, the memory is either allocated and owned by the buffer,
+    // aligned by alignment() bytes, or provided to WrapMemory().
+    template<class SampleTypeTraits>
+    class InterleavedAudioBuffer {
+    public:
+        using ValueType = typename SampleTypeTraits::ValueType;
+
+        // Creates a buffer of |channels| channels of |frames| frames. The
+        // contents are undefined. |alignment| must be one of the AudioBus
+        // channel alignments.
+        static std::unique_ptr<InterleavedAudioBuffer> Create(
+                int channels, int frames,
+                int alignment = AudioBus::kChannelAlignment);
+
+        // Creates a buffer using the existing |data|, which must hold at least
+        // |channels| * |frames| samples and outlive the returned buffer.
+        static std::unique_ptr<InterleavedAudioBuffer> WrapMemory(int channels,
+                                                                  int frames,
+                                                                  ValueType* data);
+
+        // Size in bytes of the sample data.
+        static size_t CalculateMemorySize(int channels, int frames) {
+            return sizeof(ValueType) * size_t(channels) * size_t(frames);
+        }
+
+        // Returns a raw pointer to the first sample of |frame|.
+        ValueType* frame(int frame) { return mSamples + size_t(frame) * mChannels; }
+
+        const ValueType* frame(int frame) const {
+            return mSamples + size_t(frame) * mChannels;
+        }
+
+        ValueType* data() { return mSamples; }
+
+        const ValueType* data() const { return mSamples; }
+
+        int channels() const { return mChannels; }
+
+        int frames() const { return mFrames; }
+
+        size_t sizeInBytes() const { return CalculateMemorySize(mChannels, mFrames); }
+
+        // Sets every sample to SampleTypeTraits::kZeroPointValue.
+        void zero() { zeroFramesPartial(0, mFrames); }
+
+        void zeroFramesPartial(int startFrame, int frames);
+
+        // Copies |frameCount| frames starting at |sourceStartFrame| to
+        // |destStartFrame| of |dest|, which must have the same channels().
+        void copyPartialFramesTo(int sourceStartFrame, int frameCount,
+                                 int destStartFrame,
+                                 InterleavedAudioBuffer* dest) const;
+
+        // Like copyPartialFramesTo(), but |dest| may use another sample format.
+        // Samples are converted through float in small blocks, without an
+        // intermediate AudioBus; for the same format this is a plain copy, e.g.
+        // s16 to s16 or f32 to f32, and no float round trip happens at all.
+        template<class DestSampleTypeTraits>
+        void convertPartialFramesTo(int sourceStartFrame, int frameCount,
+                                    int destStartFrame,
+                                    InterleavedAudioBuffer<DestSampleTypeTraits>* dest) const;
+
+        template<class DestSampleTypeTraits>
+        void convertTo(InterleavedAudioBuffer<DestSampleTypeTraits>* dest) const {
+            convertPartialFramesTo(0, mFrames, 0, dest);
+        }
+
+        // Converts all frames to float and writes them to |dest|, which must have
+        // the same channels() and at least frames() frames. Frames of |dest|
+        // beyond frames() are left untouched.
+        void toAudioBus(const AudioBusView& dest) const;
+
+        void toAudioBus(AudioBus* dest) const { toAudioBus(AudioBusView(dest)); }
+
+        // Converts |source|, which must have the same channels() and at most
+        // frames() frames, to the sample format of this buffer. The remaining
+        // frames are zeroed out, like AudioBus::fromInterleaved() does.
+        void fromAudioBus(const AudioBusView& source);
+
+        void fromAudioBus(const AudioBus* source) {
+            fromAudioBus(AudioBusView(const_cast<AudioBus*>(source)));
+        }
+
+        InterleavedAudioBuffer(const InterleavedAudioBuffer&) = delete;
+
+        InterleavedAudioBuffer& operator=(const InterleavedAudioBuffer&) = delete;
+
+    private:
+        template<class OtherSampleTypeTraits>
+        friend class InterleavedAudioBuffer;
+
+        InterleavedAudioBuffer(int channels, int frames, ValueType* samples,
+                               ValueType* ownedSamples);
+
+        static void CheckRange(int startFrame, int frames, int totalFrames) {
+            CHECK_GE(startFrame, 0);
+            CHECK_GE(frames, 0);
+            CHECK_LE(startFrame, totalFrames - frames);
+        }
+
+        // Set if the memory is owned by this instance.
+        std::unique_ptr<ValueType, AlignedFreeDeleter> mData;
+
+        ValueType* mSamples;
+
+        int mChannels;
+
+        int mFrames;
+    };
+
+    // Buffer types of the common fixed point formats.
+    using InterleavedAudioBufferS16 = InterleavedAudioBuffer<SignedInt16SampleTypeTraits>;
+    using InterleavedAudioBufferS32 = InterleavedAudioBuffer<SignedInt32SampleTypeTraits>;
+    using InterleavedAudioBufferS24 = InterleavedAudioBuffer<SignedInt24PackedSampleTypeTraits>;
+
+    // template implementation
+    template<class SampleTypeTraits>
+    std::unique_ptr<InterleavedAudioBuffer<SampleTypeTraits>>
+    InterleavedAudioBuffer<SampleTypeTraits>::Create(int channels, int frames,
+                                                     int alignment) {
+        CHECK_GT(channels, 0);
+        CHECK_GE(frames, 0);
+        CHECK(AudioBus::IsValidAlignment(alignment)) << alignment;
+        // AlignedAlloc() may require a multiple of the alignment as size.
+        const size_t size = CalculateMemorySize(channels, frames);
+        auto* samples = static_cast<ValueType*>(AlignedAlloc(
+                std::max<size_t>((size + alignment - 1) & ~size_t(alignment - 1),
+                                 alignment),
+                alignment));
+        return std::unique_ptr<InterleavedAudioBuffer>(
+                new InterleavedAudioBuffer(channels, frames, samples, samples));
+    }
+
+    template<class SampleTypeTraits>
+    std::unique_ptr<InterleavedAudioBuffer<SampleTypeTraits>>
+    InterleavedAudioBuffer<SampleTypeTraits>::WrapMemory(int channels, int frames,
+                                                         ValueType* data) {
+        CHECK_GT(channels, 0);
+        CHECK_GE(frames, 0);
+        CHECK(data);
+        return std::unique_ptr<InterleavedAudioBuffer>(
+                new InterleavedAudioBuffer(channels, frames, data, nullptr));
+    }
+
+    template<class SampleTypeTraits>
+    InterleavedAudioBuffer<SampleTypeTraits>::InterleavedAudioBuffer(
+            int channels, int frames, ValueType* samples, ValueType* ownedSamples)
+            : mData(ownedSamples),
+              mSamples(samples),
+              mChannels(channels),
+              mFrames(frames) {}
+
+    template<class SampleTypeTraits>
+    void InterleavedAudioBuffer<SampleTypeTraits>::zeroFramesPartial(int startFrame,
+                                                                     int frames) {
+        CheckRange(startFrame, frames, mFrames);
+        // kZeroPointValue isn't a ValueType for the packed formats.
+        std::fill(frame(startFrame), frame(startFrame + frames),
+                  SampleTypeTraits::FromFloat(0.0f));
+    }
+
+    template<class SampleTypeTraits>
+    void InterleavedAudioBuffer<SampleTypeTraits>::copyPartialFramesTo(
+            int sourceStartFrame, int frameCount, int destStartFrame,
+            InterleavedAudioBuffer* dest) const {
+        CHECK_EQ(mChannels, dest->mChannels);
+        CheckRange(sourceStartFrame, frameCount, mFrames);
+        CheckRange(destStartFrame, frameCount, dest->mFrames);
+        memmove(dest->frame(destStartFrame), frame(sourceStartFrame),
+                CalculateMemorySize(mChannels, frameCount));
+    }
+
+    template<class SampleTypeTraits>
+    template<class DestSampleTypeTraits>
+    void InterleavedAudioBuffer<SampleTypeTraits>::convertPartialFramesTo(
+            int sourceStartFrame, int frameCount, int destStartFrame,
+            InterleavedAudioBuffer<DestSampleTypeTraits>* dest) const {
+        if constexpr (std::is_same<SampleTypeTraits, DestSampleTypeTraits>::value) {
+            copyPartialFramesTo(sourceStartFrame, frameCount, destStartFrame, dest);
+        } else {
+            CHECK_EQ(mChannels, dest->mChannels);
+            CheckRange(sourceStartFrame, frameCount, mFrames);
+            CheckRange(destStartFrame, frameCount, dest->mFrames);
+            // Interleaved frames are contiguous, so convert the samples as one
+            // array. The block is small enough to stay in L1.
+            constexpr int kBlockSize = 512;
+            float block[kBlockSize];
+            const ValueType* in = frame(sourceStartFrame);
+            auto* out = dest->frame(destStartFrame);
+            const size_t count = size_t(mChannels) * size_t(frameCount);
+            for (size_t i = 0; i < count; i += kBlockSize) {
+                const int n = static_cast<int>(std::min<size_t>(kBlockSize, count - i));
+                SampleTypeTraits::ToFloatArray(in + i, n, block);
+                DestSampleTypeTraits::FromFloatArray(block, n, out + i);
+            }
+        }
+    }
+
+    template<class SampleTypeTraits>
+    void InterleavedAudioBuffer<SampleTypeTraits>::toAudioBus(
+            const AudioBusView& dest) const {
+        CHECK_EQ(mChannels, dest.channels());
+        CHECK_LE(mFrames, dest.frames());
+        dest.fromInterleavedPartial<SampleTypeTraits>(mSamples, 0, mFrames);
+    }
+
+    template<class SampleTypeTraits>
+    void InterleavedAudioBuffer<SampleTypeTraits>::fromAudioBus(
+            const AudioBusView& source) {
+        CHECK_EQ(mChannels, source.channels());
+        CHECK_LE(source.frames(), mFrames);
+        source.toInterleaved<SampleTypeTraits>(source.frames(), mSamples);
+        zeroFramesPartial(source.frames(), mFrames - source.frames());
+    }
+}
+
+#endif //MULTIMEDIA_INTERLEAVED_AUDIO_BUFFER_H
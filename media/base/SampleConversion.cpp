@@ -0,0 +1,145 @@
+//
+// Created by wang rl on 2022/7/13.
+//
+
+#include <algorithm>
+#include "base/utils/BuildConfig.h"
+#include "media/base/AudioSampleTypes.h"
+#include "media/base/SampleConversion.h"
+
+#if defined(ARCH_CPU_X86_FAMILY)
+#include "media/base/SampleConversionSSE.h"
+#endif
+
+namespace mm {
+    namespace sample_conversion {
+        // The traits each sample type is converted with.
+        template<typename SampleType>
+        struct TraitsFor;
+
+        template<>
+        struct TraitsFor<uint8_t> {
+            using Type = UnsignedInt8SampleTypeTraits;
+        };
+
+        template<>
+        struct TraitsFor<int16_t> {
+            using Type = SignedInt16SampleTypeTraits;
+        };
+
+        template<>
+        struct TraitsFor<int32_t> {
+            using Type = SignedInt32SampleTypeTraits;
+        };
+
+        template<>
+        struct TraitsFor<PackedInt24> {
+            using Type = SignedInt24PackedSampleTypeTraits;
+        };
+
+        template<>
+        struct TraitsFor<float> {
+            using Type = Float32SampleTypeTraits;
+        };
+
+        template<>
+        struct TraitsFor<double> {
+            using Type = Float64SampleTypeTraits;
+        };
+
+        // Converts four samples per iteration with the SSE helpers, which are
+        // bit-exact with the traits, and the remaining ones with the traits.
+        template<typename SampleType>
+        static void FromFloatImpl(const float* source, int count, SampleType* dest) {
+            using Traits = typename TraitsFor<SampleType>::Type;
+            int i = 0;
+#if defined(ARCH_CPU_X86_FAMILY)
+            for (; i + 4 <= count; i += 4)
+                sse::StoreFromFloat(_mm_loadu_ps(source + i), dest + i);
+#endif
+            for (; i < count; ++i)
+                dest[i] = Traits::FromFloat(source[i]);
+        }
+
+        template<typename SampleType>
+        static void ToFloatImpl(const SampleType* source, int count, float* dest) {
+            using Traits = typename TraitsFor<SampleType>::Type;
+            int i = 0;
+#if defined(ARCH_CPU_X86_FAMILY)
+            for (; i + 4 <= count; i += 4)
+                _mm_storeu_ps(dest + i, sse::LoadAsFloat(source + i));
+#endif
+            for (; i < count; ++i)
+                dest[i] = Traits::ToFloat(source[i]);
+        }
+
+        void FromFloat(const float* source, int count, uint8_t* dest) {
+            FromFloatImpl(source, count, dest);
+        }
+
+        void FromFloat(const float* source, int count, int16_t* dest) {
+            FromFloatImpl(source, count, dest);
+        }
+
+        void FromFloat(const float* source, int count, int32_t* dest) {
+            FromFloatImpl(source, count, dest);
+        }
+
+        void FromFloat(const float* source, int count, PackedInt24* dest) {
+            FromFloatImpl(source, count, dest);
+        }
+
+        void FromFloat(const float* source, int count, float* dest) {
+            FromFloatImpl(source, count, dest);
+        }
+
+        void FromFloat(const float* source, int count, double* dest) {
+            FromFloatImpl(source, count, dest);
+        }
+
+        void ToFloat(const uint8_t* source, int count, float* dest) {
+            ToFloatImpl(source, count, dest);
+        }
+
+        void ToFloat(const int16_t* source, int count, float* dest) {
+            ToFloatImpl(source, count, dest);
+        }
+
+        void ToFloat(const int32_t* source, int count, float* dest) {
+            ToFloatImpl(source, count, dest);
+        }
+
+        void ToFloat(const PackedInt24* source, int count, float* dest) {
+            ToFloatImpl(source, count, dest);
+        }
+
+        void ToFloat(const float* source, int count, float* dest) {
+            // Float32SampleTypeTraits::ToFloat() doesn't clip.
+            std::copy(source, source + count, dest);
+        }
+
+        void ToFloat(const double* source, int count, float* dest) {
+            ToFloatImpl(source, count, dest);
+        }
+
+        void FromFloatS24In32(const float* source, int count, int32_t* dest) {
+            int i = 0;
+#if defined(ARCH_CPU_X86_FAMILY)
+            for (; i + 4 <= count; i += 4)
+                sse::StoreFromFloatS24In32(_mm_loadu_ps(source + i), dest + i);
+#endif
+            for (; i < count; ++i)
+                dest[i] = SignedInt24In32SampleTypeTraits::FromFloat(source[i]);
+        }
+
+        void ToFloatS24In32(const int32_t* source, int count, float* dest) {
+            int i = 0;
+#if defined(ARCH_CPU_X86_FAMILY)
+            for (; i + 4 <= count; i += 4)
+                _mm_storeu_ps(dest + i, sse::LoadS24In32AsFloat(source + i));
+#endif
+            for (; i < count; ++i)
+                dest[i] = SignedInt24In32SampleTypeTraits::ToFloat(source[i]);
+        }
+    }
+}
@@ -0,0 +1,68 @@
+//
+// Created by wang rl on 2022/7/13.
+//
+
+#ifndef MULTIMEDIA_SAMPLE_CONVERSION_H
+#define MULTIMEDIA_SAMPLE_CONVERSION_H
+
+#include <cstdint>
+#include <type_traits>
+
+namespace mm {
+    struct PackedInt24;
+
+    namespace sample_conversion {
+        // Array versions of the FromFloat() and ToFloat() methods of the
+        // clipping SampleTypeTraits in AudioSampleTypes.h: u8, s16 and s32 via
+        // FixedSampleTypeTraits, float and double via FloatSampleTypeTraits and
+        // packed s24 via SignedInt24SampleTypeTraits.
+        // They convert |count| samples, vectorized where the CPU allows it, and
+        // the results are bit-exact with the scalar methods. Use the
+        // FromFloatArray() / ToFloatArray() methods of the traits rather than
+        // calling these directly.
+        void FromFloat(const float* source, int count, uint8_t* dest);
+
+        void FromFloat(const float* source, int count, int16_t* dest);
+
+        void FromFloat(const float* source, int count, int32_t* dest);
+
+        void FromFloat(const float* source, int count, PackedInt24* dest);
+
+        void FromFloat(const float* source, int count, float* dest);
+
+        void FromFloat(const float* source, int count, double* dest);
+
+        void ToFloat(const uint8_t* source, int count, float* dest);
+
+        void ToFloat(const int16_t* source, int count, float* dest);
+
+        void ToFloat(const int32_t* source, int count, float* dest);
+
+        void ToFloat(const PackedInt24* source, int count, float* dest);
+
+        void ToFloat(const float* source, int count, float* dest);
+
+        void ToFloat(const double* source, int count, float* dest);
+
+        // 24-bit samples sign-extended into int32_t, which can't be told apart
+        // from s32 by type.
+        void FromFloatS24In32(const float* source, int count, int32_t* dest);
+
+        void ToFloatS24In32(const int32_t* source, int count, float* dest);
+
+        // Whether the FromFloat() and ToFloat() overloads above exist for
+        // |SampleType|.
+        template<typename SampleType>
+        struct HasArrayConversion
+                : std::integral_constant<bool,
+                        std::is_same<SampleType, uint8_t>::value ||
+                        std::is_same<SampleType, int16_t>::value ||
+                        std::is_same<SampleType, int32_t>::value ||
+                        std::is_same<SampleType, PackedInt24>::value ||
+                        std::is_same<SampleType, float>::value ||
+                        std::is_same<SampleType, double>::value> {
+        };
+    }
+}
+
+#endif //MULTIMEDIA_SAMPLE_CONVERSION_H
@@ -0,0 +1,252 @@
+//
+// Created by wang rl on 2022/7/5.
+//
+
+// SSE2 helpers converting four samples at a time between the integer and
+// float formats described in AudioSampleTypes.h. The results are bit-exact
+// with the scalar FromFloat()/ToFloat() methods of the SampleTypeTraits, the
+// scaling factors are derived from the traits themselves. Only include this
+// file from translation units that are built for x86.
+
+#ifndef MULTIMEDIA_SAMPLE_CONVERSION_SSE_H
+#define MULTIMEDIA_SAMPLE_CONVERSION_SSE_H
+
+#include <cstring>
+#include <emmintrin.h>
+#include "media/base/AudioSampleTypes.h"
+
+namespace mm {
+    namespace sse {
+        // Scaling factors of a FixedSampleTypeTraits for float conversions. These
+        // are the same expressions as ScalingFactors<float> in AudioSampleTypes.h,
+        // which keeps the vectorized code bit-exact with the scalar one.
+        template<class SampleTypeTraits>
+        struct FixedScale {
+            static constexpr float kForPositiveInput =
+                    static_cast<float>(SampleTypeTraits::kMaxValue) -
+                    static_cast<float>(SampleTypeTraits::kZeroPointValue);
+
+            static constexpr float kForNegativeInput =
+                    static_cast<float>(SampleTypeTraits::kZeroPointValue) -
+                    static_cast<float>(SampleTypeTraits::kMinValue);
+
+            static constexpr float kInverseForPositiveInput = 1.0f / kForPositiveInput;
+
+            static constexpr float kInverseForNegativeInput = 1.0f / kForNegativeInput;
+        };
+
+        // Returns |negative| in the lanes where |value| < 0 and |positive| in all
+        // other lanes.
+        inline __m128 SelectBySign(__m128 value, __m128 negative, __m128 positive) {
+            const __m128 mask = _mm_cmplt_ps(value, _mm_setzero_ps());
+            return _mm_or_ps(_mm_and_ps(mask, negative),
+                             _mm_andnot_ps(mask, positive));
+        }
+
+        // Converts four samples starting at |source| to float.
+        inline __m128 LoadAsFloat(const float* source) {
+            return _mm_loadu_ps(source);
+        }
+
+        inline __m128 LoadAsFloat(const double* source) {
+            return _mm_movelh_ps(_mm_cvtpd_ps(_mm_loadu_pd(source)),
+                                 _mm_cvtpd_ps(_mm_loadu_pd(source + 2)));
+        }
+
+        inline __m128 LoadAsFloat(const uint8_t* source) {
+            using Traits = UnsignedInt8SampleTypeTraits;
+            using Scale = FixedScale<Traits>;
+            const __m128 kNegative = _mm_set1_ps(Scale::kInverseForNegativeInput);
+            const __m128 kPositive = _mm_set1_ps(Scale::kInverseForPositiveInput);
+            int32_t packed;
+            memcpy(&packed, source, sizeof(packed));
+            const __m128i zero = _mm_setzero_si128();
+            __m128i value = _mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero);
+            value = _mm_sub_epi32(_mm_unpacklo_epi16(value, zero),
+                                  _mm_set1_epi32(Traits::kZeroPointValue));
+            const __m128 result = _mm_cvtepi32_ps(value);
+            return _mm_mul_ps(result, SelectBySign(result, kNegative, kPositive));
+        }
+
+        // Converts four int16_t samples starting at |source| to float without
+        // scaling them, for callers applying a scale of their own.
+        inline __m128 Int16AsFloat(const int16_t* source) {
+            const __m128i value = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(source));
+            // Sign extend to 32 bits.
+            return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(value, value), 16));
+        }
+
+        inline __m128 LoadAsFloat(const int16_t* source) {
+            using Scale = FixedScale<SignedInt16SampleTypeTraits>;
+            const __m128 kNegative = _mm_set1_ps(Scale::kInverseForNegativeInput);
+            const __m128 kPositive = _mm_set1_ps(Scale::kInverseForPositiveInput);
+            const __m128 result = Int16AsFloat(source);
+            return _mm_mul_ps(result, SelectBySign(result, kNegative, kPositive));
+        }
+
+        inline __m128 LoadAsFloat(const int32_t* source) {
+            using Scale = FixedScale<SignedInt32SampleTypeTraits>;
+            const __m128 kNegative = _mm_set1_ps(Scale::kInverseForNegativeInput);
+            const __m128 kPositive = _mm_set1_ps(Scale::kInverseForPositiveInput);
+            const __m128 result = _mm_cvtepi32_ps(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(source)));
+            // Both factors are 2^-31 for int32_t, skip the select in that case.
+            if constexpr (Scale::kInverseForNegativeInput ==
+                          Scale::kInverseForPositiveInput) {
+                return _mm_mul_ps(result, kPositive);
+            }
+            return _mm_mul_ps(result, SelectBySign(result, kNegative, kPositive));
+        }
+
+        // 24-bit samples in the low bits of four int32_t lanes, converted like
+        // SignedInt24SampleTypeTraits::ToFloat().
+        inline __m128 Int24AsFloat(__m128i value) {
+            using Traits = SignedInt24PackedSampleTypeTraits;
+            const __m128 kNegative = _mm_set1_ps(1.0f / -float(Traits::kMinValue));
+            const __m128 kPositive = _mm_set1_ps(1.0f / float(Traits::kMaxValue));
+            const __m128 result = _mm_cvtepi32_ps(value);
+            return _mm_mul_ps(result, SelectBySign(result, kNegative, kPositive));
+        }
+
+        inline __m128 LoadAsFloat(const PackedInt24* source) {
+            // Read exactly the 12 bytes of the four samples.
+            int32_t tail;
+            const __m128i low = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(source));
+            memcpy(&tail, reinterpret_cast<const uint8_t*>(source) + 8, sizeof(tail));
+            const __m128i bytes = _mm_unpacklo_epi64(low, _mm_cvtsi32_si128(tail));
+            // Move sample k to the low three bytes of lane k, then sign extend
+            // from bit 23 by shifting it to the top and back.
+            const __m128i lanes01 = _mm_unpacklo_epi32(bytes, _mm_srli_si128(bytes, 3));
+            const __m128i lanes23 = _mm_unpacklo_epi32(_mm_srli_si128(bytes, 6),
+                                                       _mm_srli_si128(bytes, 9));
+            const __m128i value = _mm_unpacklo_epi64(lanes01, lanes23);
+            return Int24AsFloat(_mm_srai_epi32(_mm_slli_epi32(value, 8), 8));
+        }
+
+        inline __m128 LoadS24In32AsFloat(const int32_t* source) {
+            return Int24AsFloat(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source)));
+        }
+
+        // Converts |value| and stores four samples starting at |dest|. Out of range
+        // values are clipped like FromFloat() does.
+        inline void StoreFromFloat(__m128 value, float* dest) {
+            // _mm_max_ps() returns the second operand for NaN, i.e. -1.
+            value = _mm_max_ps(value, _mm_set1_ps(Float32SampleTypeTraits::kMinValue));
+            _mm_storeu_ps(dest, _mm_min_ps(value,
+                                           _mm_set1_ps(Float32SampleTypeTraits::kMaxValue)));
+        }
+
+        inline void StoreFromFloat(__m128 value, double* dest) {
+            value = _mm_max_ps(value, _mm_set1_ps(Float32SampleTypeTraits::kMinValue));
+            value = _mm_min_ps(value, _mm_set1_ps(Float32SampleTypeTraits::kMaxValue));
+            _mm_storeu_pd(dest, _mm_cvtps_pd(value));
+            _mm_storeu_pd(dest + 2, _mm_cvtps_pd(_mm_movehl_ps(value, value)));
+        }
+
+        inline void StoreFromFloat(__m128 value, uint8_t* dest) {
+            using Traits = UnsignedInt8SampleTypeTraits;
+            using Scale = FixedScale<Traits>;
+            const __m128 kNegative = _mm_set1_ps(Scale::kForNegativeInput);
+            const __m128 kPositive = _mm_set1_ps(Scale::kForPositiveInput);
+            // Scale, then add the zero point like FromFloat(); the clamp to the
+            // uint8_t range covers the inputs outside of [-1, 1].
+            value = _mm_add_ps(_mm_mul_ps(value, SelectBySign(value, kNegative, kPositive)),
+                               _mm_set1_ps(Traits::kZeroPointValue));
+            value = _mm_max_ps(value, _mm_set1_ps(Traits::kMinValue));
+            value = _mm_min_ps(value, _mm_set1_ps(Traits::kMaxValue));
+            __m128i result = _mm_cvttps_epi32(value);
+            result = _mm_packs_epi32(result, result);
+            const int32_t packed = _mm_cvtsi128_si32(_mm_packus_epi16(result, result));
+            memcpy(dest, &packed, sizeof(packed));
+        }
+
+        inline void StoreFromFloat(__m128 value, int16_t* dest) {
+            using Traits = SignedInt16SampleTypeTraits;
+            using Scale = FixedScale<Traits>;
+            const __m128 kNegative = _mm_set1_ps(Scale::kForNegativeInput);
+            const __m128 kPositive = _mm_set1_ps(Scale::kForPositiveInput);
+            value = _mm_mul_ps(value, SelectBySign(value, kNegative, kPositive));
+            // Scaled values beyond the int16_t range are exactly the inputs outside
+            // of [-1, 1], so clamping after the multiplication matches FromFloat().
+            value = _mm_max_ps(value, _mm_set1_ps(Traits::kMinValue));
+            value = _mm_min_ps(value, _mm_set1_ps(Traits::kMaxValue));
+            const __m128i result = _mm_cvttps_epi32(value);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(dest),
+                             _mm_packs_epi32(result, result));
+        }
+
+        inline void StoreFromFloat(__m128 value, int32_t* dest) {
+            using Traits = SignedInt32SampleTypeTraits;
+            using Scale = FixedScale<Traits>;
+            const __m128 kNegative = _mm_set1_ps(Scale::kForNegativeInput);
+            const __m128 kPositive = _mm_set1_ps(Scale::kForPositiveInput);
+            // float can't represent INT32_MAX, so handle |value| >= 1 separately.
+            // Values <= -1 convert to INT32_MIN by themselves.
+            const __m128i clip = _mm_castps_si128(
+                    _mm_cmpge_ps(value, _mm_set1_ps(Float32SampleTypeTraits::kMaxValue)));
+            if constexpr (Scale::kForNegativeInput == Scale::kForPositiveInput) {
+                value = _mm_mul_ps(value, kPositive);
+            } else {
+                value = _mm_mul_ps(value, SelectBySign(value, kNegative, kPositive));
+            }
+            const __m128i result = _mm_cvttps_epi32(value);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dest),
+                             _mm_or_si128(_mm_and_si128(clip, _mm_set1_epi32(Traits::kMaxValue)),
+                                          _mm_andnot_si128(clip, result)));
+        }
+
+        // Converts |value| like SignedInt24SampleTypeTraits::FromFloat() into
+        // the low bits of four int32_t lanes.
+        inline __m128i FloatToInt24(__m128 value) {
+            using Traits = SignedInt24PackedSampleTypeTraits;
+            const __m128 kNegative = _mm_set1_ps(-float(Traits::kMinValue));
+            const __m128 kPositive = _mm_set1_ps(float(Traits::kMaxValue));
+            value = _mm_mul_ps(value, SelectBySign(value, kNegative, kPositive));
+            // As for int16_t, the scaled values beyond the range are exactly the
+            // inputs outside of [-1, 1].
+            value = _mm_max_ps(value, _mm_set1_ps(float(Traits::kMinValue)));
+            value = _mm_min_ps(value, _mm_set1_ps(float(Traits::kMaxValue)));
+            return _mm_cvttps_epi32(value);
+        }
+
+        inline void StoreFromFloat(__m128 value, PackedInt24* dest) {
+            const __m128i lanes = _mm_and_si128(FloatToInt24(value),
+                                                _mm_set1_epi32(0x00ffffff));
+            // Move the low three bytes of lane k to byte 3 * k.
+            const __m128i lane0 = _mm_set_epi32(0, 0, 0, -1);
+            __m128i packed = _mm_and_si128(lanes, lane0);
+            packed = _mm_or_si128(packed, _mm_slli_si128(
+                    _mm_and_si128(_mm_srli_si128(lanes, 4), lane0), 3));
+            packed = _mm_or_si128(packed, _mm_slli_si128(
+                    _mm_and_si128(_mm_srli_si128(lanes, 8), lane0), 6));
+            packed = _mm_or_si128(packed, _mm_slli_si128(_mm_srli_si128(lanes, 12), 9));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(dest), packed);
+            const int32_t tail = _mm_cvtsi128_si32(_mm_srli_si128(packed, 8));
+            memcpy(reinterpret_cast<uint8_t*>(dest) + 8, &tail, sizeof(tail));
+        }
+
+        inline void StoreFromFloatS24In32(__m128 value, int32_t* dest) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dest), FloatToInt24(value));
+        }
+
+        // LoadAsFloat() and StoreFromFloat() picked by SampleTypeTraits rather
+        // than by sample type, which tells apart the int32_t based formats.
+        template<class SampleTypeTraits>
+        struct Converter {
+            using ValueType = typename SampleTypeTraits::ValueType;
+
+            static __m128 Load(const ValueType* source) { return LoadAsFloat(source); }
+
+            static void Store(__m128 value, ValueType* dest) { StoreFromFloat(value, dest); }
+        };
+
+        template<>
+        struct Converter<SignedInt24In32SampleTypeTraits> {
+            static __m128 Load(const int32_t* source) { return LoadS24In32AsFloat(source); }
+
+            static void Store(__m128 value, int32_t* dest) { StoreFromFloatS24In32(value, dest); }
+        };
+    }
+}
+
+#endif //MULTIMEDIA_SAMPLE_CONVERSION_SSE_H
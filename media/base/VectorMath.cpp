@@ -0,0 +1,561 @@
+//
+// Created by wang rl on 2022/7/4.
+//
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include "base/cpu/CPU.h"
+#include "media/base/AudioSampleTypes.h"
+#include "media/base/VectorMath.h"
+#include "media/base/VectorMathTesting.h"
+
+#if defined(ARCH_CPU_X86_FAMILY)
+#include <emmintrin.h>
+#endif
+
+namespace mm {
+    namespace vector_math {
+        // Returns the number of leading elements of |dest| that must be processed
+        // one by one before |dest| + result is aligned by |alignment| bytes.
+        static int LeadingElements(const float* dest, int len, size_t alignment) {
+            const auto misalignment =
+                    reinterpret_cast<uintptr_t>(dest) & (alignment - 1);
+            if (misalignment == 0)
+                return 0;
+            // Never aligned; leave everything to the scalar code.
+            if (misalignment % sizeof(float) != 0)
+                return len;
+            const int leading = int((alignment - misalignment) / sizeof(float));
+            return leading < len ? leading : len;
+        }
+
+        void FMUL_C(const float src[], float scale, int len, float dest[]) {
+            for (int i = 0; i < len; ++i)
+                dest[i] = src[i] * scale;
+        }
+
+        void FMAC_C(const float src[], float scale, int len, float dest[]) {
+            for (int i = 0; i < len; ++i)
+                dest[i] += src[i] * scale;
+        }
+
+        void FMIXRange_C(const float* const src[], const float scale[], int count,
+                         int offset, int len, float dest[], bool clip) {
+            if (count == 0) {
+                std::fill(dest + offset, dest + offset + len, 0.0f);
+                return;
+            }
+
+            // Sum a tile of every input into a local accumulator before writing
+            // |dest|, which keeps the inputs streaming and allows |dest| to be
+            // one of them.
+            constexpr int kTileSize = 64;
+            float acc[kTileSize];
+            for (int tile = offset; tile < offset + len; tile += kTileSize) {
+                const int size = std::min(kTileSize, offset + len - tile);
+                FMUL_C(src[0] + tile, scale[0], size, acc);
+                for (int k = 1; k < count; ++k)
+                    FMAC_C(src[k] + tile, scale[k], size, acc);
+                if (clip)
+                    FCLAMP_C(acc, size, dest + tile);
+                else
+                    std::copy(acc, acc + size, dest + tile);
+            }
+        }
+
+        void FMIX_C(const float* const src[], const float scale[], int count,
+                    int len, float dest[], bool clip) {
+            FMIXRange_C(src, scale, count, 0, len, dest, clip);
+        }
+
+        void ExpRampLanes(float start, float ratio, int offset, float gains[],
+                          float* step) {
+            for (int j = 0; j < kRampLanes; ++j)
+                gains[j] = float(start * std::pow(double(ratio), offset + j));
+            *step = float(std::pow(double(ratio), int(kRampLanes)));
+        }
+
+        void CrossfadeLanes(float start_angle, float angle_increment, int offset,
+                            float cosines[], float sines[],
+                            float* cos_delta, float* sin_delta) {
+            for (int j = 0; j < kRampLanes; ++j) {
+                const double angle =
+                        start_angle + double(angle_increment) * (offset + j);
+                cosines[j] = float(std::cos(angle));
+                sines[j] = float(std::sin(angle));
+            }
+            // cos(step) - 1 computed without cancellation; with tiny steps cos(step)
+            // itself rounds to a value close to 1 and the rotation would drift.
+            const double half_step = double(angle_increment) * kRampLanes / 2;
+            *cos_delta = float(-2 * std::sin(half_step) * std::sin(half_step));
+            *sin_delta = float(std::sin(double(angle_increment) * kRampLanes));
+        }
+
+        void FRAMP_C(const float src[], float start, float increment, int len,
+                     float dest[]) {
+            for (int i = 0; i < len; ++i)
+                dest[i] = src[i] * (start + float(i) * increment);
+        }
+
+        void FEXPRAMP_C(const float src[], float start, float ratio, int len,
+                        float dest[]) {
+            float gains[kRampLanes];
+            float step = 0;
+            for (int i = 0; i < len; i += kRampLanes) {
+                if (i % kRampSegment == 0)
+                    ExpRampLanes(start, ratio, i, gains, &step);
+                const int size = std::min(int(kRampLanes), len - i);
+                for (int j = 0; j < size; ++j)
+                    dest[i + j] = src[i + j] * gains[j];
+                for (int j = 0; j < kRampLanes; ++j)
+                    gains[j] *= step;
+            }
+        }
+
+        void FCROSSFADE_C(const float src_out[], const float src_in[],
+                          float start_angle, float angle_increment, int len,
+                          float dest[]) {
+            float cosines[kRampLanes];
+            float sines[kRampLanes];
+            float cos_delta = 0, sin_delta = 0;
+            for (int i = 0; i < len; i += kRampLanes) {
+                if (i % kRampSegment == 0) {
+                    CrossfadeLanes(start_angle, angle_increment, i, cosines, sines,
+                                   &cos_delta, &sin_delta);
+                }
+                const int size = std::min(int(kRampLanes), len - i);
+                for (int j = 0; j < size; ++j)
+                    dest[i + j] = src_out[i + j] * cosines[j] + src_in[i + j] * sines[j];
+                for (int j = 0; j < kRampLanes; ++j) {
+                    const float c =
+                            cosines[j] + (cosines[j] * cos_delta - sines[j] * sin_delta);
+                    sines[j] = sines[j] + (sines[j] * cos_delta + cosines[j] * sin_delta);
+                    cosines[j] = c;
+                }
+            }
+        }
+
+        void FCLAMP_C(const float src[], int len, float dest[]) {
+            for (int i = 0; i < len; ++i)
+                dest[i] = Float32SampleTypeTraits::FromFloat(src[i]);
+        }
+
+        bool IsZero_C(const float src[], int len) {
+            for (int i = 0; i < len; ++i) {
+                if (src[i])
+                    return false;
+            }
+            return true;
+        }
+
+        // Adds the statistics of |src| to |stats|.
+        static void AccumulateStatistics_C(const float src[], int len,
+                                           float clip_level, Statistics* stats) {
+            for (int i = 0; i < len; ++i) {
+                const float value = src[i];
+                const float magnitude = std::fabs(value);
+                if (magnitude > stats->peak)
+                    stats->peak = magnitude;
+                if (magnitude >= clip_level)
+                    ++stats->clipped;
+                stats->sum += value;
+                stats->sum_squares += value * value;
+            }
+        }
+
+        Statistics FSTATS_C(const float src[], int len, float clip_level) {
+            Statistics stats;
+            AccumulateStatistics_C(src, len, clip_level, &stats);
+            return stats;
+        }
+
+#if defined(ARCH_CPU_X86_FAMILY)
+        void FMUL_SSE(const float src[], float scale, int len, float dest[]) {
+            const int leading = LeadingElements(dest, len, 16);
+            FMUL_C(src, scale, leading, dest);
+
+            const __m128 m_scale = _mm_set_ps1(scale);
+            const int last_index = leading + ((len - leading) & ~3);
+            for (int i = leading; i < last_index; i += 4)
+                _mm_store_ps(dest + i, _mm_mul_ps(_mm_loadu_ps(src + i), m_scale));
+
+            // Handle any remaining values that wouldn't fit in an SSE pass.
+            FMUL_C(src + last_index, scale, len - last_index, dest + last_index);
+        }
+
+        void FMAC_SSE(const float src[], float scale, int len, float dest[]) {
+            const int leading = LeadingElements(dest, len, 16);
+            FMAC_C(src, scale, leading, dest);
+
+            const __m128 m_scale = _mm_set_ps1(scale);
+            const int last_index = leading + ((len - leading) & ~3);
+            for (int i = leading; i < last_index; i += 4) {
+                _mm_store_ps(dest + i, _mm_add_ps(_mm_load_ps(dest + i),
+                        _mm_mul_ps(_mm_loadu_ps(src + i), m_scale)));
+            }
+
+            FMAC_C(src + last_index, scale, len - last_index, dest + last_index);
+        }
+
+        static inline __m128 Clamp_SSE(__m128 value) {
+            // _mm_max_ps() returns its second operand for NaN, see FCLAMP_SSE().
+            return _mm_min_ps(_mm_max_ps(value, _mm_set_ps1(-1.0f)),
+                              _mm_set_ps1(1.0f));
+        }
+
+        // Sums 16 elements at |offset| of |count| > 0 inputs in four registers
+        // and stores them to |dest| once. Four independent sums hide the add
+        // latency while every input is still read as one sequential stream.
+        static inline void MixBlock16_SSE(const float* const src[],
+                                          const float scale[], int count,
+                                          int offset, float dest[], bool clip) {
+            __m128 m_scale = _mm_set_ps1(scale[0]);
+            const float* input = src[0] + offset;
+            __m128 acc0 = _mm_mul_ps(_mm_loadu_ps(input), m_scale);
+            __m128 acc1 = _mm_mul_ps(_mm_loadu_ps(input + 4), m_scale);
+            __m128 acc2 = _mm_mul_ps(_mm_loadu_ps(input + 8), m_scale);
+            __m128 acc3 = _mm_mul_ps(_mm_loadu_ps(input + 12), m_scale);
+            for (int k = 1; k < count; ++k) {
+                m_scale = _mm_set_ps1(scale[k]);
+                input = src[k] + offset;
+                acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(input), m_scale));
+                acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(input + 4), m_scale));
+                acc2 = _mm_add_ps(acc2, _mm_mul_ps(_mm_loadu_ps(input + 8), m_scale));
+                acc3 = _mm_add_ps(acc3, _mm_mul_ps(_mm_loadu_ps(input + 12), m_scale));
+            }
+            if (clip) {
+                acc0 = Clamp_SSE(acc0);
+                acc1 = Clamp_SSE(acc1);
+                acc2 = Clamp_SSE(acc2);
+                acc3 = Clamp_SSE(acc3);
+            }
+            _mm_store_ps(dest + offset, acc0);
+            _mm_store_ps(dest + offset + 4, acc1);
+            _mm_store_ps(dest + offset + 8, acc2);
+            _mm_store_ps(dest + offset + 12, acc3);
+        }
+
+        static inline void MixBlock4_SSE(const float* const src[],
+                                         const float scale[], int count,
+                                         int offset, float dest[], bool clip) {
+            __m128 acc = _mm_mul_ps(_mm_loadu_ps(src[0] + offset),
+                                    _mm_set_ps1(scale[0]));
+            for (int k = 1; k < count; ++k) {
+                acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(src[k] + offset),
+                                                 _mm_set_ps1(scale[k])));
+            }
+            _mm_store_ps(dest + offset, clip ? Clamp_SSE(acc) : acc);
+        }
+
+        void FMIX_SSE(const float* const src[], const float scale[], int count,
+                      int len, float dest[], bool clip) {
+            const int leading = count ? LeadingElements(dest, len, 16) : len;
+            FMIXRange_C(src, scale, count, 0, leading, dest, clip);
+
+            int i = leading;
+            for (; i + 16 <= len; i += 16)
+                MixBlock16_SSE(src, scale, count, i, dest, clip);
+            for (; i + 4 <= len; i += 4)
+                MixBlock4_SSE(src, scale, count, i, dest, clip);
+
+            FMIXRange_C(src, scale, count, i, len - i, dest, clip);
+        }
+
+        void FRAMP_SSE(const float src[], float start, float increment, int len,
+                       float dest[]) {
+            const int leading = LeadingElements(dest, len, 16);
+            FRAMP_C(src, start, increment, leading, dest);
+
+            // The gain is computed from the element index rather than by
+            // repeated addition, which matches FRAMP_C() exactly.
+            const __m128 m_start = _mm_set_ps1(start);
+            const __m128 m_increment = _mm_set_ps1(increment);
+            const __m128 m_four = _mm_set_ps1(4.0f);
+            __m128 index = _mm_add_ps(_mm_set_ps(3, 2, 1, 0), _mm_set_ps1(float(leading)));
+            const int last_index = leading + ((len - leading) & ~3);
+            for (int i = leading; i < last_index; i += 4) {
+                const __m128 gain = _mm_add_ps(m_start, _mm_mul_ps(index, m_increment));
+                _mm_store_ps(dest + i, _mm_mul_ps(_mm_loadu_ps(src + i), gain));
+                index = _mm_add_ps(index, m_four);
+            }
+
+            for (int i = last_index; i < len; ++i)
+                dest[i] = src[i] * (start + float(i) * increment);
+        }
+
+        // The ramps below use unaligned stores: the gains advance kRampLanes
+        // elements at a time from the first element, so there is no scalar
+        // prologue to align |dest|.
+        void FEXPRAMP_SSE(const float src[], float start, float ratio, int len,
+                          float dest[]) {
+            alignas(16) float gains[kRampLanes];
+            float step;
+            __m128 gains_lo = _mm_setzero_ps();
+            __m128 gains_hi = gains_lo;
+            __m128 m_step = gains_lo;
+            int i = 0;
+            for (; i + kRampLanes <= len; i += kRampLanes) {
+                if (i % kRampSegment == 0) {
+                    ExpRampLanes(start, ratio, i, gains, &step);
+                    gains_lo = _mm_load_ps(gains);
+                    gains_hi = _mm_load_ps(gains + 4);
+                    m_step = _mm_set_ps1(step);
+                }
+                _mm_storeu_ps(dest + i, _mm_mul_ps(_mm_loadu_ps(src + i), gains_lo));
+                _mm_storeu_ps(dest + i + 4,
+                              _mm_mul_ps(_mm_loadu_ps(src + i + 4), gains_hi));
+                gains_lo = _mm_mul_ps(gains_lo, m_step);
+                gains_hi = _mm_mul_ps(gains_hi, m_step);
+            }
+
+            if (i == len)
+                return;
+            if (i % kRampSegment == 0) {
+                ExpRampLanes(start, ratio, i, gains, &step);
+            } else {
+                _mm_store_ps(gains, gains_lo);
+                _mm_store_ps(gains + 4, gains_hi);
+            }
+            for (int j = 0; i + j < len; ++j)
+                dest[i + j] = src[i + j] * gains[j];
+        }
+
+        void FCROSSFADE_SSE(const float src_out[], const float src_in[],
+                            float start_angle, float angle_increment, int len,
+                            float dest[]) {
+            alignas(16) float cosines[kRampLanes];
+            alignas(16) float sines[kRampLanes];
+            float cos_delta, sin_delta;
+            __m128 cos_lo = _mm_setzero_ps();
+            __m128 cos_hi = cos_lo, sin_lo = cos_lo, sin_hi = cos_lo;
+            __m128 m_cos_delta = cos_lo, m_sin_delta = cos_lo;
+            int i = 0;
+            for (; i + kRampLanes <= len; i += kRampLanes) {
+                if (i % kRampSegment == 0) {
+                    CrossfadeLanes(start_angle, angle_increment, i, cosines, sines,
+                                   &cos_delta, &sin_delta);
+                    cos_lo = _mm_load_ps(cosines);
+                    cos_hi = _mm_load_ps(cosines + 4);
+                    sin_lo = _mm_load_ps(sines);
+                    sin_hi = _mm_load_ps(sines + 4);
+                    m_cos_delta = _mm_set_ps1(cos_delta);
+                    m_sin_delta = _mm_set_ps1(sin_delta);
+                }
+                _mm_storeu_ps(dest + i, _mm_add_ps(
+                        _mm_mul_ps(_mm_loadu_ps(src_out + i), cos_lo),
+                        _mm_mul_ps(_mm_loadu_ps(src_in + i), sin_lo)));
+                _mm_storeu_ps(dest + i + 4, _mm_add_ps(
+                        _mm_mul_ps(_mm_loadu_ps(src_out + i + 4), cos_hi),
+                        _mm_mul_ps(_mm_loadu_ps(src_in + i + 4), sin_hi)));
+
+                const __m128 c_lo = _mm_add_ps(cos_lo, _mm_sub_ps(
+                        _mm_mul_ps(cos_lo, m_cos_delta), _mm_mul_ps(sin_lo, m_sin_delta)));
+                const __m128 c_hi = _mm_add_ps(cos_hi, _mm_sub_ps(
+                        _mm_mul_ps(cos_hi, m_cos_delta), _mm_mul_ps(sin_hi, m_sin_delta)));
+                sin_lo = _mm_add_ps(sin_lo, _mm_add_ps(
+                        _mm_mul_ps(sin_lo, m_cos_delta), _mm_mul_ps(cos_lo, m_sin_delta)));
+                sin_hi = _mm_add_ps(sin_hi, _mm_add_ps(
+                        _mm_mul_ps(sin_hi, m_cos_delta), _mm_mul_ps(cos_hi, m_sin_delta)));
+                cos_lo = c_lo;
+                cos_hi = c_hi;
+            }
+
+            if (i == len)
+                return;
+            if (i % kRampSegment == 0) {
+                CrossfadeLanes(start_angle, angle_increment, i, cosines, sines,
+                               &cos_delta, &sin_delta);
+            } else {
+                _mm_store_ps(cosines, cos_lo);
+                _mm_store_ps(cosines + 4, cos_hi);
+                _mm_store_ps(sines, sin_lo);
+                _mm_store_ps(sines + 4, sin_hi);
+            }
+            for (int j = 0; i + j < len; ++j)
+                dest[i + j] = src_out[i + j] * cosines[j] + src_in[i + j] * sines[j];
+        }
+
+        void FCLAMP_SSE(const float src[], int len, float dest[]) {
+            const int leading = LeadingElements(dest, len, 16);
+            FCLAMP_C(src, leading, dest);
+
+            // _mm_max_ps() returns its second operand when either one is NaN, which
+            // maps NaN to -1 just like the scalar version.
+            const __m128 m_min = _mm_set_ps1(-1.0f);
+            const __m128 m_max = _mm_set_ps1(1.0f);
+            const int last_index = leading + ((len - leading) & ~3);
+            for (int i = leading; i < last_index; i += 4) {
+                const __m128 value = _mm_max_ps(_mm_loadu_ps(src + i), m_min);
+                _mm_store_ps(dest + i, _mm_min_ps(value, m_max));
+            }
+
+            FCLAMP_C(src + last_index, len - last_index, dest + last_index);
+        }
+
+        bool IsZero_SSE(const float src[], int len) {
+            const int leading = LeadingElements(src, len, 16);
+            if (!IsZero_C(src, leading))
+                return false;
+
+            // Check 16 values per iteration and bail out on the first non-zero
+            // block. The unordered compare also catches NaN.
+            const __m128 zero = _mm_setzero_ps();
+            const int last_index = leading + ((len - leading) & ~15);
+            for (int i = leading; i < last_index; i += 16) {
+                __m128 m = _mm_cmpneq_ps(_mm_load_ps(src + i), zero);
+                m = _mm_or_ps(m, _mm_cmpneq_ps(_mm_load_ps(src + i + 4), zero));
+                m = _mm_or_ps(m, _mm_cmpneq_ps(_mm_load_ps(src + i + 8), zero));
+                m = _mm_or_ps(m, _mm_cmpneq_ps(_mm_load_ps(src + i + 12), zero));
+                if (_mm_movemask_ps(m))
+                    return false;
+            }
+
+            return IsZero_C(src + last_index, len - last_index);
+        }
+
+        static inline float HorizontalSum_SSE(__m128 value) {
+            value = _mm_add_ps(value, _mm_movehl_ps(value, value));
+            value = _mm_add_ss(value, _mm_shuffle_ps(value, value, 1));
+            return _mm_cvtss_f32(value);
+        }
+
+        static inline float HorizontalMax_SSE(__m128 value) {
+            value = _mm_max_ps(value, _mm_movehl_ps(value, value));
+            value = _mm_max_ss(value, _mm_shuffle_ps(value, value, 1));
+            return _mm_cvtss_f32(value);
+        }
+
+        Statistics FSTATS_SSE(const float src[], int len, float clip_level) {
+            Statistics stats;
+            const int leading = LeadingElements(src, len, 16);
+            AccumulateStatistics_C(src, leading, clip_level, &stats);
+
+            // Clearing the sign bit gives the absolute value. With the magnitude
+            // as first operand, _mm_max_ps() keeps the current peak for NaN, and
+            // the ordered compare doesn't count NaN as clipped either. The
+            // all-ones compare result is -1 as integer, so subtracting it counts.
+            const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+            const __m128 m_clip_level = _mm_set_ps1(clip_level);
+            __m128 peak = _mm_setzero_ps();
+            __m128 sum = _mm_setzero_ps();
+            __m128 sum_squares = _mm_setzero_ps();
+            __m128i clipped = _mm_setzero_si128();
+            const int last_index = leading + ((len - leading) & ~3);
+            for (int i = leading; i < last_index; i += 4) {
+                const __m128 value = _mm_load_ps(src + i);
+                const __m128 magnitude = _mm_and_ps(value, abs_mask);
+                peak = _mm_max_ps(magnitude, peak);
+                clipped = _mm_sub_epi32(clipped, _mm_castps_si128(
+                        _mm_cmpge_ps(magnitude, m_clip_level)));
+                sum = _mm_add_ps(sum, value);
+                sum_squares = _mm_add_ps(sum_squares, _mm_mul_ps(value, value));
+            }
+
+            alignas(16) int32_t counts[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(counts), clipped);
+            stats.peak = std::max(stats.peak, HorizontalMax_SSE(peak));
+            stats.sum += HorizontalSum_SSE(sum);
+            stats.sum_squares += HorizontalSum_SSE(sum_squares);
+            stats.clipped += counts[0] + counts[1] + counts[2] + counts[3];
+
+            AccumulateStatistics_C(src + last_index, len - last_index, clip_level,
+                                   &stats);
+            return stats;
+        }
+#endif
+
+        // The implementation for each function is selected once, on first use,
+        // based on the features reported by CPUID.
+        struct Kernels {
+            decltype(&FMUL_C) fmul = FMUL_C;
+            decltype(&FMAC_C) fmac = FMAC_C;
+            decltype(&FMIX_C) fmix = FMIX_C;
+            decltype(&FRAMP_C) framp = FRAMP_C;
+            decltype(&FEXPRAMP_C) fexpramp = FEXPRAMP_C;
+            decltype(&FCROSSFADE_C) fcrossfade = FCROSSFADE_C;
+            decltype(&FCLAMP_C) fclamp = FCLAMP_C;
+            decltype(&IsZero_C) is_zero = IsZero_C;
+            decltype(&FSTATS_C) fstats = FSTATS_C;
+        };
+
+        static Kernels SelectKernels() {
+            Kernels kernels;
+#if defined(ARCH_CPU_X86_FAMILY)
+            const CPU& cpu = CPU::Get();
+            if (cpu.has_sse2()) {
+                kernels.fmul = FMUL_SSE;
+                kernels.fmac = FMAC_SSE;
+                kernels.fmix = FMIX_SSE;
+                kernels.framp = FRAMP_SSE;
+                kernels.fexpramp = FEXPRAMP_SSE;
+                kernels.fcrossfade = FCROSSFADE_SSE;
+                kernels.fclamp = FCLAMP_SSE;
+                kernels.is_zero = IsZero_SSE;
+                kernels.fstats = FSTATS_SSE;
+            }
+#if defined(MM_ENABLE_AVX2)
+            if (cpu.has_avx2()) {
+                kernels.fmul = FMUL_AVX2;
+                kernels.fmac = FMAC_AVX2;
+                kernels.fmix = FMIX_AVX2;
+                kernels.framp = FRAMP_AVX2;
+                kernels.fexpramp = FEXPRAMP_AVX2;
+                kernels.fcrossfade = FCROSSFADE_AVX2;
+                kernels.fclamp = FCLAMP_AVX2;
+                kernels.is_zero = IsZero_AVX2;
+                kernels.fstats = FSTATS_AVX2;
+            }
+#endif
+#endif
+            return kernels;
+        }
+
+        static const Kernels& GetKernels() {
+            static const Kernels kernels = SelectKernels();
+            return kernels;
+        }
+
+        void FMUL(const float src[], float scale, int len, float dest[]) {
+            GetKernels().fmul(src, scale, len, dest);
+        }
+
+        void FMAC(const float src[], float scale, int len, float dest[]) {
+            GetKernels().fmac(src, scale, len, dest);
+        }
+
+        void FMIX(const float* const src[], const float scale[], int count,
+                  int len, float dest[], bool clip) {
+            GetKernels().fmix(src, scale, count, len, dest, clip);
+        }
+
+        void FRAMP(const float src[], float start, float increment, int len,
+                   float dest[]) {
+            GetKernels().framp(src, start, increment, len, dest);
+        }
+
+        void FEXPRAMP(const float src[], float start, float ratio, int len,
+                      float dest[]) {
+            GetKernels().fexpramp(src, start, ratio, len, dest);
+        }
+
+        void FCROSSFADE(const float src_out[], const float src_in[],
+                        float start_angle, float angle_increment, int len,
+                        float dest[]) {
+            GetKernels().fcrossfade(src_out, src_in, start_angle, angle_increment,
+                                    len, dest);
+        }
+
+        void FCLAMP(const float src[], int len, float dest[]) {
+            GetKernels().fclamp(src, len, dest);
+        }
+
+        bool IsZero(const float src[], int len) {
+            return GetKernels().is_zero(src, len);
+        }
+
+        Statistics FSTATS(const float src[], int len, float clip_level) {
+            return GetKernels().fstats(src, len, clip_level);
+        }
+    }
+}
@@ -0,0 +1,92 @@
+//
+// Created by wang rl on 2022/7/4.
+//
+
+#ifndef MULTIMEDIA_VECTOR_MATH_H
+#define MULTIMEDIA_VECTOR_MATH_H
+
+namespace mm {
+    namespace vector_math {
+        // Required alignment for inputs and outputs to all vector math functions
+        // to reach full speed. Unaligned inputs are accepted, but the leading
+        // elements up to the next aligned address of |dest| are processed with
+        // scalar code. AudioBus channels always satisfy this alignment.
+        enum {
+            kRequiredAlignment = 16
+        };
+
+        // Number of consecutive gains FEXPRAMP() and FCROSSFADE() advance at
+        // once, and the number of elements after which they recompute the gains
+        // from the closed form so rounding errors can't accumulate.
+        enum {
+            kRampLanes = 8,
+            kRampSegment = 1024
+        };
+
+        // Multiply each element of |src| by |scale| and store in |dest|. |src|
+        // and |dest| may be the same buffer.
+        void FMUL(const float src[], float scale, int len, float dest[]);
+
+        // Multiply each element of |src| by |scale| and add to |dest|.
+        void FMAC(const float src[], float scale, int len, float dest[]);
+
+        // Mix |count| inputs into |dest|: dest[i] = sum_k src[k][i] * scale[k],
+        // clamped to [-1.0, 1.0] like FCLAMP() if |clip| is set. |dest| is
+        // written once per element no matter how many inputs there are, and it
+        // may also be one of the inputs. The sum is accumulated in input order,
+        // so all implementations produce identical results. |count| may be 0,
+        // which zeroes |dest|.
+        void FMIX(const float* const src[], const float scale[], int count,
+                  int len, float dest[], bool clip);
+
+        // Multiply each element of |src| by a linear ramp and store in |dest|:
+        // dest[i] = src[i] * (start + i * increment). |src| and |dest| may be
+        // the same buffer.
+        void FRAMP(const float src[], float start, float increment, int len,
+                   float dest[]);
+
+        // Multiply each element of |src| by an exponential ramp and store in
+        // |dest|: dest[i] = src[i] * start * ratio^i. The gains are advanced by
+        // repeated multiplication, kRampLanes at a time, which all versions do
+        // identically. |src| and |dest| may be the same buffer.
+        void FEXPRAMP(const float src[], float start, float ratio, int len,
+                      float dest[]);
+
+        // Equal-power crossfade from |src_out| to |src_in|: dest[i] =
+        // src_out[i] * cos(a) + src_in[i] * sin(a) with a = start_angle + i *
+        // angle_increment, in radians. The sine and cosine are advanced by
+        // rotation, kRampLanes at a time. |dest| may be either source.
+        void FCROSSFADE(const float src_out[], const float src_in[],
+                        float start_angle, float angle_increment, int len,
+                        float dest[]);
+
+        // Clamp each element of |src| to [-1.0, 1.0] and store in |dest|. NaN is
+        // mapped to -1.0 so the result matches Float32SampleTypeTraits::FromFloat().
+        // |src| and |dest| may be the same buffer.
+        void FCLAMP(const float src[], int len, float dest[]);
+
+        // Returns true if every element of |src| compares equal to zero. NaN
+        // values are treated as non-zero.
+        bool IsZero(const float src[], int len);
+
+        // Level statistics of a block of samples, see FSTATS().
+        struct Statistics {
+            // Largest absolute value.
+            float peak = 0;
+            float sum = 0;
+            float sum_squares = 0;
+            // Number of elements whose absolute value is at least the clip level.
+            int clipped = 0;
+        };
+
+        // Computes the Statistics of |src| in a single pass, counting elements
+        // at or above |clip_level| as clipped. NaN elements are ignored by peak
+        // and clipped but propagate into the sums. The SIMD versions accumulate
+        // the sums in several lanes, so they may differ from FSTATS_C() in the
+        // last bits; callers should keep |len| moderate and add the results of
+        // consecutive blocks in double precision.
+        Statistics FSTATS(const float src[], int len, float clip_level);
+    }
+}
+
+#endif //MULTIMEDIA_VECTOR_MATH_H
@@ -0,0 +1,302 @@
+//
+// Created by wang rl on 2022/7/4.
+//
+
+// This file is compiled with AVX2 enabled, so the functions in here must only
+// be called after CPU::has_avx2() has been checked. See VectorMath.cpp.
+
+#include <algorithm>
+#include <cstdint>
+#include <immintrin.h>
+#include "media/base/VectorMath.h"
+#include "media/base/VectorMathTesting.h"
+
+namespace mm {
+    namespace vector_math {
+        // Number of leading elements of |dest| to process before |dest| is
+        // 32-byte aligned; AudioBus channels are only guaranteed 16-byte aligned.
+        static int LeadingElementsAVX(const float* dest, int len) {
+            const auto misalignment = reinterpret_cast<uintptr_t>(dest) & 31;
+            if (misalignment == 0)
+                return 0;
+            // Never aligned; leave everything to the scalar code.
+            if (misalignment % sizeof(float) != 0)
+                return len;
+            const int leading = int((32 - misalignment) / sizeof(float));
+            return leading < len ? leading : len;
+        }
+
+        void FMUL_AVX2(const float src[], float scale, int len, float dest[]) {
+            const int leading = LeadingElementsAVX(dest, len);
+            FMUL_C(src, scale, leading, dest);
+
+            const __m256 m_scale = _mm256_set1_ps(scale);
+            const int last_index = leading + ((len - leading) & ~7);
+            for (int i = leading; i < last_index; i += 8) {
+                _mm256_store_ps(dest + i,
+                                _mm256_mul_ps(_mm256_loadu_ps(src + i), m_scale));
+            }
+
+            FMUL_C(src + last_index, scale, len - last_index, dest + last_index);
+        }
+
+        void FMAC_AVX2(const float src[], float scale, int len, float dest[]) {
+            const int leading = LeadingElementsAVX(dest, len);
+            FMAC_C(src, scale, leading, dest);
+
+            // Multiply and add separately rather than with FMA, so the results
+            // match the other versions bit for bit.
+            const __m256 m_scale = _mm256_set1_ps(scale);
+            const int last_index = leading + ((len - leading) & ~7);
+            for (int i = leading; i < last_index; i += 8) {
+                _mm256_store_ps(dest + i, _mm256_add_ps(_mm256_load_ps(dest + i),
+                        _mm256_mul_ps(_mm256_loadu_ps(src + i), m_scale)));
+            }
+
+            FMAC_C(src + last_index, scale, len - last_index, dest + last_index);
+        }
+
+        static inline __m256 Clamp_AVX2(__m256 value) {
+            return _mm256_min_ps(_mm256_max_ps(value, _mm256_set1_ps(-1.0f)),
+                                 _mm256_set1_ps(1.0f));
+        }
+
+        // Sums 32 elements at |offset| of |count| > 0 inputs in four registers
+        // and stores them to |dest| once.
+        static inline void MixBlock32_AVX2(const float* const src[],
+                                           const float scale[], int count,
+                                           int offset, float dest[], bool clip) {
+            __m256 m_scale = _mm256_set1_ps(scale[0]);
+            const float* input = src[0] + offset;
+            __m256 acc0 = _mm256_mul_ps(_mm256_loadu_ps(input), m_scale);
+            __m256 acc1 = _mm256_mul_ps(_mm256_loadu_ps(input + 8), m_scale);
+            __m256 acc2 = _mm256_mul_ps(_mm256_loadu_ps(input + 16), m_scale);
+            __m256 acc3 = _mm256_mul_ps(_mm256_loadu_ps(input + 24), m_scale);
+            for (int k = 1; k < count; ++k) {
+                m_scale = _mm256_set1_ps(scale[k]);
+                input = src[k] + offset;
+                acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_loadu_ps(input), m_scale));
+                acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(_mm256_loadu_ps(input + 8), m_scale));
+                acc2 = _mm256_add_ps(acc2, _mm256_mul_ps(_mm256_loadu_ps(input + 16), m_scale));
+                acc3 = _mm256_add_ps(acc3, _mm256_mul_ps(_mm256_loadu_ps(input + 24), m_scale));
+            }
+            if (clip) {
+                acc0 = Clamp_AVX2(acc0);
+                acc1 = Clamp_AVX2(acc1);
+                acc2 = Clamp_AVX2(acc2);
+                acc3 = Clamp_AVX2(acc3);
+            }
+            _mm256_store_ps(dest + offset, acc0);
+            _mm256_store_ps(dest + offset + 8, acc1);
+            _mm256_store_ps(dest + offset + 16, acc2);
+            _mm256_store_ps(dest + offset + 24, acc3);
+        }
+
+        static inline void MixBlock8_AVX2(const float* const src[],
+                                          const float scale[], int count,
+                                          int offset, float dest[], bool clip) {
+            __m256 acc = _mm256_mul_ps(_mm256_loadu_ps(src[0] + offset),
+                                       _mm256_set1_ps(scale[0]));
+            for (int k = 1; k < count; ++k) {
+                acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_loadu_ps(src[k] + offset),
+                                                       _mm256_set1_ps(scale[k])));
+            }
+            _mm256_store_ps(dest + offset, clip ? Clamp_AVX2(acc) : acc);
+        }
+
+        void FMIX_AVX2(const float* const src[], const float scale[], int count,
+                       int len, float dest[], bool clip) {
+            const int leading = count ? LeadingElementsAVX(dest, len) : len;
+            FMIXRange_C(src, scale, count, 0, leading, dest, clip);
+
+            int i = leading;
+            for (; i + 32 <= len; i += 32)
+                MixBlock32_AVX2(src, scale, count, i, dest, clip);
+            for (; i + 8 <= len; i += 8)
+                MixBlock8_AVX2(src, scale, count, i, dest, clip);
+
+            FMIXRange_C(src, scale, count, i, len - i, dest, clip);
+        }
+
+        void FRAMP_AVX2(const float src[], float start, float increment, int len,
+                        float dest[]) {
+            const int leading = LeadingElementsAVX(dest, len);
+            FRAMP_C(src, start, increment, leading, dest);
+
+            const __m256 m_start = _mm256_set1_ps(start);
+            const __m256 m_increment = _mm256_set1_ps(increment);
+            const __m256 m_eight = _mm256_set1_ps(8.0f);
+            __m256 index = _mm256_add_ps(_mm256_set_ps(7, 6, 5, 4, 3, 2, 1, 0),
+                                         _mm256_set1_ps(float(leading)));
+            const int last_index = leading + ((len - leading) & ~7);
+            for (int i = leading; i < last_index; i += 8) {
+                const __m256 gain =
+                        _mm256_add_ps(m_start, _mm256_mul_ps(index, m_increment));
+                _mm256_store_ps(dest + i, _mm256_mul_ps(_mm256_loadu_ps(src + i), gain));
+                index = _mm256_add_ps(index, m_eight);
+            }
+
+            for (int i = last_index; i < len; ++i)
+                dest[i] = src[i] * (start + float(i) * increment);
+        }
+
+        // One register holds all kRampLanes gains, see FEXPRAMP_SSE().
+        void FEXPRAMP_AVX2(const float src[], float start, float ratio, int len,
+                           float dest[]) {
+            alignas(32) float gains[kRampLanes];
+            float step;
+            __m256 m_gains = _mm256_setzero_ps();
+            __m256 m_step = m_gains;
+            int i = 0;
+            for (; i + kRampLanes <= len; i += kRampLanes) {
+                if (i % kRampSegment == 0) {
+                    ExpRampLanes(start, ratio, i, gains, &step);
+                    m_gains = _mm256_load_ps(gains);
+                    m_step = _mm256_set1_ps(step);
+                }
+                _mm256_storeu_ps(dest + i, _mm256_mul_ps(_mm256_loadu_ps(src + i), m_gains));
+                m_gains = _mm256_mul_ps(m_gains, m_step);
+            }
+
+            if (i == len)
+                return;
+            if (i % kRampSegment == 0)
+                ExpRampLanes(start, ratio, i, gains, &step);
+            else
+                _mm256_store_ps(gains, m_gains);
+            for (int j = 0; i + j < len; ++j)
+                dest[i + j] = src[i + j] * gains[j];
+        }
+
+        void FCROSSFADE_AVX2(const float src_out[], const float src_in[],
+                             float start_angle, float angle_increment, int len,
+                             float dest[]) {
+            alignas(32) float cosines[kRampLanes];
+            alignas(32) float sines[kRampLanes];
+            float cos_delta, sin_delta;
+            __m256 m_cos = _mm256_setzero_ps();
+            __m256 m_sin = m_cos, m_cos_delta = m_cos, m_sin_delta = m_cos;
+            int i = 0;
+            for (; i + kRampLanes <= len; i += kRampLanes) {
+                if (i % kRampSegment == 0) {
+                    CrossfadeLanes(start_angle, angle_increment, i, cosines, sines,
+                                   &cos_delta, &sin_delta);
+                    m_cos = _mm256_load_ps(cosines);
+                    m_sin = _mm256_load_ps(sines);
+                    m_cos_delta = _mm256_set1_ps(cos_delta);
+                    m_sin_delta = _mm256_set1_ps(sin_delta);
+                }
+                _mm256_storeu_ps(dest + i, _mm256_add_ps(
+                        _mm256_mul_ps(_mm256_loadu_ps(src_out + i), m_cos),
+                        _mm256_mul_ps(_mm256_loadu_ps(src_in + i), m_sin)));
+
+                const __m256 c = _mm256_add_ps(m_cos, _mm256_sub_ps(
+                        _mm256_mul_ps(m_cos, m_cos_delta), _mm256_mul_ps(m_sin, m_sin_delta)));
+                m_sin = _mm256_add_ps(m_sin, _mm256_add_ps(
+                        _mm256_mul_ps(m_sin, m_cos_delta), _mm256_mul_ps(m_cos, m_sin_delta)));
+                m_cos = c;
+            }
+
+            if (i == len)
+                return;
+            if (i % kRampSegment == 0) {
+                CrossfadeLanes(start_angle, angle_increment, i, cosines, sines,
+                               &cos_delta, &sin_delta);
+            } else {
+                _mm256_store_ps(cosines, m_cos);
+                _mm256_store_ps(sines, m_sin);
+            }
+            for (int j = 0; i + j < len; ++j)
+                dest[i + j] = src_out[i + j] * cosines[j] + src_in[i + j] * sines[j];
+        }
+
+        void FCLAMP_AVX2(const float src[], int len, float dest[]) {
+            const int leading = LeadingElementsAVX(dest, len);
+            FCLAMP_C(src, leading, dest);
+
+            // Like _mm_max_ps(), the second operand is returned for NaN.
+            const __m256 m_min = _mm256_set1_ps(-1.0f);
+            const __m256 m_max = _mm256_set1_ps(1.0f);
+            const int last_index = leading + ((len - leading) & ~7);
+            for (int i = leading; i < last_index; i += 8) {
+                const __m256 value = _mm256_max_ps(_mm256_loadu_ps(src + i), m_min);
+                _mm256_store_ps(dest + i, _mm256_min_ps(value, m_max));
+            }
+
+            FCLAMP_C(src + last_index, len - last_index, dest + last_index);
+        }
+
+        bool IsZero_AVX2(const float src[], int len) {
+            const int leading = LeadingElementsAVX(src, len);
+            if (!IsZero_C(src, leading))
+                return false;
+
+            const __m256 zero = _mm256_setzero_ps();
+            const int last_index = leading + ((len - leading) & ~31);
+            for (int i = leading; i < last_index; i += 32) {
+                __m256 m = _mm256_cmp_ps(_mm256_load_ps(src + i), zero, _CMP_NEQ_UQ);
+                m = _mm256_or_ps(
+                        m, _mm256_cmp_ps(_mm256_load_ps(src + i + 8), zero, _CMP_NEQ_UQ));
+                m = _mm256_or_ps(
+                        m, _mm256_cmp_ps(_mm256_load_ps(src + i + 16), zero, _CMP_NEQ_UQ));
+                m = _mm256_or_ps(
+                        m, _mm256_cmp_ps(_mm256_load_ps(src + i + 24), zero, _CMP_NEQ_UQ));
+                if (_mm256_movemask_ps(m))
+                    return false;
+            }
+
+            return IsZero_C(src + last_index, len - last_index);
+        }
+
+        static inline float HorizontalSum_AVX2(__m256 value) {
+            __m128 half = _mm_add_ps(_mm256_castps256_ps128(value),
+                                     _mm256_extractf128_ps(value, 1));
+            half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+            half = _mm_add_ss(half, _mm_shuffle_ps(half, half, 1));
+            return _mm_cvtss_f32(half);
+        }
+
+        static inline float HorizontalMax_AVX2(__m256 value) {
+            __m128 half = _mm_max_ps(_mm256_castps256_ps128(value),
+                                     _mm256_extractf128_ps(value, 1));
+            half = _mm_max_ps(half, _mm_movehl_ps(half, half));
+            half = _mm_max_ss(half, _mm_shuffle_ps(half, half, 1));
+            return _mm_cvtss_f32(half);
+        }
+
+        // See FSTATS_SSE() for how NaN and the clip count are handled.
+        Statistics FSTATS_AVX2(const float src[], int len, float clip_level) {
+            const int leading = LeadingElementsAVX(src, len);
+            Statistics stats = FSTATS_C(src, leading, clip_level);
+
+            const __m256 abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+            const __m256 m_clip_level = _mm256_set1_ps(clip_level);
+            __m256 peak = _mm256_setzero_ps();
+            __m256 sum = _mm256_setzero_ps();
+            __m256 sum_squares = _mm256_setzero_ps();
+            __m256i clipped = _mm256_setzero_si256();
+            const int last_index = leading + ((len - leading) & ~7);
+            for (int i = leading; i < last_index; i += 8) {
+                const __m256 value = _mm256_load_ps(src + i);
+                const __m256 magnitude = _mm256_and_ps(value, abs_mask);
+                peak = _mm256_max_ps(magnitude, peak);
+                clipped = _mm256_sub_epi32(clipped, _mm256_castps_si256(
+                        _mm256_cmp_ps(magnitude, m_clip_level, _CMP_GE_OQ)));
+                sum = _mm256_add_ps(sum, value);
+                sum_squares = _mm256_add_ps(sum_squares, _mm256_mul_ps(value, value));
+            }
+
+            alignas(32) int32_t counts[8];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(counts), clipped);
+            for (int count : counts)
+                stats.clipped += count;
+            const Statistics tail =
+                    FSTATS_C(src + last_index, len - last_index, clip_level);
+            stats.peak = std::max({stats.peak, HorizontalMax_AVX2(peak), tail.peak});
+            stats.sum += HorizontalSum_AVX2(sum) + tail.sum;
+            stats.sum_squares += HorizontalSum_AVX2(sum_squares) + tail.sum_squares;
+            stats.clipped += tail.clipped;
+            return stats;
+        }
+    }
+}
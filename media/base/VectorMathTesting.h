@@ -0,0 +1,108 @@
+//
+// Created by wang rl on 2022/7/4.
+//
+
+#ifndef MULTIMEDIA_VECTOR_MATH_TESTING_H
+#define MULTIMEDIA_VECTOR_MATH_TESTING_H
+
+#include "base/utils/BuildConfig.h"
+#include "media/base/VectorMath.h"
+
+namespace mm {
+    namespace vector_math {
+        // Optimized versions exposed for testing. See VectorMath.h for details.
+        void FMUL_C(const float src[], float scale, int len, float dest[]);
+
+        void FMAC_C(const float src[], float scale, int len, float dest[]);
+
+        void FMIX_C(const float* const src[], const float scale[], int count,
+                    int len, float dest[], bool clip);
+
+        // Scalar FMIX() of elements [offset, offset + len) of every input into
+        // the same elements of |dest|. Used by the SIMD versions for the leading
+        // and trailing elements.
+        void FMIXRange_C(const float* const src[], const float scale[], int count,
+                         int offset, int len, float dest[], bool clip);
+
+        // The kRampLanes gains of FEXPRAMP() starting at element |offset| and
+        // the factor advancing them by kRampLanes elements. Shared so all
+        // versions start every kRampSegment identically.
+        void ExpRampLanes(float start, float ratio, int offset, float gains[],
+                          float* step);
+
+        // The kRampLanes cosines and sines of FCROSSFADE() starting at element
+        // |offset| and the rotation advancing them by kRampLanes elements, given
+        // as cos(step) - 1 and sin(step).
+        void CrossfadeLanes(float start_angle, float angle_increment, int offset,
+                            float cosines[], float sines[],
+                            float* cos_delta, float* sin_delta);
+
+        void FRAMP_C(const float src[], float start, float increment, int len,
+                     float dest[]);
+
+        void FEXPRAMP_C(const float src[], float start, float ratio, int len,
+                        float dest[]);
+
+        void FCROSSFADE_C(const float src_out[], const float src_in[],
+                          float start_angle, float angle_increment, int len,
+                          float dest[]);
+
+        void FCLAMP_C(const float src[], int len, float dest[]);
+
+        bool IsZero_C(const float src[], int len);
+
+        Statistics FSTATS_C(const float src[], int len, float clip_level);
+
+#if defined(ARCH_CPU_X86_FAMILY)
+        void FMUL_SSE(const float src[], float scale, int len, float dest[]);
+
+        void FMAC_SSE(const float src[], float scale, int len, float dest[]);
+
+        void FMIX_SSE(const float* const src[], const float scale[], int count,
+                      int len, float dest[], bool clip);
+
+        void FRAMP_SSE(const float src[], float start, float increment, int len,
+                       float dest[]);
+
+        void FEXPRAMP_SSE(const float src[], float start, float ratio, int len,
+                          float dest[]);
+
+        void FCROSSFADE_SSE(const float src_out[], const float src_in[],
+                            float start_angle, float angle_increment, int len,
+                            float dest[]);
+
+        void FCLAMP_SSE(const float src[], int len, float dest[]);
+
+        bool IsZero_SSE(const float src[], int len);
+
+        Statistics FSTATS_SSE(const float src[], int len, float clip_level);
+#endif
+
+#if defined(MM_ENABLE_AVX2)
+        void FMUL_AVX2(const float src[], float scale, int len, float dest[]);
+
+        void FMAC_AVX2(const float src[], float scale, int len, float dest[]);
+
+        void FMIX_AVX2(const float* const src[], const float scale[], int count,
+                       int len, float dest[], bool clip);
+
+        void FRAMP_AVX2(const float src[], float start, float increment, int len,
+                        float dest[]);
+
+        void FEXPRAMP_AVX2(const float src[], float start, float ratio, int len,
+                           float dest[]);
+
+        void FCROSSFADE_AVX2(const float src_out[], const float src_in[],
+                             float start_angle, float angle_increment, int len,
+                             float dest[]);
+
+        void FCLAMP_AVX2(const float src[], int len, float dest[]);
+
+        bool IsZero_AVX2(const float src[], int len);
+
+        Statistics FSTATS_AVX2(const float src[], int len, float clip_level);
+#endif
+    }
+}
+
+#endif //MULTIMEDIA_VECTOR_MATH_TESTING_H
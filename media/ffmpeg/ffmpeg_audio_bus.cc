@@ -0,0 +1,57 @@
+//
+// Created by wang rl on 2022/7/10.
+//
+
+#include <glog/logging.h>
+#include "media/ffmpeg/ffmpeg_audio_bus.h"
+
+namespace mm {
+    std::unique_ptr<FFmpegAudioBus> FFmpegAudioBus::Wrap(const AVFrame* frame,
+                                                         int frames) {
+        DCHECK(frame);
+        if (frame->format != AV_SAMPLE_FMT_FLTP || !frame->buf[0] ||
+            frames <= 0 || frames > frame->nb_samples || frame->channels <= 0) {
+            return nullptr;
+        }
+
+        std::vector<float*> channel_data(frame->channels);
+        for (int ch = 0; ch < frame->channels; ++ch) {
+            channel_data[ch] = reinterpret_cast<float*>(frame->extended_data[ch]);
+            if (!IsAligned(channel_data[ch], AudioBus::kSSEAlignment))
+                return nullptr;
+        }
+
+        // av_frame_clone() only takes new references to the frame's buffers, the
+        // samples stay where the decoder put them.
+        std::unique_ptr<AVFrame, ScopedPtrAVFreeFrame> reference(
+                av_frame_clone(frame));
+        if (!reference)
+            return nullptr;
+        DCHECK_EQ(reference->extended_data[0], frame->extended_data[0]);
+
+        return std::unique_ptr<FFmpegAudioBus>(
+                new FFmpegAudioBus(std::move(reference), frames, channel_data));
+    }
+
+    FFmpegAudioBus::FFmpegAudioBus(
+            std::unique_ptr<AVFrame, ScopedPtrAVFreeFrame> frame,
+            int frames,
+            const std::vector<float*>& channel_data)
+            : AudioBus(frames, channel_data, AudioBus::kSSEAlignment),
+              frame_(std::move(frame)) {
+        // More than AV_NUM_DATA_POINTERS planes spill into |extended_buf|.
+        size_t size = 0;
+        for (const AVBufferRef* buf : frame_->buf) {
+            if (buf)
+                size += size_t(buf->size);
+        }
+        for (int i = 0; i < frame_->nb_extended_buf; ++i)
+            size += size_t(frame_->extended_buf[i]->size);
+        setMemorySize(size);
+        internal::RecordAllocation(MemoryTag::kDecoder, size);
+    }
+
+    FFmpegAudioBus::~FFmpegAudioBus() {
+        internal::RecordFree(MemoryTag::kDecoder, memorySize());
+    }
+}
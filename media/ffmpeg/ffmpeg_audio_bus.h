@@ -0,0 +1,49 @@
+//
+// Created by wang rl on 2022/7/10.
+//
+
+#ifndef MULTIMEDIA_FFMPEG_AUDIO_BUS_H
+#define MULTIMEDIA_FFMPEG_AUDIO_BUS_H
+
+#include <memory>
+
+#include "media/base/AudioBus.h"
+#include "media/ffmpeg/ffmpeg_common.h"
+
+namespace mm {
+    // An AudioBus whose channels point straight into the planes of a decoded
+    // AV_SAMPLE_FMT_FLTP AVFrame, so planar float decoders (AAC, MP3 float,
+    // Vorbis, Opus) reach the consumer without a copy. The bus holds its own
+    // reference to the frame's AVBufferRefs for its whole lifetime; the decoder
+    // may unref or reuse the original AVFrame right away.
+    //
+    // The samples are shared with the frame, and nothing checks who else holds
+    // a reference to its buffers. Callers must not write into a wrapped bus
+    // unless they know the buffers are unshared, e.g. because the decoder has
+    // already unref'd its frame as AudioFileReader does.
+    //
+    // The referenced frame buffers are counted under MemoryTag::kDecoder and
+    // reported by memorySize() for as long as the bus lives, even while the
+    // decoder still shares them.
+    class FFmpegAudioBus : public AudioBus {
+    public:
+        // Wraps the first |frames| samples of every channel of |frame|. Returns
+        // nullptr if |frame| is not AV_SAMPLE_FMT_FLTP, is not reference
+        // counted, has fewer than |frames| samples or has planes which are not
+        // aligned by AudioBus::kSSEAlignment; callers then copy the samples.
+        static std::unique_ptr<FFmpegAudioBus> Wrap(const AVFrame* frame,
+                                                    int frames);
+
+        ~FFmpegAudioBus() override;
+
+    private:
+        FFmpegAudioBus(std::unique_ptr<AVFrame, ScopedPtrAVFreeFrame> frame,
+                       int frames,
+                       const std::vector<float*>& channel_data);
+
+        // New reference to the wrapped frame, keeping its buffers alive.
+        std::unique_ptr<AVFrame, ScopedPtrAVFreeFrame> frame_;
+    };
+}
+
+#endif //MULTIMEDIA_FFMPEG_AUDIO_BUS_H
@@ -0,0 +1,60 @@
+//
+// Created by wang rl on 2022/7/14.
+//
+
+#include <array>
+
+#include "media/base/AudioSampleTypes.h"
+#include "media/ffmpeg/ffmpeg_sample_conversion.h"
+
+namespace mm {
+    using SignedInt64SampleTypeTraits = FixedSampleTypeTraits<int64_t>;
+
+    template<class SampleTypeTraits>
+    static void ConvertInterleaved(const uint8_t* const* data, int frames,
+                                   AudioBus* dest) {
+        using ValueType = typename SampleTypeTraits::ValueType;
+        dest->fromInterleavedPartial<SampleTypeTraits>(
+                reinterpret_cast<const ValueType*>(data[0]), 0, frames);
+    }
+
+    template<class SampleTypeTraits>
+    static void ConvertPlanar(const uint8_t* const* data, int frames,
+                              AudioBus* dest) {
+        using ValueType = typename SampleTypeTraits::ValueType;
+        DCHECK_LE(frames, dest->frames());
+        for (int ch = 0; ch < dest->channels(); ++ch) {
+            SampleTypeTraits::ToFloatArray(
+                    reinterpret_cast<const ValueType*>(data[ch]), frames,
+                    dest->channel(ch));
+        }
+    }
+
+    using ConverterTable =
+            std::array<ConvertToAudioBusFunction, AV_SAMPLE_FMT_NB>;
+
+    static constexpr ConverterTable MakeConverterTable() {
+        ConverterTable table = {};
+        table[AV_SAMPLE_FMT_U8] = ConvertInterleaved<UnsignedInt8SampleTypeTraits>;
+        table[AV_SAMPLE_FMT_S16] = ConvertInterleaved<SignedInt16SampleTypeTraits>;
+        table[AV_SAMPLE_FMT_S32] = ConvertInterleaved<SignedInt32SampleTypeTraits>;
+        table[AV_SAMPLE_FMT_S64] = ConvertInterleaved<SignedInt64SampleTypeTraits>;
+        table[AV_SAMPLE_FMT_FLT] = ConvertInterleaved<Float32SampleTypeTraits>;
+        table[AV_SAMPLE_FMT_DBL] = ConvertInterleaved<Float64SampleTypeTraits>;
+        table[AV_SAMPLE_FMT_U8P] = ConvertPlanar<UnsignedInt8SampleTypeTraits>;
+        table[AV_SAMPLE_FMT_S16P] = ConvertPlanar<SignedInt16SampleTypeTraits>;
+        table[AV_SAMPLE_FMT_S32P] = ConvertPlanar<SignedInt32SampleTypeTraits>;
+        table[AV_SAMPLE_FMT_S64P] = ConvertPlanar<SignedInt64SampleTypeTraits>;
+        table[AV_SAMPLE_FMT_FLTP] = ConvertPlanar<Float32SampleTypeTraits>;
+        table[AV_SAMPLE_FMT_DBLP] = ConvertPlanar<Float64SampleTypeTraits>;
+        return table;
+    }
+
+    static constexpr ConverterTable kConverters = MakeConverterTable();
+
+    ConvertToAudioBusFunction GetConvertToAudioBusFunction(AVSampleFormat format) {
+        if (format < 0 || format >= AV_SAMPLE_FMT_NB)
+            return nullptr;
+        return kConverters[format];
+    }
+}
@@ -0,0 +1,29 @@
+//
+// Created by wang rl on 2022/7/14.
+//
+
+#ifndef MULTIMEDIA_FFMPEG_SAMPLE_CONVERSION_H
+#define MULTIMEDIA_FFMPEG_SAMPLE_CONVERSION_H
+
+#include <cstdint>
+
+#include "media/base/AudioBus.h"
+#include "media/ffmpeg/ffmpeg_common.h"
+
+namespace mm {
+    // Converts the first |frames| frames of decoded samples to float and writes
+    // them to the first |frames| frames of |dest|. |data| holds one pointer per
+    // channel for planar formats and a single pointer for interleaved ones,
+    // i.e. AVFrame::extended_data. |dest| determines the channel count.
+    using ConvertToAudioBusFunction = void (*)(const uint8_t* const* data,
+                                               int frames,
+                                               AudioBus* dest);
+
+    // Returns the conversion for |format|, or nullptr if the format is not
+    // supported. Every planar and interleaved u8, s16, s32, s64, float and
+    // double format is supported; each is converted in a single pass with the
+    // SampleTypeTraits of AudioSampleTypes.h.
+    ConvertToAudioBusFunction GetConvertToAudioBusFunction(AVSampleFormat format);
+}
+
+#endif //MULTIMEDIA_FFMPEG_SAMPLE_CONVERSION_H
@@ -3,8 +3,9 @@
 //
 
 #include "base/time/Time.h"
-#include "media/base/AudioSampleTypes.h"
+#include "media/ffmpeg/ffmpeg_audio_bus.h"
 #include "media/ffmpeg/ffmpeg_common.h"
+#include "media/ffmpeg/ffmpeg_sample_conversion.h"
 #include "media/filters/audio_file_reader.h"
 
 namespace mm {
@@ -18,7 +19,8 @@ namespace mm {
               audio_codec_(AV_CODEC_ID_FIRST_UNKNOWN),
               channels_(0),
               sample_rate_(0),
-              av_sample_format_(0) {}
+              av_sample_format_(0),
+              convert_to_audio_bus_(nullptr) {}
 
     AudioFileReader::~AudioFileReader() {
         Close();
@@ -36,6 +38,39 @@ namespace mm {
     int AudioFileReader::Read(
             std::vector<std::unique_ptr<AudioBus>>* decoded_audio_packets,
             int packets_to_read) {
+        return ReadInternal(
+                packets_to_read,
+                [decoded_audio_packets](int channels, int frames) {
+                    decoded_audio_packets->emplace_back(AudioBus::Create(
+                            channels, frames, AudioBus::kChannelAlignment,
+                            MemoryTag::kDecoder));
+                    return decoded_audio_packets->back().get();
+                },
+                [decoded_audio_packets](std::unique_ptr<AudioBus> bus) {
+                    decoded_audio_packets->push_back(std::move(bus));
+                });
+    }
+
+    int AudioFileReader::Read(
+            std::vector<AudioBusPool::ScopedAudioBus>* decoded_audio_packets,
+            AudioBusPool* pool,
+            int packets_to_read) {
+        DCHECK(pool);
+        return ReadInternal(
+                packets_to_read,
+                [decoded_audio_packets, pool](int channels, int frames) {
+                    decoded_audio_packets->emplace_back(pool->Create(channels, frames));
+                    return decoded_audio_packets->back().get();
+                },
+                [decoded_audio_packets](std::unique_ptr<AudioBus> bus) {
+                    // A default Recycler deletes the bus instead of pooling it.
+                    decoded_audio_packets->emplace_back(bus.release());
+                });
+    }
+
+    int AudioFileReader::ReadInternal(int packets_to_read,
+                                      const CreateAudioBusCB& create_audio_bus,
+                                      const AdoptAudioBusCB& adopt_audio_bus) {
         DCHECK(glue_ && codec_context_)
                             << "AudioFileReader::Read() : reader is not opened!";
         int total_frames = 0;
@@ -77,8 +112,8 @@ namespace mm {
                     continue;
                 }
 
-                const bool frame_processing_success =
-                        OnNewFrame(&total_frames, decoded_audio_packets, frame.get());
+                const bool frame_processing_success = OnNewFrame(
+                        &total_frames, create_audio_bus, adopt_audio_bus, frame.get());
                 av_frame_unref(frame.get());
                 if (!frame_processing_success) {
                     status = DecodeStatus::kFrameProcessingFailed;
@@ -194,10 +229,6 @@ namespace mm {
     bool AudioFileReader::OpenDecoder() {
         const AVCodec* codec = avcodec_find_decoder(codec_context_->codec_id);
         if (codec) {
-            // MP3 decodes to S16P which we don't support, tell it to use S16 instead.
-            if (codec_context_->sample_fmt == AV_SAMPLE_FMT_S16P)
-                codec_context_->request_sample_fmt = AV_SAMPLE_FMT_S16;
-
             const int result = avcodec_open2(codec_context_.get(), codec, nullptr);
             if (result < 0) {
                 DLOG(WARNING) << "AudioFileReader::Open() : could not open codec -"
@@ -205,10 +236,12 @@ namespace mm {
                 return false;
             }
 
-            // Ensure avcodec_open2() respected our format request.
-            if (codec_context_->sample_fmt == AV_SAMPLE_FMT_S16P) {
-                DLOG(ERROR) << "AudioFileReader::Open() : unable to configure a"
-                            << " supported sample format - "
+            // Every planar and interleaved PCM layout is converted directly, so
+            // the decoder's native format is used as is.
+            convert_to_audio_bus_ =
+                    GetConvertToAudioBusFunction(codec_context_->sample_fmt);
+            if (!convert_to_audio_bus_) {
+                DLOG(ERROR) << "AudioFileReader::Open() : unsupported sample format - "
                             << codec_context_->sample_fmt;
                 return false;
             }
@@ -238,7 +271,8 @@ namespace mm {
 
     bool AudioFileReader::OnNewFrame(
             int* total_frames,
-            std::vector<std::unique_ptr<AudioBus>>* decoded_audio_packets,
+            const CreateAudioBusCB& create_audio_bus,
+            const AdoptAudioBusCB& adopt_audio_bus,
             AVFrame* frame) {
         int frames_read = frame->nb_samples;
         if (frames_read < 0)
@@ -283,42 +317,24 @@ namespace mm {
             }
         }
 
-        // De-interleave each channel and convert to 32bit floating-point with
-        // nominal range -1.0 -> +1.0.  If the output is already in float planar
-        // format, just copy it into the AudioBus.
-        decoded_audio_packets->emplace_back(AudioBus::Create(channels, frames_read));
-        AudioBus* audio_bus = decoded_audio_packets->back().get();
-
-        if (codec_context_->sample_fmt == AV_SAMPLE_FMT_FLT) {
-            audio_bus->fromInterleaved<Float32SampleTypeTraits>(
-                    reinterpret_cast<float*>(frame->data[0]), frames_read);
-        } else if (codec_context_->sample_fmt == AV_SAMPLE_FMT_FLTP) {
-            for (int ch = 0; ch < audio_bus->channels(); ++ch) {
-                memcpy(audio_bus->channel(ch), frame->extended_data[ch],
-                       sizeof(float) * frames_read);
-            }
-        } else {
-            int bytes_per_sample = av_get_bytes_per_sample(codec_context_->sample_fmt);
-            switch (bytes_per_sample) {
-                case 1:
-                    audio_bus->fromInterleaved<UnsignedInt8SampleTypeTraits>(
-                            reinterpret_cast<const uint8_t*>(frame->data[0]), frames_read);
-                    break;
-                case 2:
-                    audio_bus->fromInterleaved<SignedInt16SampleTypeTraits>(
-                            reinterpret_cast<const int16_t*>(frame->data[0]), frames_read);
-                    break;
-                case 4:
-                    audio_bus->fromInterleaved<SignedInt32SampleTypeTraits>(
-                            reinterpret_cast<const int32_t*>(frame->data[0]), frames_read);
-                    break;
-                default:
-                    DCHECK(false) << "Unsupported bytes per sample encountered: "
-                                  << bytes_per_sample;
-                    audio_bus->zeroFrames(frames_read);
+        // If the output is already in float planar format, hand out the decoded
+        // planes themselves.
+        if (codec_context_->sample_fmt == AV_SAMPLE_FMT_FLTP) {
+            std::unique_ptr<AudioBus> wrapped = FFmpegAudioBus::Wrap(frame, frames_read);
+            if (wrapped) {
+                adopt_audio_bus(std::move(wrapped));
+                (*total_frames) += frames_read;
+                return true;
             }
         }
 
+        // De-interleave each channel and convert to 32bit floating-point with
+        // nominal range -1.0 -> +1.0, in one pass with the conversion picked for
+        // the decoder's sample format.  If the output is float planar but could
+        // not be wrapped, this just copies it into the AudioBus.
+        AudioBus* audio_bus = create_audio_bus(channels, frames_read);
+        convert_to_audio_bus_(frame->extended_data, frames_read, audio_bus);
+
         (*total_frames) += frames_read;
         return true;
     }
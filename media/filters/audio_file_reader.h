@@ -5,7 +5,10 @@
 #ifndef MULTIMEDIA_AUDIO_FILE_READER_H
 #define MULTIMEDIA_AUDIO_FILE_READER_H
 
+#include <functional>
 #include "media/base/AudioBus.h"
+#include "media/base/AudioBusPool.h"
+#include "media/ffmpeg/ffmpeg_sample_conversion.h"
 #include "media/filters/ffmpeg_glue.h"
 
 namespace mm {
@@ -53,6 +56,8 @@ namespace mm {
         // The caller must convert these packets into one complete set of
         // decoded audio data.  The audio data will be decoded as
         // floating-point linear PCM with a nominal range of -1.0 -> +1.0.
+        // Packets of planar float decoders wrap the decoded AVFrame instead of
+        // holding a copy, see FFmpegAudioBus.
         // Returns the number of sample-frames actually read which will
         // always be the total size of all the frames in
         // |decodedAudioPackets|.
@@ -61,6 +66,14 @@ namespace mm {
         int Read(std::vector<std::unique_ptr<AudioBus>>* decoded_audio_packets,
                  int packets_to_read = (std::numeric_limits<int>::max)());
 
+        // Same as above, but the decoded packets are drawn from |pool|. Callers
+        // that process the packets in chunks and release them before the next
+        // Read() avoid an allocation per decoded frame this way. Wrapped planar
+        // float frames don't come from the pool and are freed on release.
+        int Read(std::vector<AudioBusPool::ScopedAudioBus>* decoded_audio_packets,
+                 AudioBusPool* pool,
+                 int packets_to_read = (std::numeric_limits<int>::max)());
+
         // These methods can be called once Open() has been called.
         int channels() const { return channels_; }
 
@@ -106,8 +119,21 @@ namespace mm {
 
         bool ReadPacket(AVPacket* output_packet);
 
+        // Returns a new AudioBus for a decoded frame, which is owned by the list of
+        // decoded packets the caller passed to Read().
+        using CreateAudioBusCB = std::function<AudioBus*(int channels, int frames)>;
+
+        // Appends an AudioBus which already holds a decoded frame, i.e. one
+        // wrapping the frame's planes, to the list of decoded packets.
+        using AdoptAudioBusCB = std::function<void(std::unique_ptr<AudioBus> bus)>;
+
+        int ReadInternal(int packets_to_read,
+                         const CreateAudioBusCB& create_audio_bus,
+                         const AdoptAudioBusCB& adopt_audio_bus);
+
         bool OnNewFrame(int* total_frames,
-                        std::vector<std::unique_ptr<AudioBus>>* decoded_audio_packets,
+                        const CreateAudioBusCB& create_audio_bus,
+                        const AdoptAudioBusCB& adopt_audio_bus,
                         AVFrame* frame);
 
         // Destruct |glue_| after |codec_context_|.
@@ -124,6 +150,9 @@ namespace mm {
 
         // AVSampleFormat initially requested;
         int av_sample_format_;
+
+        // Converts frames of |av_sample_format_| into an AudioBus.
+        ConvertToAudioBusFunction convert_to_audio_bus_;
     };
 }
 
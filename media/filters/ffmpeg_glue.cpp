@@ -11,14 +11,6 @@ extern "C" {
 #include "media/filters/ffmpeg_glue.h"
 
 namespace mm {
-    // Internal buffer size used by AVIO for reading.
-    // TODO: Experiment with this buffer size and measure impact on
-    // performance.  Currently we want to use 32kb to preserve existing behavior
-    // with the previous URLProtocol based approach.
-    enum {
-        kBufferSize = 32 * 1024
-    };
-
     static int AVIOReadOperation(void* opaque, uint8_t* buf, int buf_size) {
         return reinterpret_cast<FFmpegURLProtocol*>(opaque)->Read(buf_size, buf);
     }
@@ -58,13 +50,18 @@ namespace mm {
         return new_offset;
     }
 
-    FFmpegGlue::FFmpegGlue(FFmpegURLProtocol* protocol) {
+    FFmpegGlue::FFmpegGlue(FFmpegURLProtocol* protocol, int buffer_size) {
+        // See ffmpeg_glue_perftest.cc for the demux throughput of different sizes.
+        if (buffer_size <= 0)
+            buffer_size = protocol->PreferredBufferSize();
+        buffer_size_ = buffer_size > 0 ? buffer_size : kDefaultBufferSize;
+
         // Initialize an AVIOContext using our custom read and seek operations.  Don't
         // keep pointers to the buffer since FFmpeg may reallocate it on the fly.  It
         // will be cleaned up
         format_context_ = avformat_alloc_context();
         avio_context_.reset(avio_alloc_context(
-                static_cast<unsigned char*>(av_malloc(kBufferSize)), kBufferSize, 0,
+                static_cast<unsigned char*>(av_malloc(buffer_size_)), buffer_size_, 0,
                 protocol, &AVIOReadOperation, nullptr, &AVIOSeekOperation));
 
         // Ensure FFmpeg only tries to seek on resources we know to be seekable.
@@ -73,6 +70,10 @@ namespace mm {
         // Ensure writing is disabled.
         avio_context_->write_flag = 0;
 
+        // Reads bypass the buffer and short forward seeks call the seek operation
+        // instead of reading and discarding the data in between.
+        avio_context_->direct = protocol->PrefersDirectReads() ? 1 : 0;
+
         // Tell the format context about our custom IO context.  avformat_open_input()
         // will set the AVFMT_FLAG_CUSTOM_IO flag for us, but do so here to ensure an
         // early error state doesn't cause FFmpeg to free our resources in error.
@@ -90,6 +91,7 @@ namespace mm {
 
     bool FFmpegGlue::OpenContext(bool is_local_file) {
         DCHECK(!open_called_) << "OpenContext() shouldn't be called twice.";
+        open_called_ = true;
 
         // By passing nullptr for the filename (second parameter) we are telling
         // FFmpeg to use the AVIO context we set up from the AVFormatContext structure.
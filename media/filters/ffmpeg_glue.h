@@ -46,12 +46,29 @@ namespace mm {
         // Returns true and the file size, false if the file size could not be
         // retrieved.
         virtual bool GetSize(int64_t* size_out) = 0;
+
+        // Returns the AVIO buffer size which suits this protocol, e.g. larger
+        // when reads are cheap and smaller for low latency streaming, or 0 to
+        // use FFmpegGlue::kDefaultBufferSize.
+        virtual int PreferredBufferSize() const { return 0; }
+
+        // Returns true if AVIO should read straight into the destination, e.g.
+        // packet data, rather than stage every read in its buffer. Suits
+        // protocols whose reads are cheap, like a memcpy from resident memory,
+        // which then copy each byte once instead of twice.
+        virtual bool PrefersDirectReads() const { return false; }
     };
 
     class FFmpegGlue {
     public:
+        // Internal buffer size used by AVIO for reading, unless the protocol or
+        // the caller asks for another one.
+        static constexpr int kDefaultBufferSize = 32 * 1024;
+
         // See file documentation for usage.  |protocol| must outlive FFmpegGlue.
-        explicit FFmpegGlue(FFmpegURLProtocol* protocol);
+        // The AVIO buffer holds |buffer_size| bytes; if 0, the size preferred by
+        // |protocol| or kDefaultBufferSize.
+        explicit FFmpegGlue(FFmpegURLProtocol* protocol, int buffer_size = 0);
 
         FFmpegGlue(const FFmpegGlue&) = delete;
 
@@ -66,8 +83,11 @@ namespace mm {
 
         AVFormatContext* format_context() { return format_context_; }
 
+        int buffer_size() const { return buffer_size_; }
+
     private:
         bool open_called_ = false;
+        int buffer_size_ = 0;
         AVFormatContext* format_context_ = nullptr;
         std::unique_ptr<AVIOContext, ScopedPtrAVFree> avio_context_;
     };
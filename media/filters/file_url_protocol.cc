@@ -0,0 +1,139 @@
+//
+// Created by WangRuiLing on 2022/7/19.
+//
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <glog/logging.h>
+#include "media/filters/file_url_protocol.h"
+
+namespace mm {
+    std::unique_ptr<FileUrlProtocol> FileUrlProtocol::Open(const std::string& path,
+                                                           int read_ahead) {
+        const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            DLOG(ERROR) << "Couldn't open " << path << ": " << strerror(errno);
+            return nullptr;
+        }
+        auto protocol = std::make_unique<FileUrlProtocol>(fd, read_ahead);
+        protocol->owns_fd_ = true;
+        return protocol;
+    }
+
+    FileUrlProtocol::FileUrlProtocol(int fd, int read_ahead)
+            : fd_(fd), read_ahead_(std::max(read_ahead, 0)) {
+        DCHECK_GE(fd, 0);
+        struct stat info{};
+        if (fstat(fd_, &info) == 0)
+            size_ = info.st_size;
+        if (read_ahead_ > 0)
+            window_.reset(new uint8_t[read_ahead_]);
+#if defined(POSIX_FADV_SEQUENTIAL)
+        // Demuxing reads mostly front to back; this doubles the kernel's
+        // read-ahead on Linux. Only a hint, failures don't matter.
+        posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    }
+
+    FileUrlProtocol::~FileUrlProtocol() {
+        if (owns_fd_)
+            close(fd_);
+    }
+
+    int64_t FileUrlProtocol::PRead(int64_t offset, int64_t size, uint8_t* data) const {
+        int64_t total = 0;
+        while (total < size) {
+            const ssize_t result = pread(fd_, data + total, size_t(size - total),
+                                         off_t(offset + total));
+            if (result < 0) {
+                if (errno == EINTR)
+                    continue;
+                DLOG(ERROR) << "pread() failed: " << strerror(errno);
+                return -1;
+            }
+            if (result == 0)
+                break;
+            total += result;
+        }
+        return total;
+    }
+
+    bool FileUrlProtocol::FillWindow() {
+        const int64_t bytes = PRead(position_, read_ahead_, window_.get());
+        if (bytes < 0)
+            return false;
+        window_offset_ = position_;
+        window_size_ = bytes;
+#if defined(POSIX_FADV_WILLNEED)
+        // Start reading the next window in the background while this one is
+        // consumed.
+        if (bytes == read_ahead_)
+            posix_fadvise(fd_, off_t(position_ + bytes), read_ahead_, POSIX_FADV_WILLNEED);
+#endif
+        return true;
+    }
+
+    int FileUrlProtocol::Read(int size, uint8_t* data) {
+        // Not sure if this can happen, but it's unclear from the ffmpeg code, so guard
+        // against it.
+        if (size < 0)
+            return AVERROR(EIO);
+        if (!size)
+            return 0;
+
+        int copied = 0;
+        // Serve what the window holds of the request.
+        if (position_ >= window_offset_ && position_ < window_offset_ + window_size_) {
+            copied = int(std::min<int64_t>(size, window_offset_ + window_size_ - position_));
+            memcpy(data, window_.get() + (position_ - window_offset_), copied);
+            position_ += copied;
+            if (copied == size)
+                return copied;
+        }
+
+        const int remaining = size - copied;
+        int64_t bytes;
+        if (remaining >= read_ahead_) {
+            // Large reads gain nothing from the window, read them directly.
+            bytes = PRead(position_, remaining, data + copied);
+        } else {
+            if (!FillWindow())
+                return copied > 0 ? copied : AVERROR(EIO);
+            bytes = std::min<int64_t>(remaining, window_size_);
+            memcpy(data + copied, window_.get(), size_t(bytes));
+        }
+        if (bytes < 0)
+            return copied > 0 ? copied : AVERROR(EIO);
+        position_ += bytes;
+        copied += int(bytes);
+        return copied > 0 ? copied : AVERROR_EOF;
+    }
+
+    bool FileUrlProtocol::GetPosition(int64_t* position_out) {
+        if (!position_out)
+            return false;
+
+        *position_out = position_;
+        return true;
+    }
+
+    bool FileUrlProtocol::SetPosition(int64_t position) {
+        if (position < 0 || (size_ >= 0 && position > size_))
+            return false;
+        // The window is kept, seeking back into it is common while probing.
+        position_ = position;
+        return true;
+    }
+
+    bool FileUrlProtocol::GetSize(int64_t* size_out) {
+        if (!size_out || size_ < 0)
+            return false;
+
+        *size_out = size_;
+        return true;
+    }
+} // mm
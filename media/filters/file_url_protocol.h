@@ -0,0 +1,80 @@
+//
+// Created by WangRuiLing on 2022/7/19.
+//
+
+#ifndef MULTIMEDIA_FILE_URL_PROTOCOL_H
+#define MULTIMEDIA_FILE_URL_PROTOCOL_H
+
+#include <memory>
+#include <string>
+#include "media/filters/ffmpeg_glue.h"
+
+namespace mm {
+    // FFmpegURLProtocol that reads a file with pread(), for files too large to
+    // map or on network filesystems where page faults on a mapping are
+    // expensive. Reads go through a read-ahead window: small reads, as AVIO
+    // issues them, are served from a buffer refilled |read_ahead| bytes at a
+    // time, and the kernel is asked to prefetch the window after it.
+    //
+    // Every protocol keeps its own position and pread() doesn't move the file
+    // offset, so several protocols can read the same fd concurrently, one per
+    // thread.
+    // NOTE: A protocol constructed from an fd doesn't own it, the fd needs to
+    //       remain open for the entire lifetime of this object.
+    class FileUrlProtocol : public FFmpegURLProtocol {
+    public:
+        // Default size of the read-ahead window, 256 KB.
+        static constexpr int kDefaultReadAhead = 256 * 1024;
+
+        // Opens the file at |path| and returns a protocol owning the fd, or
+        // nullptr if the file can't be opened.
+        static std::unique_ptr<FileUrlProtocol> Open(const std::string& path,
+                                                     int read_ahead = kDefaultReadAhead);
+
+        // Reads from |fd|, which must be open for reading. A |read_ahead| of 0
+        // passes every read through to pread().
+        FileUrlProtocol(int fd, int read_ahead = kDefaultReadAhead);
+
+        FileUrlProtocol(const FileUrlProtocol&) = delete;
+
+        FileUrlProtocol& operator=(const FileUrlProtocol&) = delete;
+
+        virtual ~FileUrlProtocol();
+
+        // FFmpegURLProtocol methods.
+        int Read(int size, uint8_t* data) override;
+
+        bool GetPosition(int64_t* position_out) override;
+
+        bool SetPosition(int64_t position) override;
+
+        bool GetSize(int64_t* size_out) override;
+
+        int fd() const { return fd_; }
+
+        int read_ahead() const { return read_ahead_; }
+
+    private:
+        // Reads up to |size| bytes at |offset|, retrying interrupted and short
+        // reads. Returns the bytes read, less than |size| only at the end of the
+        // file, or -1 on error.
+        int64_t PRead(int64_t offset, int64_t size, uint8_t* data) const;
+
+        // Refills the window from |position_|. Returns false on error.
+        bool FillWindow();
+
+        const int fd_;
+        bool owns_fd_ = false;
+        const int read_ahead_;
+        int64_t size_ = -1;
+        int64_t position_ = 0;
+
+        // Bytes [window_offset_, window_offset_ + window_size_) of the file.
+        std::unique_ptr<uint8_t[]> window_;
+        int64_t window_offset_ = 0;
+        int64_t window_size_ = 0;
+    };
+
+} // mm
+
+#endif //MULTIMEDIA_FILE_URL_PROTOCOL_H
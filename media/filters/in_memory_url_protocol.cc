@@ -7,11 +7,13 @@
 namespace mm {
     InMemoryUrlProtocol::InMemoryUrlProtocol(const uint8_t* data,
                                              int64_t size,
-                                             bool streaming)
+                                             bool streaming,
+                                             bool direct)
             : data_(data),
               size_(size >= 0 ? size : 0),
               position_(0),
-              streaming_(streaming) {}
+              streaming_(streaming),
+              direct_(direct) {}
 
     InMemoryUrlProtocol::~InMemoryUrlProtocol() = default;
 
@@ -60,4 +62,14 @@ namespace mm {
         *size_out = size_;
         return true;
     }
+
+    int InMemoryUrlProtocol::PreferredBufferSize() const {
+        if (direct_)
+            return kDirectBufferSize;
+        return streaming_ ? kStreamingBufferSize : 0;
+    }
+
+    bool InMemoryUrlProtocol::PrefersDirectReads() const {
+        return direct_;
+    }
 } // mm
\ No newline at end of file
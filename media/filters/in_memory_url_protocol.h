@@ -9,15 +9,28 @@
 
 namespace mm {
     // Simple FFmpegURLProtocol that reads from a buffer.
+    //
+    // In direct mode AVIO reads packet data straight from the buffer into the
+    // packets, see FFmpegURLProtocol::PrefersDirectReads(), and only small
+    // header reads pass through a small AVIO buffer. Otherwise every read is
+    // staged in the AVIO buffer first, which copies the data twice.
     // NOTE: This object does not copy the buffer so the
     //       buffer pointer passed into the constructor
     //       needs to remain valid for the entire lifetime of
     //       this object.
     class InMemoryUrlProtocol : public FFmpegURLProtocol {
     public:
+        // AVIO buffer size preferred for streaming, small to keep the latency
+        // of the first packets low.
+        static constexpr int kStreamingBufferSize = 4 * 1024;
+
+        // AVIO buffer size preferred in direct mode, only header reads use it.
+        static constexpr int kDirectBufferSize = 4 * 1024;
+
         InMemoryUrlProtocol() = delete;
 
-        InMemoryUrlProtocol(const uint8_t* buf, int64_t size, bool streaming);
+        InMemoryUrlProtocol(const uint8_t* buf, int64_t size, bool streaming,
+                            bool direct = false);
 
         InMemoryUrlProtocol(const InMemoryUrlProtocol&) = delete;
 
@@ -34,11 +47,19 @@ namespace mm {
 
         bool GetSize(int64_t* size_out) override;
 
+        int PreferredBufferSize() const override;
+
+        bool PrefersDirectReads() const override;
+
+    protected:
+        bool streaming() const { return streaming_; }
+
     private:
         const uint8_t* data_;
         int64_t size_;
         int64_t position_;
         bool streaming_;
+        bool direct_;
     };
 
 } // mm
@@ -0,0 +1,543 @@
+//
+// Created by WangRuiLing on 2022/7/22.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <glog/logging.h>
+#include "media/filters/io_uring_url_protocol.h"
+
+namespace mm {
+    // There is no libc wrapper for the io_uring system calls.
+    static int IoUringSetup(unsigned entries, io_uring_params* params) {
+        return int(syscall(__NR_io_uring_setup, entries, params));
+    }
+
+    static int IoUringEnter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+        return int(syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+    }
+
+    static int IoUringRegister(int fd, unsigned opcode, const void* arg, unsigned count) {
+        return int(syscall(__NR_io_uring_register, fd, opcode, arg, count));
+    }
+
+    // pread() for when io_uring can't be used. Returns the bytes read or a
+    // negative errno.
+    static int PRead(int fd, int64_t offset, int size, uint8_t* data) {
+        while (true) {
+            const ssize_t result = pread(fd, data, size_t(size), off_t(offset));
+            if (result >= 0)
+                return int(result);
+            if (errno != EINTR)
+                return -errno;
+        }
+    }
+
+    // EAGAIN and EBUSY mean the kernel is short of resources until some
+    // completions are reaped.
+    static bool IsTransientError(int error) {
+        return error == EINTR || error == EAGAIN || error == EBUSY;
+    }
+
+    std::unique_ptr<IoUringContext> IoUringContext::Create(const Options& options) {
+        std::unique_ptr<IoUringContext> context(new IoUringContext());
+        if (!context->Initialize(options))
+            return nullptr;
+        return context;
+    }
+
+    IoUringContext* IoUringContext::Shared() {
+        // Never destroyed, protocols may be used until the process exits.
+        static IoUringContext* context = Create().release();
+        return context;
+    }
+
+    bool IoUringContext::Initialize(const Options& options) {
+        CHECK_GT(options.queue_depth, 0);
+        io_uring_params params{};
+        ring_fd_ = IoUringSetup(unsigned(options.queue_depth), &params);
+        if (ring_fd_ < 0) {
+            DLOG(WARNING) << "io_uring is unavailable: " << strerror(errno);
+            return false;
+        }
+
+        sq_entries_ = params.sq_entries;
+        sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        // Since 5.4 both rings live in one mapping.
+        const bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (single_mmap)
+            sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+
+        auto map = [this](size_t size, off_t offset) -> void* {
+            void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                             ring_fd_, offset);
+            return ptr == MAP_FAILED ? nullptr : ptr;
+        };
+        sq_ring_ = map(sq_ring_size_, IORING_OFF_SQ_RING);
+        cq_ring_ = single_mmap ? sq_ring_ : map(cq_ring_size_, IORING_OFF_CQ_RING);
+        sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = static_cast<io_uring_sqe*>(map(sqes_size_, IORING_OFF_SQES));
+        if (!sq_ring_ || !cq_ring_ || !sqes_) {
+            DLOG(WARNING) << "Couldn't map the io_uring rings: " << strerror(errno);
+            return false;
+        }
+
+        auto* sq = static_cast<uint8_t*>(sq_ring_);
+        sq_head_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        auto* cq = static_cast<uint8_t*>(cq_ring_);
+        cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+
+        RegisterBuffers(options.buffer_count, options.buffer_size);
+        completion_thread_ = std::thread(&IoUringContext::CompletionLoop, this);
+        return true;
+    }
+
+    void IoUringContext::RegisterBuffers(int count, int size) {
+        buffer_size_ = size;
+        if (count <= 0 || size <= 0)
+            return;
+
+        std::vector<iovec> iovecs(count);
+        for (int i = 0; i < count; ++i) {
+            buffers_.emplace_back(static_cast<uint8_t*>(
+                    AlignedAlloc(size_t(size), 4096, MemoryTag::kDecoder)));
+            iovecs[i].iov_base = buffers_.back().get();
+            iovecs[i].iov_len = size_t(size);
+        }
+        // Registering pins the pages, which counts against RLIMIT_MEMLOCK on
+        // older kernels. Without registered buffers every read is direct.
+        if (IoUringRegister(ring_fd_, IORING_REGISTER_BUFFERS, iovecs.data(), unsigned(count)) < 0) {
+            DLOG(WARNING) << "Couldn't register io_uring buffers: " << strerror(errno);
+            buffers_.clear();
+            return;
+        }
+        for (int i = count - 1; i >= 0; --i)
+            free_buffers_.push_back(i);
+    }
+
+    IoUringContext::~IoUringContext() {
+        if (completion_thread_.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(lock_);
+                DCHECK_EQ(in_flight_, 0U) << "IoUringUrlProtocols must not outlive their context";
+                stop_ = true;
+            }
+            // With nothing in flight the thread waits for |submitted_|, not in
+            // the kernel.
+            submitted_.notify_one();
+            completion_thread_.join();
+        }
+        // Unregistered implicitly when the ring is closed.
+        buffers_.clear();
+        if (sqes_)
+            munmap(sqes_, sqes_size_);
+        if (cq_ring_ && cq_ring_ != sq_ring_)
+            munmap(cq_ring_, cq_ring_size_);
+        if (sq_ring_)
+            munmap(sq_ring_, sq_ring_size_);
+        if (ring_fd_ >= 0)
+            close(ring_fd_);
+    }
+
+    void IoUringContext::Submit(Request* request, int fd, int64_t offset, int size,
+                                uint8_t* data, int buffer_index) {
+        std::unique_lock<std::mutex> lock(lock_);
+        DCHECK(request->done_) << "Request is still in flight";
+        request->done_ = false;
+        request->result_ = 0;
+        request->iov_ = {data, size_t(size)};
+
+        // Keep the completions within the completion queue, which is at least as
+        // large as the submission queue.
+        slot_freed_.wait(lock, [this] { return broken_ || in_flight_ < sq_entries_; });
+        if (broken_) {
+            lock.unlock();
+            const int result = PRead(fd, offset, size, data);
+            lock.lock();
+            request->result_ = result;
+            request->done_ = true;
+            return;
+        }
+
+        const unsigned tail = *sq_tail_;
+        const unsigned index = tail & sq_mask_;
+        io_uring_sqe* sqe = &sqes_[index];
+        memset(sqe, 0, sizeof(*sqe));
+        if (buffer_index >= 0) {
+            DCHECK_LT(buffer_index, buffer_count());
+            sqe->opcode = IORING_OP_READ_FIXED;
+            sqe->addr = reinterpret_cast<uint64_t>(data);
+            sqe->len = unsigned(size);
+            sqe->buf_index = uint16_t(buffer_index);
+        } else {
+            // IORING_OP_READ needs 5.6, READV works since 5.1 like READ_FIXED.
+            sqe->opcode = IORING_OP_READV;
+            sqe->addr = reinterpret_cast<uint64_t>(&request->iov_);
+            sqe->len = 1;
+        }
+        sqe->fd = fd;
+        sqe->off = uint64_t(offset);
+        sqe->user_data = reinterpret_cast<uint64_t>(request);
+        sq_array_[index] = index;
+        __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+        ++pending_;
+        ++in_flight_;
+
+        SubmitLocked(lock);
+    }
+
+    int IoUringContext::Wait(Request* request) {
+        std::unique_lock<std::mutex> lock(lock_);
+        request->completed_.wait(lock, [request] { return request->done_; });
+        return request->result_;
+    }
+
+    int IoUringContext::Read(int fd, int64_t offset, int size, uint8_t* data, int buffer_index) {
+        Request request;
+        Submit(&request, fd, offset, size, data, buffer_index);
+        return Wait(&request);
+    }
+
+    int IoUringContext::Enter(unsigned to_submit, unsigned min_complete, unsigned flags) {
+        if (enter_hook_) {
+            const int error = enter_hook_(to_submit);
+            if (error) {
+                errno = error;
+                return -1;
+            }
+        }
+        return IoUringEnter(ring_fd_, to_submit, min_complete, flags);
+    }
+
+    void IoUringContext::SubmitLocked(std::unique_lock<std::mutex>& lock) {
+        // Reads queued while the syscall runs are submitted by the next round.
+        while (pending_ > 0 && !submitting_ && !broken_) {
+            submitting_ = true;
+            const unsigned count = pending_;
+            pending_ = 0;
+            lock.unlock();
+
+            // The kernel consumes the oldest |count| entries, later ones are
+            // still counted in |pending_|.
+            unsigned submitted = 0;
+            int error = 0;
+            while (submitted < count) {
+                const int result = Enter(count - submitted, 0, 0);
+                if (result < 0) {
+                    if (IsTransientError(errno)) {
+                        std::this_thread::yield();
+                        continue;
+                    }
+                    error = errno;
+                    break;
+                }
+                submitted += unsigned(result);
+            }
+
+            lock.lock();
+            submitting_ = false;
+            if (submitted > 0) {
+                ++submit_calls_;
+                submitted_reads_ += submitted;
+                kernel_in_flight_ += submitted;
+                // Reads of cached data complete within io_uring_enter(), take
+                // them right away rather than through the completion thread.
+                if (!completion_waiting_)
+                    ReapLocked();
+                if (kernel_in_flight_ > 0)
+                    submitted_.notify_one();
+            }
+            // The completion thread may have broken the context during the
+            // call, it then left the queue to this thread.
+            if (broken_)
+                FailQueuedLocked();
+            else if (error)
+                BreakLocked(error);
+        }
+    }
+
+    void IoUringContext::BreakLocked(int error) {
+        if (broken_)
+            return;
+        DLOG(ERROR) << "io_uring_enter() failed, falling back to pread(): " << strerror(error);
+        broken_ = true;
+        error_ = error;
+        // A submitter in io_uring_enter() may still pass queued entries to the
+        // kernel, it fails the rest once the call returned.
+        if (!submitting_)
+            FailQueuedLocked();
+        // Readers waiting for a slot go to pread() now.
+        slot_freed_.notify_all();
+    }
+
+    void IoUringContext::FailQueuedLocked() {
+        DCHECK(broken_);
+        DCHECK(!submitting_);
+        // Nobody submits to a broken context, so the entries the kernel hasn't
+        // consumed, including those queued by other threads since, won't be.
+        const unsigned tail = *sq_tail_;
+        for (unsigned head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE); head != tail; ++head) {
+            const io_uring_sqe& sqe = sqes_[sq_array_[head & sq_mask_]];
+            CompleteLocked(reinterpret_cast<Request*>(sqe.user_data), -error_);
+        }
+        pending_ = 0;
+        slot_freed_.notify_all();
+    }
+
+    void IoUringContext::CompleteLocked(Request* request, int result) {
+        request->result_ = result;
+        request->done_ = true;
+        // The reader holds on to |request| until it reacquires the lock.
+        request->completed_.notify_one();
+        --in_flight_;
+    }
+
+    void IoUringContext::CompletionLoop() {
+        bool can_wait = true;
+        std::unique_lock<std::mutex> lock(lock_);
+        while (true) {
+            // Only wait in the kernel for reads it has, there may be none left
+            // to wake this thread otherwise.
+            submitted_.wait(lock, [this] { return stop_ || kernel_in_flight_ > 0; });
+            if (kernel_in_flight_ <= 0)
+                return;
+
+            if (can_wait) {
+                completion_waiting_ = true;
+                lock.unlock();
+                const int result = Enter(0, 1, IORING_ENTER_GETEVENTS);
+                const int error = errno;
+                lock.lock();
+                completion_waiting_ = false;
+                if (result < 0 && !IsTransientError(error)) {
+                    BreakLocked(error);
+                    can_wait = false;
+                }
+            } else {
+                lock.unlock();
+                // The kernel still posts the completions of the reads it took,
+                // poll for them until they are all in.
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                lock.lock();
+            }
+            ReapLocked();
+        }
+    }
+
+    void IoUringContext::ReapLocked() {
+        // The head only moves under |lock_|.
+        unsigned head = *cq_head_;
+        const unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+        if (head == tail)
+            return;
+        for (; head != tail; ++head) {
+            const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+            CompleteLocked(reinterpret_cast<Request*>(cqe.user_data), cqe.res);
+            --kernel_in_flight_;
+        }
+        __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+        slot_freed_.notify_all();
+    }
+
+    int IoUringContext::AcquireBuffer() {
+        std::lock_guard<std::mutex> lock(lock_);
+        if (free_buffers_.empty())
+            return -1;
+        const int index = free_buffers_.back();
+        free_buffers_.pop_back();
+        return index;
+    }
+
+    void IoUringContext::ReleaseBuffer(int index) {
+        DCHECK_GE(index, 0);
+        DCHECK_LT(index, buffer_count());
+        std::lock_guard<std::mutex> lock(lock_);
+        free_buffers_.push_back(index);
+    }
+
+    bool IoUringContext::broken() const {
+        std::lock_guard<std::mutex> lock(lock_);
+        return broken_;
+    }
+
+    int64_t IoUringContext::submit_calls() const {
+        std::lock_guard<std::mutex> lock(lock_);
+        return submit_calls_;
+    }
+
+    int64_t IoUringContext::submitted_reads() const {
+        std::lock_guard<std::mutex> lock(lock_);
+        return submitted_reads_;
+    }
+
+    std::unique_ptr<IoUringUrlProtocol> IoUringUrlProtocol::Open(const std::string& path,
+                                                                 IoUringContext* context) {
+        const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            DLOG(ERROR) << "Couldn't open " << path << ": " << strerror(errno);
+            return nullptr;
+        }
+        auto protocol = std::make_unique<IoUringUrlProtocol>(fd, context);
+        protocol->owns_fd_ = true;
+        return protocol;
+    }
+
+    IoUringUrlProtocol::IoUringUrlProtocol(int fd, IoUringContext* context)
+            : fd_(fd), context_(context) {
+        DCHECK_GE(fd, 0);
+        struct stat info{};
+        if (fstat(fd_, &info) == 0)
+            size_ = info.st_size;
+        // io_uring reads go through the page cache as well, so the kernel's
+        // read-ahead applies to both paths. Only a hint, failures don't matter.
+        posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+    }
+
+    IoUringUrlProtocol::~IoUringUrlProtocol() {
+        // The kernel may still be reading into the buffer read ahead.
+        if (ahead_.buffer >= 0) {
+            context_->Wait(&ahead_request_);
+            context_->ReleaseBuffer(ahead_.buffer);
+        }
+        ReleaseWindow();
+        if (owns_fd_)
+            close(fd_);
+    }
+
+    void IoUringUrlProtocol::ReleaseWindow() {
+        if (window_.buffer >= 0)
+            context_->ReleaseBuffer(window_.buffer);
+        window_ = Window();
+    }
+
+    void IoUringUrlProtocol::ReadAhead() {
+        // A short window ends at the end of the file.
+        const int64_t offset = window_.offset + window_.size;
+        if (ahead_.buffer >= 0 || window_.size < context_->buffer_size() ||
+            (size_ >= 0 && offset >= size_))
+            return;
+
+        ahead_.buffer = context_->AcquireBuffer();
+        if (ahead_.buffer < 0)
+            return;
+        ahead_.offset = offset;
+        context_->Submit(&ahead_request_, fd_, offset, context_->buffer_size(),
+                         context_->buffer(ahead_.buffer), ahead_.buffer);
+    }
+
+    void IoUringUrlProtocol::FinishReadAhead() {
+        DCHECK_LT(window_.buffer, 0);
+        const int result = context_->Wait(&ahead_request_);
+        // After a seek the data may be of no use. Errors are left for the read
+        // at |position_| to report.
+        if (result > 0 && position_ >= ahead_.offset && position_ < ahead_.offset + result) {
+            window_ = ahead_;
+            window_.size = result;
+        } else {
+            context_->ReleaseBuffer(ahead_.buffer);
+        }
+        ahead_ = Window();
+    }
+
+    int IoUringUrlProtocol::Read(int size, uint8_t* data) {
+        // Not sure if this can happen, but it's unclear from the ffmpeg code, so guard
+        // against it.
+        if (size < 0)
+            return AVERROR(EIO);
+        if (!size)
+            return 0;
+
+        // PRead() returns -errno on failure, which is AVERROR(errno).
+        if (!context_) {
+            const int result = PRead(fd_, position_, size, data);
+            if (result > 0)
+                position_ += result;
+            return result == 0 ? AVERROR_EOF : result;
+        }
+
+        if (window_.buffer < 0 && ahead_.buffer >= 0)
+            FinishReadAhead();
+
+        // Refill the window, unless the read is at least as large.
+        if (window_.buffer < 0 && size < context_->buffer_size()) {
+            window_.buffer = context_->AcquireBuffer();
+            if (window_.buffer >= 0) {
+                const int result = context_->Read(fd_, position_, context_->buffer_size(),
+                                                  context_->buffer(window_.buffer),
+                                                  window_.buffer);
+                if (result <= 0) {
+                    ReleaseWindow();
+                    return result == 0 ? AVERROR_EOF : result;
+                }
+                window_.offset = position_;
+                window_.size = result;
+            }
+        }
+
+        if (window_.buffer >= 0) {
+            // Get the kernel started on the next window before copying.
+            ReadAhead();
+
+            DCHECK_GE(position_, window_.offset);
+            DCHECK_LT(position_, window_.offset + window_.size);
+            const int bytes = int(std::min<int64_t>(size, window_.offset + window_.size - position_));
+            memcpy(data, context_->buffer(window_.buffer) + (position_ - window_.offset), bytes);
+            position_ += bytes;
+            // Hand the buffer back as soon as it is consumed, other streams may
+            // be waiting for one.
+            if (position_ == window_.offset + window_.size)
+                ReleaseWindow();
+            return bytes;
+        }
+
+        // No window, read directly into |data|.
+        const int result = context_->Read(fd_, position_, size, data, -1);
+        if (result > 0)
+            position_ += result;
+        return result == 0 ? AVERROR_EOF : result;
+    }
+
+    bool IoUringUrlProtocol::GetPosition(int64_t* position_out) {
+        if (!position_out)
+            return false;
+
+        *position_out = position_;
+        return true;
+    }
+
+    bool IoUringUrlProtocol::SetPosition(int64_t position) {
+        if (position < 0 || (size_ >= 0 && position > size_))
+            return false;
+        position_ = position;
+        // The read ahead is checked by the next Read(), waiting for it here
+        // would make seeks block.
+        if (window_.buffer >= 0 &&
+            (position_ < window_.offset || position_ >= window_.offset + window_.size))
+            ReleaseWindow();
+        return true;
+    }
+
+    bool IoUringUrlProtocol::GetSize(int64_t* size_out) {
+        if (!size_out || size_ < 0)
+            return false;
+
+        *size_out = size_;
+        return true;
+    }
+} // mm
@@ -0,0 +1,285 @@
+//
+// Created by WangRuiLing on 2022/7/22.
+//
+
+#ifndef MULTIMEDIA_IO_URING_URL_PROTOCOL_H
+#define MULTIMEDIA_IO_URING_URL_PROTOCOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/uio.h>
+#include "base/memory/AlignedMemory.h"
+#include "media/filters/ffmpeg_glue.h"
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace mm {
+    // An io_uring instance shared by many IoUringUrlProtocols, e.g. all the
+    // streams of a batch decode. Reads are submitted from the calling threads:
+    // whoever finds the ring idle submits every read queued so far with one
+    // io_uring_enter(), reads queued meanwhile go out with the next call. The
+    // submitter takes the reads that completed within the call, as reads of
+    // cached data do; a completion thread waits for the others and wakes the
+    // readers.
+    //
+    // A set of buffers is registered with the ring up front, which saves the
+    // kernel from mapping the pages of every read. Protocols check them out as
+    // their read-ahead windows.
+    //
+    // If io_uring_enter() fails with anything but a transient error the
+    // context is marked broken: reads not yet passed to the kernel fail with
+    // the error, reads already passed to it complete normally, and later reads
+    // use pread() on the calling thread.
+    class IoUringContext {
+    public:
+        struct Options {
+            // Size of the submission queue, and the most reads in flight.
+            int queue_depth = 256;
+            // Registered buffers and their size. With no buffers, or if
+            // registering them fails, reads go straight to the caller's memory.
+            int buffer_count = 64;
+            int buffer_size = 64 * 1024;
+        };
+
+        // A read started with Submit(). It must stay alive, and its memory
+        // untouched, until Wait() returned.
+        class Request {
+        public:
+            Request() = default;
+
+            Request(const Request&) = delete;
+
+            Request& operator=(const Request&) = delete;
+
+        private:
+            friend class IoUringContext;
+
+            // IORING_OP_READV reads the iovec when the read is issued.
+            iovec iov_{};
+            std::condition_variable completed_;
+            int result_ = 0;
+            bool done_ = true;
+        };
+
+        // Returns nullptr if io_uring is unavailable, e.g. on kernels before 5.1
+        // or when blocked by a seccomp filter.
+        static std::unique_ptr<IoUringContext> Create(const Options& options);
+
+        static std::unique_ptr<IoUringContext> Create() { return Create(Options()); }
+
+        // Returns a process wide context with the default options, or nullptr if
+        // io_uring is unavailable.
+        static IoUringContext* Shared();
+
+        ~IoUringContext();
+
+        // Starts reading up to |size| bytes of |fd| at |offset| into |data|.
+        // |buffer_index| is the registered buffer |data| points into, or -1 for
+        // any other memory. Only blocks while the queue is full.
+        void Submit(Request* request, int fd, int64_t offset, int size, uint8_t* data,
+                    int buffer_index);
+
+        // Waits for |request| and returns the bytes read, or a negative errno.
+        int Wait(Request* request);
+
+        // Submit() and Wait() in one.
+        int Read(int fd, int64_t offset, int size, uint8_t* data, int buffer_index);
+
+        // Returns a free registered buffer, or -1 if all are in use.
+        int AcquireBuffer();
+
+        void ReleaseBuffer(int index);
+
+        uint8_t* buffer(int index) const { return buffers_[index].get(); }
+
+        int buffer_size() const { return buffer_size_; }
+
+        // Number of registered buffers, 0 if registering failed.
+        int buffer_count() const { return int(buffers_.size()); }
+
+        // True once io_uring_enter() failed for good, see above.
+        bool broken() const;
+
+        // Number of io_uring_enter() calls made to submit reads, and the reads
+        // they submitted; their ratio is the average batch size.
+        int64_t submit_calls() const;
+
+        int64_t submitted_reads() const;
+
+        // Calls |hook| before every io_uring_enter() with the entries the call
+        // submits, 0 when it waits for completions. Unless |hook| returns 0 the
+        // call fails with that errno instead. |hook| runs without the context
+        // locked and may block. Must be set before the first read.
+        void SetEnterHookForTesting(std::function<int(unsigned to_submit)> hook) {
+            enter_hook_ = std::move(hook);
+        }
+
+        IoUringContext(const IoUringContext&) = delete;
+
+        IoUringContext& operator=(const IoUringContext&) = delete;
+
+    private:
+        IoUringContext() = default;
+
+        bool Initialize(const Options& options);
+
+        void RegisterBuffers(int count, int size);
+
+        // Submits the queued reads unless another thread is already submitting,
+        // which then picks them up. Called with |lock| held.
+        void SubmitLocked(std::unique_lock<std::mutex>& lock);
+
+        // io_uring_enter() through |enter_hook_|.
+        int Enter(unsigned to_submit, unsigned min_complete, unsigned flags);
+
+        // Marks the context broken. The queued reads the kernel hasn't taken
+        // fail right away, or once the submitter in io_uring_enter() is back.
+        void BreakLocked(int error);
+
+        // Fails the reads in the submission queue with |error_|. Only called
+        // while nobody is submitting.
+        void FailQueuedLocked();
+
+        void CompleteLocked(Request* request, int result);
+
+        // Completes the reads in the completion queue.
+        void ReapLocked();
+
+        void CompletionLoop();
+
+        int ring_fd_ = -1;
+
+        // The mapped rings.
+        void* sq_ring_ = nullptr;
+        size_t sq_ring_size_ = 0;
+        void* cq_ring_ = nullptr;
+        size_t cq_ring_size_ = 0;
+        io_uring_sqe* sqes_ = nullptr;
+        size_t sqes_size_ = 0;
+
+        unsigned* sq_head_ = nullptr;
+        unsigned* sq_tail_ = nullptr;
+        unsigned* sq_array_ = nullptr;
+        unsigned sq_mask_ = 0;
+        unsigned sq_entries_ = 0;
+        unsigned* cq_head_ = nullptr;
+        unsigned* cq_tail_ = nullptr;
+        io_uring_cqe* cqes_ = nullptr;
+        unsigned cq_mask_ = 0;
+
+        int buffer_size_ = 0;
+        std::vector<std::unique_ptr<uint8_t, AlignedFreeDeleter>> buffers_;
+
+        // Guards everything below and the submission queue.
+        mutable std::mutex lock_;
+        // Signaled when a slot for a read frees up.
+        std::condition_variable slot_freed_;
+        // Signaled when the kernel took reads, for the completion thread.
+        std::condition_variable submitted_;
+        std::vector<int> free_buffers_;
+        // Queued in the submission queue but not yet passed to the kernel.
+        unsigned pending_ = 0;
+        // Queued or passed to the kernel, and not completed.
+        unsigned in_flight_ = 0;
+        // Passed to the kernel and not reaped. The completion thread may reap a
+        // read before its submitter counted it, so this can briefly be negative.
+        int64_t kernel_in_flight_ = 0;
+        bool submitting_ = false;
+        // Set while the completion thread waits in the kernel. Nobody else
+        // reaps then, the thread could keep waiting for a completion taken
+        // from under it.
+        bool completion_waiting_ = false;
+        bool broken_ = false;
+        // The error that broke the context.
+        int error_ = 0;
+        bool stop_ = false;
+        int64_t submit_calls_ = 0;
+        int64_t submitted_reads_ = 0;
+
+        std::function<int(unsigned to_submit)> enter_hook_;
+
+        std::thread completion_thread_;
+    };
+
+    // FFmpegURLProtocol reading a file through an IoUringContext, for decoding
+    // many files concurrently. Like FileUrlProtocol it keeps its own position
+    // and reads ahead: a window of up to IoUringContext::buffer_size() bytes is
+    // read into a registered buffer, and while it is consumed the next window is
+    // already being read into a second one, so sequential reads rarely wait for
+    // the kernel. Buffers go back to the context once consumed. When none are
+    // free, reads go directly into FFmpeg's buffer instead. Without a context it
+    // falls back to pread().
+    // NOTE: A protocol constructed from an fd doesn't own it, the fd needs to
+    //       remain open for the entire lifetime of this object. |context| must
+    //       outlive this object.
+    class IoUringUrlProtocol : public FFmpegURLProtocol {
+    public:
+        // Opens the file at |path| and returns a protocol owning the fd, or
+        // nullptr if the file can't be opened. |context| defaults to
+        // IoUringContext::Shared().
+        static std::unique_ptr<IoUringUrlProtocol> Open(const std::string& path,
+                                                        IoUringContext* context);
+
+        static std::unique_ptr<IoUringUrlProtocol> Open(const std::string& path) {
+            return Open(path, IoUringContext::Shared());
+        }
+
+        // Reads from |fd| through |context|, or with pread() if it is null.
+        IoUringUrlProtocol(int fd, IoUringContext* context);
+
+        IoUringUrlProtocol(const IoUringUrlProtocol&) = delete;
+
+        IoUringUrlProtocol& operator=(const IoUringUrlProtocol&) = delete;
+
+        virtual ~IoUringUrlProtocol();
+
+        // FFmpegURLProtocol methods.
+        int Read(int size, uint8_t* data) override;
+
+        bool GetPosition(int64_t* position_out) override;
+
+        bool SetPosition(int64_t position) override;
+
+        bool GetSize(int64_t* size_out) override;
+
+        // True if reads go through io_uring, false if they fall back to pread().
+        bool uses_io_uring() const { return context_ != nullptr; }
+
+    private:
+        // A registered buffer holding bytes [offset, offset + size) of the file.
+        struct Window {
+            int buffer = -1;
+            int64_t offset = 0;
+            int64_t size = 0;
+        };
+
+        // Starts reading the window after |window_| if a buffer is free.
+        void ReadAhead();
+
+        // Waits for the read ahead and makes it |window_| if it holds
+        // |position_|, otherwise releases it.
+        void FinishReadAhead();
+
+        void ReleaseWindow();
+
+        const int fd_;
+        bool owns_fd_ = false;
+        IoUringContext* const context_;
+        int64_t size_ = -1;
+        int64_t position_ = 0;
+
+        // The window being consumed, and the one being read ahead.
+        Window window_;
+        Window ahead_;
+        IoUringContext::Request ahead_request_;
+    };
+
+} // mm
+
+#endif //MULTIMEDIA_IO_URING_URL_PROTOCOL_H
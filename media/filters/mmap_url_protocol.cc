@@ -0,0 +1,30 @@
+//
+// Created by WangRuiLing on 2022/7/18.
+//
+
+#include <glog/logging.h>
+#include "media/filters/mmap_url_protocol.h"
+
+namespace mm {
+    std::unique_ptr<MmapUrlProtocol> MmapUrlProtocol::Open(const std::string& path,
+                                                           bool streaming) {
+        auto file = std::make_shared<MemoryMappedFile>();
+        if (!file->Initialize(path))
+            return nullptr;
+        return std::make_unique<MmapUrlProtocol>(std::move(file), streaming);
+    }
+
+    MmapUrlProtocol::MmapUrlProtocol(std::shared_ptr<const MemoryMappedFile> file,
+                                     bool streaming)
+            : InMemoryUrlProtocol(file->data(), int64_t(file->length()), streaming),
+              file_(std::move(file)) {
+        DCHECK(file_->IsValid());
+        file_->Advise(MemoryMappedFile::Access::kSequential);
+    }
+
+    MmapUrlProtocol::~MmapUrlProtocol() = default;
+
+    int MmapUrlProtocol::PreferredBufferSize() const {
+        return streaming() ? kStreamingBufferSize : kBufferSize;
+    }
+} // mm
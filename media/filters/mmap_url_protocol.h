@@ -0,0 +1,49 @@
+//
+// Created by WangRuiLing on 2022/7/18.
+//
+
+#ifndef MULTIMEDIA_MMAP_URL_PROTOCOL_H
+#define MULTIMEDIA_MMAP_URL_PROTOCOL_H
+
+#include <memory>
+#include <string>
+#include "base/files/MemoryMappedFile.h"
+#include "media/filters/in_memory_url_protocol.h"
+
+namespace mm {
+    // FFmpegURLProtocol that reads from a memory mapped file. Unlike reading
+    // the file into a buffer for InMemoryUrlProtocol, nothing is read up front
+    // and the pages are shared with the page cache. Several protocols, e.g. one
+    // per reader thread, may share one mapping; each keeps it alive.
+    class MmapUrlProtocol : public InMemoryUrlProtocol {
+    public:
+        // AVIO buffer size preferred when not streaming. Reads are a memcpy from
+        // the mapping, so larger buffers only save calls through AVIO.
+        static constexpr int kBufferSize = 256 * 1024;
+
+        // Maps the file at |path|, returns nullptr if that fails.
+        static std::unique_ptr<MmapUrlProtocol> Open(const std::string& path,
+                                                     bool streaming = false);
+
+        // Reads from |file|, which must be valid. Advises the kernel of
+        // sequential access, the pattern of decoding, which makes read-ahead
+        // more aggressive.
+        MmapUrlProtocol(std::shared_ptr<const MemoryMappedFile> file, bool streaming);
+
+        MmapUrlProtocol(const MmapUrlProtocol&) = delete;
+
+        MmapUrlProtocol& operator=(const MmapUrlProtocol&) = delete;
+
+        ~MmapUrlProtocol() override;
+
+        int PreferredBufferSize() const override;
+
+        const std::shared_ptr<const MemoryMappedFile>& file() const { return file_; }
+
+    private:
+        std::shared_ptr<const MemoryMappedFile> file_;
+    };
+
+} // mm
+
+#endif //MULTIMEDIA_MMAP_URL_PROTOCOL_H
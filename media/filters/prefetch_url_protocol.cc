@@ -0,0 +1,193 @@
+//
+// Created by WangRuiLing on 2022/7/21.
+//
+
+#include <algorithm>
+#include <cstring>
+#include <glog/logging.h>
+#include "media/filters/prefetch_url_protocol.h"
+
+namespace mm {
+    PrefetchUrlProtocol::PrefetchUrlProtocol(FFmpegURLProtocol* protocol,
+                                             int block_size,
+                                             int block_count)
+            : protocol_(protocol),
+              block_size_(block_size),
+              preferred_buffer_size_(protocol->PreferredBufferSize()),
+              prefers_direct_reads_(protocol->PrefersDirectReads()) {
+        CHECK_GT(block_size, 0);
+        CHECK_GT(block_count, 0);
+        has_size_ = protocol_->GetSize(&size_);
+        if (!protocol_->GetPosition(&position_))
+            position_ = 0;
+        fetch_position_ = position_;
+
+        blocks_.resize(block_count);
+        for (Block& block : blocks_)
+            block.data.reset(new uint8_t[block_size_]);
+
+        thread_ = std::thread(&PrefetchUrlProtocol::PrefetchLoop, this);
+    }
+
+    PrefetchUrlProtocol::~PrefetchUrlProtocol() {
+        {
+            std::lock_guard<std::mutex> lock(lock_);
+            stop_ = true;
+        }
+        freed_.notify_all();
+        thread_.join();
+    }
+
+    void PrefetchUrlProtocol::PrefetchLoop() {
+        std::unique_lock<std::mutex> lock(lock_);
+        while (true) {
+            freed_.wait(lock, [this] {
+                return stop_ || (count_ < blocks_.size() && fetch_status_ == 0);
+            });
+            if (stop_)
+                return;
+
+            // The slot after the last filled block. Read() only frees blocks at
+            // the head, so the slot stays the same while the lock is released.
+            Block& block = blocks_[(head_ + count_) % blocks_.size()];
+            const int64_t generation = generation_;
+            const int64_t offset = fetch_position_;
+            const bool seek = seek_pending_;
+            seek_pending_ = false;
+
+            lock.unlock();
+            int result;
+            if (seek && !protocol_->SetPosition(offset))
+                result = AVERROR(EIO);
+            else
+                result = protocol_->Read(block_size_, block.data.get());
+            lock.lock();
+
+            // Restarted while reading, the data is for an old position.
+            if (generation != generation_)
+                continue;
+
+            if (result > 0) {
+                block.offset = offset;
+                block.size = result;
+                ++count_;
+                fetch_position_ += result;
+            } else {
+                fetch_status_ = result == 0 ? AVERROR_EOF : result;
+            }
+            filled_.notify_one();
+        }
+    }
+
+    void PrefetchUrlProtocol::RestartLocked(int64_t position) {
+        head_ = 0;
+        count_ = 0;
+        position_ = position;
+        fetch_position_ = position;
+        ++generation_;
+        seek_pending_ = true;
+        fetch_status_ = 0;
+        ++restarts_;
+        freed_.notify_one();
+    }
+
+    int PrefetchUrlProtocol::Read(int size, uint8_t* data) {
+        // Not sure if this can happen, but it's unclear from the ffmpeg code, so guard
+        // against it.
+        if (size < 0)
+            return AVERROR(EIO);
+        if (!size)
+            return 0;
+
+        std::unique_lock<std::mutex> lock(lock_);
+        if (count_ == 0 && fetch_status_ == 0) {
+            ++misses_;
+            filled_.wait(lock, [this] { return count_ > 0 || fetch_status_ != 0; });
+        } else {
+            ++hits_;
+        }
+
+        // Copy as much as is prefetched, without waiting for more.
+        int copied = 0;
+        while (copied < size && count_ > 0) {
+            Block& block = blocks_[head_];
+            const int64_t offset_in_block = position_ - block.offset;
+            DCHECK_GE(offset_in_block, 0);
+            DCHECK_LT(offset_in_block, block.size);
+            const int bytes = int(std::min<int64_t>(size - copied, block.size - offset_in_block));
+            memcpy(data + copied, block.data.get() + offset_in_block, bytes);
+            copied += bytes;
+            position_ += bytes;
+            if (position_ == block.offset + block.size) {
+                head_ = (head_ + 1) % blocks_.size();
+                --count_;
+                freed_.notify_one();
+            }
+        }
+        return copied > 0 ? copied : fetch_status_;
+    }
+
+    bool PrefetchUrlProtocol::GetPosition(int64_t* position_out) {
+        if (!position_out)
+            return false;
+
+        std::lock_guard<std::mutex> lock(lock_);
+        *position_out = position_;
+        return true;
+    }
+
+    bool PrefetchUrlProtocol::SetPosition(int64_t position) {
+        if (position < 0 || (has_size_ && position > size_))
+            return false;
+
+        std::lock_guard<std::mutex> lock(lock_);
+        if (position == position_)
+            return true;
+
+        // Within the ring or right after it, keep prefetching and drop the
+        // blocks before |position|.
+        if (count_ > 0 && position >= blocks_[head_].offset && position <= fetch_position_) {
+            while (count_ > 0 && position >= blocks_[head_].offset + blocks_[head_].size) {
+                head_ = (head_ + 1) % blocks_.size();
+                --count_;
+            }
+            position_ = position;
+            freed_.notify_one();
+            return true;
+        }
+
+        RestartLocked(position);
+        return true;
+    }
+
+    bool PrefetchUrlProtocol::GetSize(int64_t* size_out) {
+        if (!size_out || !has_size_)
+            return false;
+
+        *size_out = size_;
+        return true;
+    }
+
+    int PrefetchUrlProtocol::PreferredBufferSize() const {
+        return preferred_buffer_size_;
+    }
+
+    bool PrefetchUrlProtocol::PrefersDirectReads() const {
+        return prefers_direct_reads_;
+    }
+
+    int64_t PrefetchUrlProtocol::hits() const {
+        std::lock_guard<std::mutex> lock(lock_);
+        return hits_;
+    }
+
+    int64_t PrefetchUrlProtocol::misses() const {
+        std::lock_guard<std::mutex> lock(lock_);
+        return misses_;
+    }
+
+    int64_t PrefetchUrlProtocol::restarts() const {
+        std::lock_guard<std::mutex> lock(lock_);
+        return restarts_;
+    }
+} // mm
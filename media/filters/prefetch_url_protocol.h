@@ -0,0 +1,123 @@
+//
+// Created by WangRuiLing on 2022/7/21.
+//
+
+#ifndef MULTIMEDIA_PREFETCH_URL_PROTOCOL_H
+#define MULTIMEDIA_PREFETCH_URL_PROTOCOL_H
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "media/filters/ffmpeg_glue.h"
+
+namespace mm {
+    // FFmpegURLProtocol decorator which reads ahead of the demuxer on a
+    // background thread, so that AVIOReadOperation() and with it the decode
+    // loop of AudioFileReader::Read() only block on I/O when the prefetch falls
+    // behind. Data is fetched in blocks into a fixed ring; Read() is served from
+    // the ring and frees blocks for the thread to refill.
+    //
+    // SetPosition() within the ring just drops the blocks before the new
+    // position. Any other jump cancels the prefetch, the block in flight is
+    // discarded, and restarts it at the new position.
+    //
+    // Usage:
+    //   auto file = FileUrlProtocol::Open(path);
+    //   PrefetchUrlProtocol prefetch(file.get());
+    //   AudioFileReader reader(&prefetch);
+    //
+    // NOTE: Once constructed, |protocol| is only used on the prefetch thread and
+    //       must outlive this object.
+    class PrefetchUrlProtocol : public FFmpegURLProtocol {
+    public:
+        static constexpr int kDefaultBlockSize = 64 * 1024;
+        static constexpr int kDefaultBlockCount = 8;
+
+        explicit PrefetchUrlProtocol(FFmpegURLProtocol* protocol,
+                                     int block_size = kDefaultBlockSize,
+                                     int block_count = kDefaultBlockCount);
+
+        PrefetchUrlProtocol(const PrefetchUrlProtocol&) = delete;
+
+        PrefetchUrlProtocol& operator=(const PrefetchUrlProtocol&) = delete;
+
+        virtual ~PrefetchUrlProtocol();
+
+        // FFmpegURLProtocol methods.
+        int Read(int size, uint8_t* data) override;
+
+        bool GetPosition(int64_t* position_out) override;
+
+        bool SetPosition(int64_t position) override;
+
+        bool GetSize(int64_t* size_out) override;
+
+        int PreferredBufferSize() const override;
+
+        bool PrefersDirectReads() const override;
+
+        // Reads served from prefetched data without waiting.
+        int64_t hits() const;
+
+        // Reads which had to wait for the prefetch thread.
+        int64_t misses() const;
+
+        // Times the prefetch was restarted by SetPosition().
+        int64_t restarts() const;
+
+    private:
+        struct Block {
+            std::unique_ptr<uint8_t[]> data;
+            int64_t offset = 0;
+            int size = 0;
+        };
+
+        void PrefetchLoop();
+
+        // Drops all blocks and restarts the prefetch at |position|.
+        void RestartLocked(int64_t position);
+
+        FFmpegURLProtocol* const protocol_;
+        const int block_size_;
+        const int preferred_buffer_size_;
+        const bool prefers_direct_reads_;
+        int64_t size_ = -1;
+        bool has_size_ = false;
+
+        mutable std::mutex lock_;
+        // Signaled when a block is filled or the prefetch hits the end or an
+        // error, and when blocks are freed or the prefetch is restarted.
+        std::condition_variable filled_;
+        std::condition_variable freed_;
+
+        // The ring; blocks [head_, head_ + count_) hold consecutive data starting
+        // at the block containing |position_|.
+        std::vector<Block> blocks_;
+        size_t head_ = 0;
+        size_t count_ = 0;
+
+        // Read position of the demuxer.
+        int64_t position_ = 0;
+        // Where the prefetch thread reads next.
+        int64_t fetch_position_ = 0;
+        // Incremented by every restart, so the thread discards a block read
+        // for an old position.
+        int64_t generation_ = 0;
+        // Set when the thread must seek |protocol_| before reading.
+        bool seek_pending_ = false;
+        // Result of the last read when it was the end or an error, 0 otherwise.
+        int fetch_status_ = 0;
+        bool stop_ = false;
+
+        int64_t hits_ = 0;
+        int64_t misses_ = 0;
+        int64_t restarts_ = 0;
+
+        std::thread thread_;
+    };
+
+} // mm
+
+#endif //MULTIMEDIA_PREFETCH_URL_PROTOCOL_H
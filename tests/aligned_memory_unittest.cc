@@ -0,0 +1,56 @@
+//
+// Created by wang rl on 2022/7/15.
+//
+
+#include <cstring>
+#include <memory>
+#include <gtest/gtest.h>
+
+#include "base/memory/AlignedMemory.h"
+
+namespace mm {
+    // Restores the huge page threshold at the end of a test.
+    class AlignedMemoryTest : public testing::Test {
+    protected:
+        void TearDown() override {
+            SetHugePageThreshold(kDefaultHugePageThreshold);
+        }
+    };
+
+    TEST_F(AlignedMemoryTest, Alloc) {
+        for (size_t alignment : {8, 16, 32, 64, 4096}) {
+            SCOPED_TRACE(alignment);
+            void* ptr = AlignedAlloc(1000, alignment);
+            EXPECT_TRUE(IsAligned(ptr, alignment));
+            memset(ptr, 0xff, 1000);
+            AlignedFree(ptr);
+        }
+    }
+
+    TEST_F(AlignedMemoryTest, HugePages) {
+        EXPECT_EQ(kDefaultHugePageThreshold, HugePageThreshold());
+        SetHugePageThreshold(kHugePageSize);
+
+        // Sizes which are not a multiple of the huge page size, just at and above
+        // the threshold.
+        for (size_t size : {kHugePageSize, kHugePageSize * 3 + 100}) {
+            SCOPED_TRACE(size);
+            std::unique_ptr<uint8_t, AlignedFreeDeleter> ptr(
+                    static_cast<uint8_t*>(AlignedAlloc(size, 64)));
+#if defined(__linux__)
+            EXPECT_TRUE(IsAligned(ptr.get(), kHugePageSize));
+            EXPECT_EQ(0, ptr.get()[size - 1]);
+#endif
+            memset(ptr.get(), 0x5a, size);
+        }
+
+        // Below the threshold or disabled, the heap is used.
+        void* small = AlignedAlloc(kHugePageSize - 64, 64);
+        memset(small, 0, kHugePageSize - 64);
+        AlignedFree(small);
+        SetHugePageThreshold(0);
+        void* disabled = AlignedAlloc(kHugePageSize * 2, 64);
+        memset(disabled, 0, kHugePageSize * 2);
+        AlignedFree(disabled);
+    }
+}
@@ -0,0 +1,102 @@
+//
+// Created by wang rl on 2022/7/15.
+//
+
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <gtest/gtest.h>
+
+#include "base/memory/Arena.h"
+#include "media/base/AudioBus.h"
+
+namespace mm {
+    TEST(ArenaTest, Allocate) {
+        Arena arena(1024);
+        EXPECT_EQ(0U, arena.bytes_reserved());
+
+        for (size_t alignment : {1, 4, 16, 32, 64, 128}) {
+            SCOPED_TRACE(alignment);
+            void* ptr = arena.Allocate(100, alignment);
+            EXPECT_TRUE(IsAligned(ptr, alignment));
+            memset(ptr, 0xab, 100);
+        }
+        EXPECT_LE(600U, arena.bytes_used());
+
+        // Consecutive allocations come from the same chunk.
+        auto* a = arena.AllocateArray<float>(4);
+        auto* b = arena.AllocateArray<float>(4);
+        EXPECT_EQ(a + 4, b);
+
+        // Allocations larger than a chunk get their own.
+        auto* large = static_cast<uint8_t*>(arena.Allocate(4000, 64));
+        memset(large, 0, 4000);
+        EXPECT_LE(1024U + 4000U, arena.bytes_reserved());
+    }
+
+    TEST(ArenaTest, ResetReusesChunks) {
+        Arena arena(1024);
+        void* first = arena.Allocate(512, 16);
+        arena.Allocate(800, 16);
+        const size_t reserved = arena.bytes_reserved();
+        EXPECT_EQ(2048U, reserved);
+
+        arena.Reset();
+        EXPECT_EQ(0U, arena.bytes_used());
+        EXPECT_EQ(first, arena.Allocate(512, 16));
+        arena.Allocate(800, 16);
+        EXPECT_EQ(reserved, arena.bytes_reserved());
+
+        arena.Release();
+        EXPECT_EQ(0U, arena.bytes_reserved());
+    }
+
+    TEST(ArenaTest, Scope) {
+        Arena arena(1024);
+        void* outer = arena.Allocate(16, 16);
+        void* inner = nullptr;
+        {
+            Arena::Scope scope(&arena);
+            inner = arena.Allocate(2000, 16);
+            {
+                Arena::Scope nested(&arena);
+                arena.Allocate(100, 16);
+            }
+            EXPECT_NE(inner, arena.Allocate(16, 16));
+        }
+        // Memory allocated in the scope is handed out again, that before it
+        // stays valid.
+        EXPECT_EQ(16U, arena.bytes_used());
+        EXPECT_NE(outer, arena.Allocate(16, 16));
+        EXPECT_EQ(inner, arena.Allocate(2000, 16));
+    }
+
+    TEST(ArenaTest, ForCurrentThread) {
+        Arena* arena = Arena::ForCurrentThread();
+        EXPECT_EQ(arena, Arena::ForCurrentThread());
+        Arena* other = nullptr;
+        std::thread([&other]() { other = Arena::ForCurrentThread(); }).join();
+        EXPECT_NE(arena, other);
+    }
+
+    TEST(ArenaTest, AudioBus) {
+        Arena arena;
+        Arena::Scope scope(&arena);
+        for (int alignment : {int(AudioBus::kSSEAlignment), int(AudioBus::kAVXAlignment),
+                              int(AudioBus::kCacheLineAlignment)}) {
+            SCOPED_TRACE(alignment);
+            std::unique_ptr<AudioBus> bus = AudioBus::Create(&arena, 6, 1023, alignment);
+            EXPECT_EQ(6, bus->channels());
+            EXPECT_EQ(1023, bus->frames());
+            for (int ch = 0; ch < bus->channels(); ++ch)
+                EXPECT_TRUE(IsAligned(bus->channel(ch), alignment));
+            bus->zero();
+            EXPECT_TRUE(bus->areFramesZero());
+        }
+        EXPECT_EQ(size_t(AudioBus::CalculateMemorySize(6, 1023, AudioBus::kSSEAlignment) +
+                         AudioBus::CalculateMemorySize(6, 1023, AudioBus::kAVXAlignment) +
+                         AudioBus::CalculateMemorySize(6, 1023,
+                                                       AudioBus::kCacheLineAlignment)),
+                  arena.bytes_used());
+    }
+}
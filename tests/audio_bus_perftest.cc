@@ -0,0 +1,267 @@
+//
+// Created by wang rl on 2022/7/5.
+//
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "base/memory/Arena.h"
+#include "media/base/AudioBus.h"
+#include "media/base/AudioBusPool.h"
+#include "media/base/AudioSampleTypes.h"
+
+namespace mm {
+    static const int kBenchmarkIterations = 20000;
+    static const int kFrameCount = 1024;
+
+    // The channel by channel strided loop AudioBus used before the optimized
+    // layouts existed, kept here as the baseline.
+    template<class SourceSampleTypeTraits>
+    static void GenericFromInterleaved(
+            const typename SourceSampleTypeTraits::ValueType* source,
+            int frames, AudioBus* dest) {
+        const int channels = dest->channels();
+        for (int ch = 0; ch < channels; ++ch) {
+            float* channelData = dest->channel(ch);
+            for (int i = 0; i < frames; ++i)
+                channelData[i] = SourceSampleTypeTraits::ToFloat(source[i * channels + ch]);
+        }
+    }
+
+    template<class TargetSampleTypeTraits>
+    static void GenericToInterleaved(
+            const AudioBus* source, int frames,
+            typename TargetSampleTypeTraits::ValueType* dest) {
+        const int channels = source->channels();
+        for (int ch = 0; ch < channels; ++ch) {
+            const float* channelData = source->channel(ch);
+            for (int i = 0; i < frames; ++i)
+                dest[i * channels + ch] = TargetSampleTypeTraits::FromFloat(channelData[i]);
+        }
+    }
+
+    // Runs |function| kBenchmarkIterations times and returns the frames
+    // processed per second.
+    template<typename Function>
+    static double MeasureFramesPerSecond(Function function) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < kBenchmarkIterations; ++i)
+            function();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return double(kBenchmarkIterations) * kFrameCount / elapsed.count();
+    }
+
+    template<class SampleTypeTraits>
+    static void RunInterleaveBenchmark(const char* format) {
+        using ValueType = typename SampleTypeTraits::ValueType;
+        for (int channels : {1, 2, 6, 8}) {
+            std::unique_ptr<AudioBus> bus = AudioBus::Create(channels, kFrameCount);
+            std::vector<ValueType> interleaved(channels * kFrameCount);
+            for (size_t i = 0; i < interleaved.size(); ++i) {
+                interleaved[i] = SampleTypeTraits::FromFloat(
+                        float(i % 200) / 100.0f - 1.0f);
+            }
+
+            const double genericFrom = MeasureFramesPerSecond([&]() {
+                GenericFromInterleaved<SampleTypeTraits>(interleaved.data(),
+                                                         kFrameCount, bus.get());
+            });
+            const double from = MeasureFramesPerSecond([&]() {
+                bus->fromInterleaved<SampleTypeTraits>(interleaved.data(), kFrameCount);
+            });
+            const double genericTo = MeasureFramesPerSecond([&]() {
+                GenericToInterleaved<SampleTypeTraits>(bus.get(), kFrameCount,
+                                                       interleaved.data());
+            });
+            const double to = MeasureFramesPerSecond([&]() {
+                bus->toInterleaved<SampleTypeTraits>(kFrameCount, interleaved.data());
+            });
+            printf("%-6s %d ch  fromInterleaved %7.1f -> %7.1f Mframes/s (x%.1f)  "
+                   "toInterleaved %7.1f -> %7.1f Mframes/s (x%.1f)\n",
+                   format, channels, genericFrom / 1e6, from / 1e6, from / genericFrom,
+                   genericTo / 1e6, to / 1e6, to / genericTo);
+        }
+    }
+
+    TEST(AudioBusPerfTest, Interleave) {
+        RunInterleaveBenchmark<SignedInt16SampleTypeTraits>("s16");
+        RunInterleaveBenchmark<SignedInt32SampleTypeTraits>("s32");
+        RunInterleaveBenchmark<Float32SampleTypeTraits>("f32");
+    }
+
+    // Simulates the per packet allocation pattern of AudioFileReader::Read():
+    // chunks of MP3 sized buses which are processed and released again.
+    TEST(AudioBusPerfTest, Pool) {
+        static const int kChannels = 2;
+        static const int kMp3FrameCount = 1152;
+        static const int kPacketsPerChunk = 32;
+        static const int kChunks = 5000;
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < kChunks; ++i) {
+            std::vector<std::unique_ptr<AudioBus>> packets;
+            for (int j = 0; j < kPacketsPerChunk; ++j) {
+                packets.push_back(AudioBus::Create(kChannels, kMp3FrameCount));
+                packets.back()->zero();
+            }
+        }
+        std::chrono::duration<double> created = std::chrono::steady_clock::now() - start;
+
+        AudioBusPool pool;
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < kChunks; ++i) {
+            std::vector<AudioBusPool::ScopedAudioBus> packets;
+            for (int j = 0; j < kPacketsPerChunk; ++j) {
+                packets.push_back(pool.Create(kChannels, kMp3FrameCount));
+                packets.back()->zero();
+            }
+        }
+        std::chrono::duration<double> pooled = std::chrono::steady_clock::now() - start;
+
+        const double packets = double(kChunks) * kPacketsPerChunk;
+        printf("AudioBus::Create    %10.0f packets/s, %.0f allocations\n",
+               packets / created.count(), packets);
+        printf("AudioBusPool        %10.0f packets/s, %lld allocations, %lld reuses\n",
+               packets / pooled.count(), static_cast<long long>(pool.allocations()),
+               static_cast<long long>(pool.reuses()));
+        EXPECT_EQ(kPacketsPerChunk, pool.allocations());
+    }
+
+    // Mixes 8 to 128 stereo streams into one output block, once the way it was
+    // done before mixFrom() existed (scale a copy of every source and add it
+    // to the output) and once with mixFrom().
+    TEST(AudioBusPerfTest, Mix) {
+        static const int kChannels = 2;
+        static const int kBlocks = 2000;
+        for (int inputs : {8, 32, 64, 128}) {
+            std::vector<std::unique_ptr<AudioBus>> buses;
+            std::vector<const AudioBus*> sources;
+            std::vector<float> gains;
+            for (int k = 0; k < inputs; ++k) {
+                buses.push_back(AudioBus::Create(kChannels, kFrameCount));
+                for (int ch = 0; ch < kChannels; ++ch) {
+                    for (int i = 0; i < kFrameCount; ++i)
+                        buses[k]->channel(ch)[i] = float((i + k) % 200) / 100.0f - 1.0f;
+                }
+                sources.push_back(buses[k].get());
+                gains.push_back(1.0f / inputs);
+            }
+            std::unique_ptr<AudioBus> scratch = AudioBus::Create(kChannels, kFrameCount);
+            std::unique_ptr<AudioBus> dest = AudioBus::Create(kChannels, kFrameCount);
+
+            auto start = std::chrono::steady_clock::now();
+            for (int b = 0; b < kBlocks; ++b) {
+                dest->zero();
+                for (int k = 0; k < inputs; ++k) {
+                    sources[k]->copyTo(scratch.get());
+                    scratch->scale(gains[k]);
+                    for (int ch = 0; ch < kChannels; ++ch) {
+                        const float* src = scratch->channel(ch);
+                        float* out = dest->channel(ch);
+                        for (int i = 0; i < kFrameCount; ++i)
+                            out[i] += src[i];
+                    }
+                }
+                dest->copyAndClipTo(dest.get());
+            }
+            std::chrono::duration<double> manual = std::chrono::steady_clock::now() - start;
+
+            start = std::chrono::steady_clock::now();
+            for (int b = 0; b < kBlocks; ++b)
+                dest->mixFrom(sources, gains, true);
+            std::chrono::duration<double> mixed = std::chrono::steady_clock::now() - start;
+
+            const double blocks = double(kBlocks);
+            printf("%3d inputs  scale+add %8.0f blocks/s  mixFrom %8.0f blocks/s (x%.1f)\n",
+                   inputs, blocks / manual.count(), blocks / mixed.count(),
+                   manual.count() / mixed.count());
+        }
+    }
+
+    // Runs the per packet pattern of the Pool test on several threads at once,
+    // as concurrent decode sessions do, once with AudioBus::Create() and once
+    // with buses and scratch buffers from the per-thread arenas.
+    TEST(AudioBusPerfTest, Arena) {
+        static const int kChannels = 2;
+        static const int kMp3FrameCount = 1152;
+        static const int kPacketsPerChunk = 32;
+        static const int kChunks = 2000;
+
+        auto run = [](int threads, auto decodeChunk) {
+            auto start = std::chrono::steady_clock::now();
+            std::vector<std::thread> workers;
+            for (int t = 0; t < threads; ++t) {
+                workers.emplace_back([decodeChunk]() {
+                    for (int i = 0; i < kChunks; ++i)
+                        decodeChunk();
+                });
+            }
+            for (std::thread& worker : workers)
+                worker.join();
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            return double(threads) * kChunks * kPacketsPerChunk / elapsed.count();
+        };
+
+        for (int threads : {1, 2, 4, 8}) {
+            const double created = run(threads, []() {
+                std::vector<std::unique_ptr<AudioBus>> packets;
+                for (int j = 0; j < kPacketsPerChunk; ++j) {
+                    packets.push_back(AudioBus::Create(kChannels, kMp3FrameCount));
+                    packets.back()->zero();
+                    std::unique_ptr<float, AlignedFreeDeleter> scratch(static_cast<float*>(
+                            AlignedAlloc(sizeof(float) * kMp3FrameCount,
+                                         AudioBus::kChannelAlignment)));
+                    scratch.get()[0] = 0;
+                }
+            });
+            const double arena = run(threads, []() {
+                Arena* arena = Arena::ForCurrentThread();
+                Arena::Scope scope(arena);
+                std::vector<std::unique_ptr<AudioBus>> packets;
+                for (int j = 0; j < kPacketsPerChunk; ++j) {
+                    packets.push_back(AudioBus::Create(arena, kChannels, kMp3FrameCount));
+                    packets.back()->zero();
+                    float* scratch = arena->AllocateArray<float>(
+                            kMp3FrameCount, AudioBus::kChannelAlignment);
+                    scratch[0] = 0;
+                }
+            });
+            printf("%d threads  AudioBus::Create %10.0f packets/s  Arena %10.0f packets/s "
+                   "(x%.1f)\n", threads, created, arena, arena / created);
+        }
+    }
+
+    // Sequential DSP passes over a full-file sized bus, allocated once from the
+    // heap with 4 KB pages and once as transparent huge pages.
+    TEST(AudioBusPerfTest, HugePages) {
+        static const int kChannels = 2;
+        // 2 x 128 MB (2 channels x 16M frames x 4 bytes each), about six
+        // minutes of 48 kHz stereo.
+        static const int kFrames = 16 * 1024 * 1024;
+        static const int kPasses = 10;
+
+        for (size_t threshold : {size_t(0), kDefaultHugePageThreshold}) {
+            SetHugePageThreshold(threshold);
+            auto start = std::chrono::steady_clock::now();
+            std::unique_ptr<AudioBus> bus = AudioBus::Create(kChannels, kFrames);
+            std::unique_ptr<AudioBus> dest = AudioBus::Create(kChannels, kFrames);
+            bus->zero();
+            dest->zero();
+            std::chrono::duration<double> allocated = std::chrono::steady_clock::now() - start;
+
+            start = std::chrono::steady_clock::now();
+            for (int i = 0; i < kPasses; ++i) {
+                bus->scale(0.5f);
+                dest->accumulateFrom(bus.get(), 0.25f);
+            }
+            std::chrono::duration<double> processed = std::chrono::steady_clock::now() - start;
+            printf("%-11s allocate+zero %6.1f ms  %d passes %7.1f ms\n",
+                   threshold ? "huge pages" : "4 KB pages", allocated.count() * 1e3,
+                   kPasses, processed.count() * 1e3);
+        }
+        SetHugePageThreshold(kDefaultHugePageThreshold);
+    }
+}
@@ -0,0 +1,84 @@
+//
+// Created by wang rl on 2022/7/6.
+//
+
+#include <memory>
+#include <gtest/gtest.h>
+
+#include "media/base/AudioBusPool.h"
+
+namespace mm {
+    static const int kChannels = 2;
+    static const int kFrameCount = 1152;
+
+    // Verify a released bus is handed out again for the same size class.
+    TEST(AudioBusPoolTest, ReusesReleasedBus) {
+        AudioBusPool pool;
+        AudioBus* first = nullptr;
+        {
+            AudioBusPool::ScopedAudioBus bus = pool.Create(kChannels, kFrameCount);
+            first = bus.get();
+            EXPECT_EQ(kChannels, bus->channels());
+            EXPECT_EQ(kFrameCount, bus->frames());
+        }
+        EXPECT_EQ(1, pool.freeBuses());
+
+        // A slightly smaller request falls into the same size class.
+        AudioBusPool::ScopedAudioBus bus = pool.Create(kChannels, kFrameCount - 1);
+        EXPECT_EQ(first, bus.get());
+        EXPECT_EQ(kFrameCount - 1, bus->frames());
+        EXPECT_EQ(1, pool.allocations());
+        EXPECT_EQ(1, pool.reuses());
+        EXPECT_EQ(0, pool.freeBuses());
+
+        // The recycled bus must still be fully writable.
+        for (int ch = 0; ch < bus->channels(); ++ch)
+            std::fill(bus->channel(ch), bus->channel(ch) + bus->frames(), 1.0f);
+        EXPECT_FALSE(bus->areFramesZero());
+    }
+
+    // Verify buses of another size class are not shared.
+    TEST(AudioBusPoolTest, SizeClasses) {
+        AudioBusPool pool;
+        pool.Create(kChannels, kFrameCount).reset();
+        EXPECT_EQ(1, pool.freeBuses());
+
+        AudioBusPool::ScopedAudioBus mono = pool.Create(1, kFrameCount);
+        AudioBusPool::ScopedAudioBus longer = pool.Create(kChannels, kFrameCount + 16);
+        // The alignment is part of the size class as well.
+        const int otherAlignment =
+                AudioBus::kChannelAlignment == AudioBus::kCacheLineAlignment
+                ? AudioBus::kSSEAlignment : AudioBus::kCacheLineAlignment;
+        AudioBusPool::ScopedAudioBus aligned =
+                pool.Create(kChannels, kFrameCount, otherAlignment);
+        EXPECT_EQ(otherAlignment, aligned->alignment());
+        EXPECT_EQ(4, pool.allocations());
+        EXPECT_EQ(0, pool.reuses());
+        EXPECT_EQ(1, pool.freeBuses());
+
+        pool.clear();
+        EXPECT_EQ(0, pool.freeBuses());
+    }
+
+    // Verify the number of idle buses per size class is bounded.
+    TEST(AudioBusPoolTest, MaxFreeBuses) {
+        AudioBusPool pool(2);
+        std::vector<AudioBusPool::ScopedAudioBus> buses;
+        for (int i = 0; i < 4; ++i)
+            buses.push_back(pool.Create(kChannels, kFrameCount));
+        buses.clear();
+        EXPECT_EQ(2, pool.freeBuses());
+    }
+
+    // Verify buses may outlive their pool.
+    TEST(AudioBusPoolTest, BusOutlivesPool) {
+        AudioBusPool::ScopedAudioBus bus;
+        {
+            AudioBusPool pool;
+            bus = pool.Create(kChannels, kFrameCount);
+        }
+        bus->zero();
+        EXPECT_TRUE(bus->areFramesZero());
+        bus.reset();
+    }
+}
@@ -2,7 +2,10 @@
 // Created by WangRuiLing on 2022/6/14.
 //
 
+#include <cmath>
+#include <cstring>
 #include <memory>
+#include <random>
 #include <gtest/gtest.h>
 
 extern "C" {
@@ -10,6 +13,7 @@ extern "C" {
 }
 
 #include "media/base/AudioBus.h"
+#include "media/base/AudioBusView.h"
 #include "media/base/AudioSampleTypes.h"
 
 namespace mm {
@@ -68,13 +72,13 @@ namespace mm {
 
         // Read and write to the full extent of the allocated channel data. Also test
         // the Zero() method and verify it does as advertised. Also test data if data
-        // is 16-bytes aligned as advertised (see kChannelAlignment in AudioBus.h).
+        // is aligned as advertised (see alignment() in AudioBus.h).
         void verifyReadWriteAndAlignment(AudioBus* bus) {
             for (int i = 0; i < bus->channels(); i++) {
                 // Verify that the address returned by channel(i) is a multiple of
-                // AudioBus::kChannelAlignment.
+                // AudioBus::alignment().
                 ASSERT_EQ(0U, reinterpret_cast<uintptr_t>(
-                                      bus->channel(i)) & (AudioBus::kChannelAlignment - 1));
+                                      bus->channel(i)) & (bus->alignment() - 1));
 
                 // Write into the channel buffer.
                 std::fill(bus->channel(i), bus->channel(i) + bus->frames(), i);
@@ -152,6 +156,52 @@ namespace mm {
                   data.get() + dataSize / sizeof(*data.get()));
     }
 
+    // Verify every supported alignment pads the channels as advertised.
+    TEST_F(AudioBusTest, Alignment) {
+        EXPECT_EQ(AudioBus::kChannelAlignment,
+                  AudioBus::Create(kChannels, kFrameCount)->alignment());
+        EXPECT_FALSE(AudioBus::IsValidAlignment(8));
+        EXPECT_FALSE(AudioBus::IsValidAlignment(128));
+
+        for (int alignment : {int(AudioBus::kSSEAlignment),
+                              int(AudioBus::kAVXAlignment),
+                              int(AudioBus::kCacheLineAlignment)}) {
+            SCOPED_TRACE(alignment);
+            ASSERT_TRUE(AudioBus::IsValidAlignment(alignment));
+            std::unique_ptr<AudioBus> bus =
+                    AudioBus::Create(kChannels, kFrameCount, alignment);
+            EXPECT_EQ(alignment, bus->alignment());
+            verifyChannelAndFrameCount(bus.get());
+            verifyReadWriteAndAlignment(bus.get());
+
+            // Each channel is padded to a multiple of |alignment| bytes, so with
+            // kCacheLineAlignment no two channels share a cache line.
+            const int stride = int(bus->channel(1) - bus->channel(0)) * sizeof(float);
+            EXPECT_EQ(0, stride % alignment);
+            EXPECT_GE(stride, int(kFrameCount * sizeof(float)));
+            EXPECT_EQ(stride * kChannels,
+                      AudioBus::CalculateMemorySize(kChannels, kFrameCount, alignment));
+        }
+    }
+
+    // Verify wrapping memory honors and validates the requested alignment.
+    TEST_F(AudioBusTest, WrapMemoryWithAlignment) {
+        const int alignment = AudioBus::kCacheLineAlignment;
+        int dataSize = AudioBus::CalculateMemorySize(kChannels, kFrameCount, alignment);
+        std::unique_ptr<float, AlignedFreeDeleter> data(static_cast<float*>(
+                AlignedAlloc(dataSize + alignment, alignment)));
+
+        std::unique_ptr<AudioBus> bus =
+                AudioBus::WrapMemory(kChannels, kFrameCount, data.get(), alignment);
+        EXPECT_EQ(alignment, bus->alignment());
+        verifyChannelAndFrameCount(bus.get());
+        verifyReadWriteAndAlignment(bus.get());
+
+        // A block which is only 16-byte aligned is rejected.
+        EXPECT_DEATH(AudioBus::WrapMemory(kChannels, kFrameCount,
+                                          data.get() + 4, alignment), "");
+    }
+
     // Simulate a shared memory transfer and verify results.
     TEST_F(AudioBusTest, copyTo) {
         // Create one bus with AudioParameters and the other through direct values to
@@ -439,6 +489,137 @@ namespace mm {
                             kTestVectorChannelCount));
     }
 
+    // Fills |values| with random samples covering the whole range of
+    // SampleTypeTraits, including both extremes.
+    template<class SampleTypeTraits>
+    static void fillRandomInterleaved(
+            std::vector<typename SampleTypeTraits::ValueType>* values) {
+        using ValueType = typename SampleTypeTraits::ValueType;
+        std::mt19937 generator(values->size());
+        if constexpr (std::is_floating_point<ValueType>::value) {
+            std::uniform_real_distribution<ValueType> distribution(-1.5, 1.5);
+            for (auto& value : *values)
+                value = distribution(generator);
+        } else {
+            std::uniform_int_distribution<int64_t> distribution(
+                    SampleTypeTraits::kMinValue, SampleTypeTraits::kMaxValue);
+            for (auto& value : *values)
+                value = static_cast<ValueType>(distribution(generator));
+        }
+        (*values)[0] = SampleTypeTraits::kMinValue;
+        (*values)[1] = SampleTypeTraits::kMaxValue;
+    }
+
+    // Verify the optimized mono, stereo, 5.1 and 7.1 paths and the generic path
+    // produce exactly what the scalar SampleTypeTraits conversions produce.
+    template<class SampleTypeTraits>
+    static void verifyInterleaveMatchesTraits() {
+        using ValueType = typename SampleTypeTraits::ValueType;
+        // Not a multiple of the vector width, so the tail is exercised too.
+        static const int kFrames = 37;
+        static const int kOffset = 3;
+
+        for (int channels : {1, 2, 3, 6, 8}) {
+            SCOPED_TRACE(channels);
+            std::vector<ValueType> interleaved(channels * kFrames);
+            fillRandomInterleaved<SampleTypeTraits>(&interleaved);
+
+            std::unique_ptr<AudioBus> bus = AudioBus::Create(channels, kFrames + kOffset);
+            bus->zero();
+            bus->template fromInterleavedPartial<SampleTypeTraits>(
+                    interleaved.data(), kOffset, kFrames);
+            for (int ch = 0; ch < channels; ++ch) {
+                ASSERT_EQ(0.0f, bus->channel(ch)[kOffset - 1]);
+                for (int i = 0; i < kFrames; ++i) {
+                    ASSERT_EQ(SampleTypeTraits::ToFloat(interleaved[i * channels + ch]),
+                              bus->channel(ch)[kOffset + i]) << ch << " " << i;
+                }
+            }
+
+            // Use out of range values for the reverse direction to check clipping.
+            for (int ch = 0; ch < channels; ++ch) {
+                for (int i = 0; i < kFrames + kOffset; ++i)
+                    bus->channel(ch)[i] = 1.5f * std::sin(float(i * channels + ch));
+                bus->channel(ch)[kOffset] = -1.0f;
+                bus->channel(ch)[kOffset + 1] = 1.0f;
+            }
+            std::vector<ValueType> result(channels * kFrames);
+            bus->template toInterleavedPartial<SampleTypeTraits>(kOffset, kFrames,
+                                                                 result.data());
+            for (int i = 0; i < kFrames; ++i) {
+                for (int ch = 0; ch < channels; ++ch) {
+                    ASSERT_EQ(SampleTypeTraits::FromFloat(bus->channel(ch)[kOffset + i]),
+                              result[i * channels + ch]) << ch << " " << i;
+                }
+            }
+        }
+    }
+
+    TEST_F(AudioBusTest, interleaveOptimizedLayouts) {
+        {
+            SCOPED_TRACE("int16_t");
+            verifyInterleaveMatchesTraits<SignedInt16SampleTypeTraits>();
+        }
+        {
+            SCOPED_TRACE("int32_t");
+            verifyInterleaveMatchesTraits<SignedInt32SampleTypeTraits>();
+        }
+        {
+            SCOPED_TRACE("float");
+            verifyInterleaveMatchesTraits<Float32SampleTypeTraits>();
+        }
+        {
+            SCOPED_TRACE("uint8_t");
+            verifyInterleaveMatchesTraits<UnsignedInt8SampleTypeTraits>();
+        }
+    }
+
+    // Same as above for packed 24-bit samples, which can't be compared or
+    // filled like the arithmetic types.
+    TEST_F(AudioBusTest, interleaveOptimizedLayoutsS24Packed) {
+        using Traits = SignedInt24PackedSampleTypeTraits;
+        static const int kFrames = 37;
+        static const int kOffset = 3;
+
+        for (int channels : {1, 2, 3, 6, 8}) {
+            SCOPED_TRACE(channels);
+            std::vector<int32_t> values(channels * kFrames);
+            fillRandomInterleaved<SignedInt24In32SampleTypeTraits>(&values);
+            std::vector<PackedInt24> interleaved(values.size());
+            for (size_t i = 0; i < values.size(); ++i) {
+                const auto bits = static_cast<uint32_t>(values[i]);
+                interleaved[i] = {{uint8_t(bits), uint8_t(bits >> 8), uint8_t(bits >> 16)}};
+            }
+
+            std::unique_ptr<AudioBus> bus = AudioBus::Create(channels, kFrames + kOffset);
+            bus->zero();
+            bus->fromInterleavedPartial<Traits>(interleaved.data(), kOffset, kFrames);
+            for (int ch = 0; ch < channels; ++ch) {
+                for (int i = 0; i < kFrames; ++i) {
+                    ASSERT_EQ(SignedInt24In32SampleTypeTraits::ToFloat(values[i * channels + ch]),
+                              bus->channel(ch)[kOffset + i]) << ch << " " << i;
+                }
+            }
+
+            for (int ch = 0; ch < channels; ++ch) {
+                for (int i = 0; i < kFrames + kOffset; ++i)
+                    bus->channel(ch)[i] = 1.5f * std::sin(float(i * channels + ch));
+                bus->channel(ch)[kOffset] = -1.0f;
+                bus->channel(ch)[kOffset + 1] = 1.0f;
+            }
+            std::vector<PackedInt24> result(channels * kFrames);
+            bus->toInterleavedPartial<Traits>(kOffset, kFrames, result.data());
+            for (int i = 0; i < kFrames; ++i) {
+                for (int ch = 0; ch < channels; ++ch) {
+                    const PackedInt24 expected =
+                            Traits::FromFloat(bus->channel(ch)[kOffset + i]);
+                    ASSERT_EQ(0, memcmp(&expected, &result[i * channels + ch],
+                                        sizeof(expected))) << ch << " " << i;
+                }
+            }
+        }
+    }
+
     struct ZeroingOutTestData {
         static constexpr int kChannelCount = 2;
         static constexpr int kFrameCount = 10;
@@ -565,4 +746,122 @@ namespace mm {
             verifyArrayIsFilledWithValue(bus->channel(i), bus->frames(), 0);
         }
     }
+
+    TEST_F(AudioBusTest, accumulateFrom) {
+        std::unique_ptr<AudioBus> source = AudioBus::Create(kChannels, kFrameCount);
+        std::unique_ptr<AudioBus> dest = AudioBus::Create(kChannels, kFrameCount);
+        for (int i = 0; i < kChannels; i++) {
+            std::fill(source->channel(i), source->channel(i) + kFrameCount, i + 1);
+            std::fill(dest->channel(i), dest->channel(i) + kFrameCount, 0.5f);
+        }
+
+        dest->accumulateFrom(source.get(), 0.25f);
+        for (int i = 0; i < kChannels; i++)
+            verifyArrayIsFilledWithValue(dest->channel(i), kFrameCount,
+                                         0.5f + (i + 1) * 0.25f);
+    }
+
+    TEST_F(AudioBusTest, mixFrom) {
+        const int kSources = 64;
+        std::vector<std::unique_ptr<AudioBus>> buses;
+        std::vector<const AudioBus*> sources;
+        std::vector<float> gains;
+        for (int k = 0; k < kSources; k++) {
+            buses.push_back(AudioBus::Create(kChannels, kFrameCount));
+            for (int i = 0; i < kChannels; i++) {
+                std::fill(buses[k]->channel(i), buses[k]->channel(i) + kFrameCount,
+                          (i + 1) * 0.125f);
+            }
+            sources.push_back(buses[k].get());
+            gains.push_back(k % 2 ? 0.25f : 0.0f);
+        }
+
+        // 32 sources with gain 0.25 contribute 8 * (i + 1) * 0.125.
+        std::unique_ptr<AudioBus> dest = AudioBus::Create(kChannels, kFrameCount);
+        dest->mixFrom(sources, gains);
+        for (int i = 0; i < kChannels; i++)
+            verifyArrayIsFilledWithValue(dest->channel(i), kFrameCount, i + 1);
+
+        dest->mixFrom(sources, gains, true);
+        for (int i = 0; i < kChannels; i++)
+            verifyArrayIsFilledWithValue(dest->channel(i), kFrameCount, 1);
+
+        // Mix on top of the current contents.
+        sources.assign({dest.get(), buses[0].get()});
+        gains.assign({1.0f, -2.0f});
+        dest->mixFrom(sources, gains);
+        for (int i = 0; i < kChannels; i++) {
+            verifyArrayIsFilledWithValue(dest->channel(i), kFrameCount,
+                                         1 - (i + 1) * 0.25f);
+        }
+
+        // Without sources the bus is silent.
+        dest->mixFrom({}, {});
+        EXPECT_TRUE(dest->areFramesZero());
+    }
+
+    TEST_F(AudioBusTest, rampLinear) {
+        std::unique_ptr<AudioBus> bus = AudioBus::Create(kChannels, kFrameCount);
+        for (int i = 0; i < kChannels; i++)
+            std::fill(bus->channel(i), bus->channel(i) + kFrameCount, 1.0f);
+
+        // Two adjacent ramps join without a step; frames outside are untouched.
+        const int kRampFrames = 100;
+        bus->rampLinear(10, kRampFrames, 1.0f, 0.5f);
+        bus->rampLinear(10 + kRampFrames, kRampFrames, 0.5f, 0.0f);
+        for (int i = 0; i < kChannels; i++) {
+            const float* data = bus->channel(i);
+            EXPECT_EQ(1.0f, data[9]);
+            for (int k = 0; k < 2 * kRampFrames; k++)
+                ASSERT_NEAR(1.0f - 0.5f * k / kRampFrames, data[10 + k], 1e-6) << k;
+            EXPECT_EQ(1.0f, data[10 + 2 * kRampFrames]);
+        }
+
+        bus->fadeOut(0, kFrameCount);
+        EXPECT_EQ(1.0f, bus->channel(0)[0]);
+        EXPECT_NEAR(1.0f / kFrameCount, bus->channel(0)[kFrameCount - 1], 1e-6);
+        bus->fadeIn(0, 1);
+        EXPECT_TRUE(AudioBusView(bus.get(), 0, 1).areFramesZero());
+    }
+
+    TEST_F(AudioBusTest, rampExponential) {
+        std::unique_ptr<AudioBus> bus = AudioBus::Create(kChannels, kFrameCount);
+        for (int i = 0; i < kChannels; i++)
+            std::fill(bus->channel(i), bus->channel(i) + kFrameCount, 1.0f);
+
+        // -60 dB to 0 dB: every 1/3 of the ramp adds 20 dB.
+        bus->rampExponential(0, kFrameCount, 0.001f, 1.0f);
+        for (int i = 0; i < kChannels; i++) {
+            const float* data = bus->channel(i);
+            EXPECT_FLOAT_EQ(0.001f, data[0]);
+            for (int k = 0; k < kFrameCount; k++) {
+                const double expected = 0.001 * std::pow(1000.0, double(k) / kFrameCount);
+                ASSERT_NEAR(expected, data[k], expected * 1e-4) << k;
+            }
+        }
+    }
+
+    TEST_F(AudioBusTest, crossfade) {
+        std::unique_ptr<AudioBus> from = AudioBus::Create(kChannels, kFrameCount);
+        std::unique_ptr<AudioBus> to = AudioBus::Create(kChannels, kFrameCount);
+        for (int i = 0; i < kChannels; i++) {
+            std::fill(from->channel(i), from->channel(i) + kFrameCount, 1.0f);
+            std::fill(to->channel(i), to->channel(i) + kFrameCount, -1.0f);
+        }
+
+        // Crossfade in place into |from|, leaving the frames around alone.
+        const int kStart = 8;
+        const int kFrames = kFrameCount - 16;
+        from->crossfade(from.get(), to.get(), kStart, kFrames);
+        for (int i = 0; i < kChannels; i++) {
+            const float* data = from->channel(i);
+            EXPECT_EQ(1.0f, data[kStart - 1]);
+            EXPECT_EQ(1.0f, data[kStart]);
+            EXPECT_EQ(1.0f, data[kStart + kFrames]);
+            for (int k = 0; k < kFrames; k++) {
+                const double angle = std::acos(0.0) * k / kFrames;
+                ASSERT_NEAR(std::cos(angle) - std::sin(angle), data[kStart + k], 1e-5);
+            }
+        }
+    }
 }
@@ -0,0 +1,127 @@
+//
+// Created by wang rl on 2022/7/8.
+//
+
+#include <memory>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "media/base/AudioBusView.h"
+#include "media/base/AudioSampleTypes.h"
+
+namespace mm {
+    static const int kChannels = 2;
+    static const int kFrameCount = 64;
+
+    static std::unique_ptr<AudioBus> CreateRampBus() {
+        std::unique_ptr<AudioBus> bus = AudioBus::Create(kChannels, kFrameCount);
+        for (int ch = 0; ch < kChannels; ++ch) {
+            for (int i = 0; i < kFrameCount; ++i)
+                bus->channel(ch)[i] = (ch + 1) * 0.01f * i;
+        }
+        return bus;
+    }
+
+    // Verify a view addresses the requested sub-range of the bus.
+    TEST(AudioBusViewTest, Construct) {
+        std::unique_ptr<AudioBus> bus = CreateRampBus();
+        AudioBusView all(bus.get());
+        EXPECT_EQ(kChannels, all.channels());
+        EXPECT_EQ(kFrameCount, all.frames());
+        EXPECT_EQ(bus->channel(1), all.channel(1));
+
+        AudioBusView view(bus.get(), 10, 20);
+        EXPECT_EQ(10, view.startFrame());
+        EXPECT_EQ(20, view.frames());
+        EXPECT_EQ(bus->channel(0) + 10, view.channel(0));
+
+        AudioBusView sub = view.subView(5, 10);
+        EXPECT_EQ(15, sub.startFrame());
+        EXPECT_EQ(bus->channel(1) + 15, sub.channel(1));
+
+        EXPECT_EQ(0, view.subView(20, 0).frames());
+        EXPECT_DEATH(view.subView(15, 10), "");
+    }
+
+    // Verify scale() and zeroFramesPartial() only touch the viewed frames.
+    TEST(AudioBusViewTest, ProcessInPlace) {
+        std::unique_ptr<AudioBus> bus = CreateRampBus();
+        std::unique_ptr<AudioBus> expected = CreateRampBus();
+
+        AudioBusView view(bus.get(), 8, 32);
+        view.scale(0.5f);
+        view.zeroFramesPartial(30, 2);
+        for (int ch = 0; ch < kChannels; ++ch) {
+            for (int i = 0; i < kFrameCount; ++i) {
+                float value = expected->channel(ch)[i];
+                if (i >= 38 && i < 40)
+                    value = 0;
+                else if (i >= 8 && i < 40)
+                    value *= 0.5f;
+                ASSERT_FLOAT_EQ(value, bus->channel(ch)[i]) << ch << " " << i;
+            }
+        }
+
+        EXPECT_FALSE(view.areFramesZero());
+        view.zero();
+        EXPECT_TRUE(view.areFramesZero());
+        EXPECT_FALSE(bus->areFramesZero());
+    }
+
+    // Verify buses can be split into and assembled from views without
+    // intermediate buses.
+    TEST(AudioBusViewTest, Copy) {
+        std::unique_ptr<AudioBus> source = CreateRampBus();
+        std::unique_ptr<AudioBus> dest = AudioBus::Create(kChannels, kFrameCount);
+        dest->zero();
+
+        const int kBlockSize = 16;
+        for (int start = 0; start < kFrameCount; start += kBlockSize) {
+            AudioBusView(source.get(), start, kBlockSize)
+                    .copyTo(AudioBusView(dest.get(), kFrameCount - kBlockSize - start,
+                                         kBlockSize));
+        }
+        for (int ch = 0; ch < kChannels; ++ch) {
+            for (int i = 0; i < kFrameCount; ++i) {
+                int block = i / kBlockSize;
+                int mirrored = (kFrameCount / kBlockSize - 1 - block) * kBlockSize +
+                               i % kBlockSize;
+                ASSERT_EQ(source->channel(ch)[mirrored], dest->channel(ch)[i]);
+            }
+        }
+
+        std::unique_ptr<AudioBus> packet = AudioBus::Create(kChannels, 4);
+        for (int ch = 0; ch < kChannels; ++ch)
+            std::fill(packet->channel(ch), packet->channel(ch) + 4, 2.0f);
+        AudioBusView(packet.get()).copyAndClipTo(AudioBusView(dest.get(), 4, 4));
+        packet->copyTo(AudioBusView(dest.get(), 8, 4));
+        for (int ch = 0; ch < kChannels; ++ch) {
+            EXPECT_EQ(1.0f, dest->channel(ch)[4]);
+            EXPECT_EQ(2.0f, dest->channel(ch)[8]);
+        }
+    }
+
+    // Verify interleaving through a view matches interleaving the bus range.
+    TEST(AudioBusViewTest, Interleave) {
+        std::unique_ptr<AudioBus> bus = CreateRampBus();
+        const int kOffset = 3;
+        const int kFrames = 40;
+        std::vector<int16_t> expected(kChannels * kFrames);
+        std::vector<int16_t> actual(kChannels * kFrames);
+        bus->toInterleavedPartial<SignedInt16SampleTypeTraits>(kOffset, kFrames,
+                                                               expected.data());
+        AudioBusView view(bus.get(), kOffset, kFrames);
+        view.toInterleaved<SignedInt16SampleTypeTraits>(kFrames, actual.data());
+        EXPECT_EQ(expected, actual);
+
+        // Write the samples back one frame later, the rest must be zeroed.
+        AudioBusView(bus.get(), kOffset + 1, kFrames + 2)
+                .fromInterleaved<SignedInt16SampleTypeTraits>(actual.data(), kFrames);
+        for (int ch = 0; ch < kChannels; ++ch) {
+            EXPECT_NEAR(bus->channel(ch)[kOffset + 1], (ch + 1) * 0.01f * kOffset,
+                        1.0f / 32767);
+            EXPECT_EQ(0.0f, bus->channel(ch)[kOffset + 1 + kFrames]);
+            EXPECT_EQ(0.0f, bus->channel(ch)[kOffset + 2 + kFrames]);
+        }
+    }
+}
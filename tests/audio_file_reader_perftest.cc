@@ -0,0 +1,71 @@
+//
+// Created by wang rl on 2022/7/6.
+//
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include "media/filters/audio_file_reader.h"
+#include "media/filters/in_memory_url_protocol.h"
+
+namespace mm {
+    static const char kTestFile[] = "res/symphony_fltp_1_22050.mp3";
+    // Packets decoded per Read() call before the caller releases them.
+    static const int kPacketsPerChunk = 32;
+
+    class AudioFileReaderPerfTest : public testing::Test {
+    public:
+        void SetUp() override {
+            if (!std::filesystem::exists(kTestFile))
+                GTEST_SKIP() << kTestFile << " not found, run from the source root";
+            std::ifstream ifs(kTestFile, std::ios::binary);
+            data_.assign(std::istreambuf_iterator<char>(ifs),
+                         std::istreambuf_iterator<char>());
+        }
+
+        // Decodes the whole file and returns the decoded frame count.
+        template<typename ReadChunk>
+        int DecodeFile(ReadChunk read_chunk) {
+            InMemoryUrlProtocol protocol(data_.data(), int64_t(data_.size()), false);
+            AudioFileReader reader(&protocol);
+            EXPECT_TRUE(reader.Open());
+            int total_frames = 0;
+            int frames = 0;
+            while ((frames = read_chunk(&reader)) > 0)
+                total_frames += frames;
+            return total_frames;
+        }
+
+    protected:
+        std::vector<uint8_t> data_;
+    };
+
+    TEST_F(AudioFileReaderPerfTest, PooledRead) {
+        int64_t allocations = 0;
+        auto start = std::chrono::steady_clock::now();
+        const int frames = DecodeFile([&allocations](AudioFileReader* reader) {
+            std::vector<std::unique_ptr<AudioBus>> packets;
+            int read = reader->Read(&packets, kPacketsPerChunk);
+            allocations += int64_t(packets.size());
+            return read;
+        });
+        std::chrono::duration<double> unpooled = std::chrono::steady_clock::now() - start;
+
+        AudioBusPool pool;
+        start = std::chrono::steady_clock::now();
+        const int pooled_frames = DecodeFile([&pool](AudioFileReader* reader) {
+            std::vector<AudioBusPool::ScopedAudioBus> packets;
+            return reader->Read(&packets, &pool, kPacketsPerChunk);
+        });
+        std::chrono::duration<double> pooled = std::chrono::steady_clock::now() - start;
+
+        EXPECT_EQ(frames, pooled_frames);
+        printf("AudioFileReader::Read   %8.1f Mframes/s, %lld AudioBus allocations\n",
+               frames / unpooled.count() / 1e6, static_cast<long long>(allocations));
+        printf("pooled Read             %8.1f Mframes/s, %lld AudioBus allocations, "
+               "%lld reuses\n", pooled_frames / pooled.count() / 1e6,
+               static_cast<long long>(pool.allocations()),
+               static_cast<long long>(pool.reuses()));
+    }
+}
@@ -2,11 +2,10 @@
 // Created by WangRuiLing on 2022/6/21.
 //
 
-#include <filesystem>
-#include <fstream>
 #include <gtest/gtest.h>
+#include "media/base/AudioBusView.h"
 #include "media/filters/audio_file_reader.h"
-#include "media/filters/in_memory_url_protocol.h"
+#include "media/filters/mmap_url_protocol.h"
 
 namespace mm {
     class AudioFileReaderTest : public testing::Test {
@@ -20,16 +19,9 @@ namespace mm {
         ~AudioFileReaderTest() override = default;
 
         void Initialize(const char* filename) {
-            // 将文件读入到内存中
-            size_ = std::filesystem::file_size(filename);
-            auto* data = (uint8_t*)calloc(size_, sizeof(uint8_t));
-            std::ifstream ifs;
-            ifs.open(filename, std::ios::binary);
-            ifs.read((char*)data, size_);
-            ifs.close();
-            data_ = std::unique_ptr<uint8_t[]>(data);
-            protocol_ = std::make_unique<InMemoryUrlProtocol>(
-                    data_.get(), size_, false);
+            // 将文件映射到内存中，不需要预先读入整个文件
+            protocol_ = MmapUrlProtocol::Open(filename);
+            ASSERT_TRUE(protocol_) << "Couldn't map " << filename;
             reader_ = std::make_unique<AudioFileReader>(protocol_.get());
         }
 
@@ -43,8 +35,8 @@ namespace mm {
             for (size_t k = 0; k < decoded_audio_packets.size(); ++k) {
                 const AudioBus* packet = decoded_audio_packets[k].get();
                 int frame_count = packet->frames();
-                packet->copyPartialFramesTo(0, frame_count, dest_start_frame,
-                                            decoded_audio_data.get());
+                packet->copyTo(AudioBusView(decoded_audio_data.get(),
+                                            dest_start_frame, frame_count));
                 dest_start_frame += frame_count;
             }
             ASSERT_LE(actual_frames, decoded_audio_data->frames());
@@ -57,10 +49,7 @@ namespace mm {
         }
 
     protected:
-        std::unique_ptr<uint8_t[]> data_;
-        // Size of the encoded data.
-        size_t size_;
-        std::unique_ptr<InMemoryUrlProtocol> protocol_;
+        std::unique_ptr<MmapUrlProtocol> protocol_;
         std::unique_ptr<AudioFileReader> reader_;
         bool packet_verification_disabled_;
     };
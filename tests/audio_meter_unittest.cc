@@ -0,0 +1,82 @@
+//
+// Created by wang rl on 2022/7/11.
+//
+
+#include <cmath>
+#include <memory>
+#include <gtest/gtest.h>
+
+#include "media/base/AudioMeter.h"
+
+namespace mm {
+    static const int kChannels = 2;
+    static const int kFrameCount = 4800;
+
+    // Fills channel 0 with a full scale sine of 100 frames period plus |dc| and
+    // channel 1 with a constant |dc|.
+    static void FillBus(AudioBus* bus, float dc) {
+        for (int i = 0; i < bus->frames(); ++i) {
+            bus->channel(0)[i] = float(std::sin(2 * M_PI * i / 100.0)) + dc;
+            bus->channel(1)[i] = dc;
+        }
+    }
+
+    // Verify the levels of known signals.
+    TEST(AudioMeterTest, Levels) {
+        std::unique_ptr<AudioBus> bus = AudioBus::Create(kChannels, kFrameCount);
+        FillBus(bus.get(), 0.0f);
+        bus->channel(1)[10] = -1.0f;
+
+        AudioMeter meter(kChannels);
+        EXPECT_EQ(0.0f, meter.levels(0).rms);
+        meter.update(bus.get());
+        EXPECT_EQ(kFrameCount, meter.frames());
+
+        const AudioMeter::Levels sine = meter.levels(0);
+        EXPECT_NEAR(1.0f, sine.peak, 1e-6);
+        EXPECT_NEAR(1.0 / std::sqrt(2.0), sine.rms, 1e-5);
+        EXPECT_NEAR(0.0f, sine.dcOffset, 1e-6);
+        // sin() reaches 1 only at a quarter period.
+        EXPECT_EQ(2 * kFrameCount / 100, sine.clippedSamples);
+
+        const AudioMeter::Levels impulse = meter.levels(1);
+        EXPECT_EQ(1.0f, impulse.peak);
+        EXPECT_NEAR(std::sqrt(1.0 / kFrameCount), impulse.rms, 1e-6);
+        EXPECT_NEAR(-1.0 / kFrameCount, impulse.dcOffset, 1e-7);
+        EXPECT_EQ(1, impulse.clippedSamples);
+
+        EXPECT_EQ(1.0f, meter.peak());
+        EXPECT_EQ(sine.clippedSamples + 1, meter.clippedSamples());
+    }
+
+    // Verify updating block by block gives the levels of the whole stream.
+    TEST(AudioMeterTest, Streaming) {
+        std::unique_ptr<AudioBus> bus = AudioBus::Create(kChannels, kFrameCount);
+        FillBus(bus.get(), 0.25f);
+
+        AudioMeter whole(kChannels, 0.5f);
+        whole.update(bus.get());
+
+        AudioMeter blocks(kChannels, 0.5f);
+        AudioBusView view(bus.get());
+        for (int offset = 0; offset < kFrameCount; offset += 333)
+            blocks.update(view.subView(offset, std::min(333, kFrameCount - offset)));
+        EXPECT_EQ(kFrameCount, blocks.frames());
+
+        for (int ch = 0; ch < kChannels; ++ch) {
+            const AudioMeter::Levels expected = whole.levels(ch);
+            const AudioMeter::Levels levels = blocks.levels(ch);
+            EXPECT_EQ(expected.peak, levels.peak);
+            EXPECT_NEAR(expected.rms, levels.rms, 1e-6);
+            EXPECT_NEAR(0.25f, levels.dcOffset, 1e-5);
+            EXPECT_EQ(expected.clippedSamples, levels.clippedSamples);
+        }
+        EXPECT_GT(blocks.levels(0).clippedSamples, 0);
+        EXPECT_EQ(0, blocks.levels(1).clippedSamples);
+
+        blocks.reset();
+        EXPECT_EQ(0, blocks.frames());
+        EXPECT_EQ(0.0f, blocks.peak());
+        EXPECT_EQ(0, blocks.clippedSamples());
+    }
+}
@@ -0,0 +1,201 @@
+//
+// Created by wang rl on 2022/7/13.
+//
+
+#include <cstring>
+#include <limits>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "media/base/AudioInterleave.h"
+#include "media/base/AudioSampleTypes.h"
+
+namespace mm {
+    // Float inputs covering the clipping boundaries, values just inside and
+    // outside of them, denormals and a dense sweep of the valid range. The
+    // odd count leaves a tail for the scalar code of the array versions.
+    static std::vector<float> MakeFloatInputs() {
+        std::vector<float> inputs = {
+                -2.0f, -1.0f, 1.0f, 2.0f, 0.0f, -0.0f,
+                std::nextafter(-1.0f, 0.0f), std::nextafter(1.0f, 0.0f),
+                std::nextafter(-1.0f, -2.0f), std::nextafter(1.0f, 2.0f),
+                std::numeric_limits<float>::denorm_min(),
+                -std::numeric_limits<float>::denorm_min(),
+                std::numeric_limits<float>::infinity(),
+                -std::numeric_limits<float>::infinity()};
+        for (int i = -100003; i <= 100003; ++i)
+            inputs.push_back(float(i) / 100000.0f);
+        return inputs;
+    }
+
+    template<class SampleTypeTraits>
+    static void VerifyFromFloatArray(const std::vector<float>& inputs) {
+        using ValueType = typename SampleTypeTraits::ValueType;
+        // Check every offset, so vectorized code sees unaligned arrays as well.
+        for (int offset = 0; offset < 4; ++offset) {
+            const int count = int(inputs.size()) - offset;
+            std::vector<ValueType> expected(count);
+            for (int i = 0; i < count; ++i)
+                expected[i] = SampleTypeTraits::FromFloat(inputs[offset + i]);
+
+            std::vector<ValueType> actual(count);
+            SampleTypeTraits::FromFloatArray(inputs.data() + offset, count,
+                                             actual.data());
+            ASSERT_EQ(0, memcmp(expected.data(), actual.data(),
+                                sizeof(ValueType) * count)) << offset;
+        }
+    }
+
+    template<class SampleTypeTraits>
+    static void VerifyToFloatArray(
+            const std::vector<typename SampleTypeTraits::ValueType>& inputs) {
+        for (int offset = 0; offset < 4; ++offset) {
+            const int count = int(inputs.size()) - offset;
+            std::vector<float> expected(count);
+            for (int i = 0; i < count; ++i)
+                expected[i] = SampleTypeTraits::ToFloat(inputs[offset + i]);
+
+            std::vector<float> actual(count);
+            SampleTypeTraits::ToFloatArray(inputs.data() + offset, count,
+                                           actual.data());
+            ASSERT_EQ(0, memcmp(expected.data(), actual.data(),
+                                sizeof(float) * count)) << offset;
+        }
+    }
+
+    // Every value of the narrow integer types, plus padding for the offsets.
+    template<typename SampleType>
+    static std::vector<SampleType> MakeAllValues() {
+        std::vector<SampleType> values;
+        for (int value = std::numeric_limits<SampleType>::min();
+             value <= std::numeric_limits<SampleType>::max(); ++value) {
+            values.push_back(SampleType(value));
+        }
+        values.insert(values.end(), {0, 1, 2});
+        return values;
+    }
+
+    // Verify the array conversions are bit-exact with the scalar ones.
+    TEST(AudioSampleTypesTest, FromFloatArray) {
+        const std::vector<float> inputs = MakeFloatInputs();
+        VerifyFromFloatArray<UnsignedInt8SampleTypeTraits>(inputs);
+        VerifyFromFloatArray<SignedInt16SampleTypeTraits>(inputs);
+        VerifyFromFloatArray<SignedInt32SampleTypeTraits>(inputs);
+        VerifyFromFloatArray<SignedInt24PackedSampleTypeTraits>(inputs);
+        VerifyFromFloatArray<SignedInt24In32SampleTypeTraits>(inputs);
+        VerifyFromFloatArray<Float32SampleTypeTraitsNoClip>(inputs);
+
+        // The float formats map NaN to -1 as well.
+        std::vector<float> withNaN = inputs;
+        withNaN.push_back(std::numeric_limits<float>::quiet_NaN());
+        withNaN.push_back(0.5f);
+        VerifyFromFloatArray<Float32SampleTypeTraits>(withNaN);
+        VerifyFromFloatArray<Float64SampleTypeTraits>(withNaN);
+    }
+
+    // The packed and sign-extended s24 formats hold the same values, and the
+    // scaling is that of a 24-bit FixedSampleTypeTraits.
+    TEST(AudioSampleTypesTest, SignedInt24) {
+        using Packed = SignedInt24PackedSampleTypeTraits;
+        using In32 = SignedInt24In32SampleTypeTraits;
+        EXPECT_EQ(-8388608, In32::FromFloat(-1.0f));
+        EXPECT_EQ(8388607, In32::FromFloat(1.0f));
+        EXPECT_EQ(-8388608, In32::FromFloat(-2.0f));
+        EXPECT_EQ(8388607, In32::FromFloat(2.0f));
+        EXPECT_EQ(0, In32::FromFloat(0.0f));
+        EXPECT_EQ(-1.0f, In32::ToFloat(-8388608));
+        EXPECT_EQ(1.0f, In32::ToFloat(8388607));
+
+        const PackedInt24 min = Packed::FromFloat(-1.0f);
+        EXPECT_EQ(0x00, min.bytes[0]);
+        EXPECT_EQ(0x00, min.bytes[1]);
+        EXPECT_EQ(0x80, min.bytes[2]);
+        const PackedInt24 minusOne = {{0xff, 0xff, 0xff}};
+        EXPECT_EQ(In32::ToFloat(-1), Packed::ToFloat(minusOne));
+        EXPECT_EQ(-1.0, Packed::ToDouble(min));
+
+        const std::vector<float> inputs = MakeFloatInputs();
+        for (float input : inputs) {
+            const PackedInt24 packed = Packed::FromFloat(input);
+            const int32_t value = In32::FromFloat(input);
+            ASSERT_EQ(value & 0xff, packed.bytes[0]) << input;
+            ASSERT_EQ((value >> 8) & 0xff, packed.bytes[1]) << input;
+            ASSERT_EQ((value >> 16) & 0xff, packed.bytes[2]) << input;
+        }
+    }
+
+    // Deinterleaves |interleaved| and interleaves the result again through the
+    // audio_interleave::Kernels of |SampleTypeTraits| and compares both steps
+    // with the scalar conversions. The odd frame count leaves a scalar tail.
+    template<class SampleTypeTraits>
+    static void VerifyInterleave(const std::vector<float>& inputs) {
+        using ValueType = typename SampleTypeTraits::ValueType;
+        using Kernels = audio_interleave::Kernels<SampleTypeTraits>;
+        for (int channels : {1, 2, 6, 8}) {
+            SCOPED_TRACE(channels);
+            const int frames = int(inputs.size()) / channels;
+            std::vector<ValueType> interleaved(size_t(frames) * channels);
+            for (size_t i = 0; i < interleaved.size(); ++i)
+                interleaved[i] = SampleTypeTraits::FromFloat(inputs[i]);
+
+            std::vector<std::vector<float>> planes(channels, std::vector<float>(frames));
+            std::vector<float*> dest;
+            for (auto& plane : planes)
+                dest.push_back(plane.data());
+            if (!Kernels::Deinterleave(interleaved.data(), channels, frames, dest.data(), 0))
+                continue;
+            for (int frame = 0; frame < frames; ++frame) {
+                for (int ch = 0; ch < channels; ++ch) {
+                    ASSERT_EQ(SampleTypeTraits::ToFloat(interleaved[frame * channels + ch]),
+                              planes[ch][frame]) << frame << " " << ch;
+                }
+            }
+
+            // Back from the original floats, which include out of range values.
+            for (int frame = 0; frame < frames; ++frame) {
+                for (int ch = 0; ch < channels; ++ch)
+                    planes[ch][frame] = inputs[frame * channels + ch];
+            }
+            std::vector<ValueType> actual(interleaved.size());
+            ASSERT_TRUE(Kernels::Interleave(dest.data(), 0, channels, frames, actual.data()));
+            ASSERT_EQ(0, memcmp(interleaved.data(), actual.data(),
+                                sizeof(ValueType) * actual.size()));
+        }
+    }
+
+    // The multichannel kernels of both s24 layouts are bit-exact with the
+    // scalar conversions.
+    TEST(AudioSampleTypesTest, InterleaveSignedInt24) {
+        const std::vector<float> inputs = MakeFloatInputs();
+        VerifyInterleave<SignedInt24PackedSampleTypeTraits>(inputs);
+        VerifyInterleave<SignedInt24In32SampleTypeTraits>(inputs);
+    }
+
+    TEST(AudioSampleTypesTest, ToFloatArray) {
+        VerifyToFloatArray<UnsignedInt8SampleTypeTraits>(MakeAllValues<uint8_t>());
+        VerifyToFloatArray<SignedInt16SampleTypeTraits>(MakeAllValues<int16_t>());
+
+        std::vector<int32_t> s32 = {std::numeric_limits<int32_t>::min(),
+                                    std::numeric_limits<int32_t>::max(), 0, -1, 1};
+        for (int i = 0; i < 100003; ++i)
+            s32.push_back(int32_t(uint32_t(i) * 2654435761u));
+        VerifyToFloatArray<SignedInt32SampleTypeTraits>(s32);
+
+        // Every 24-bit value, packed and sign-extended.
+        std::vector<PackedInt24> s24;
+        std::vector<int32_t> s24In32;
+        for (int32_t value = SignedInt24In32SampleTypeTraits::kMinValue;
+             value <= SignedInt24In32SampleTypeTraits::kMaxValue; ++value) {
+            const auto bits = static_cast<uint32_t>(value);
+            s24.push_back({{uint8_t(bits), uint8_t(bits >> 8), uint8_t(bits >> 16)}});
+            s24In32.push_back(value);
+        }
+        VerifyToFloatArray<SignedInt24PackedSampleTypeTraits>(s24);
+        VerifyToFloatArray<SignedInt24In32SampleTypeTraits>(s24In32);
+
+        const std::vector<float> inputs = MakeFloatInputs();
+        VerifyToFloatArray<Float32SampleTypeTraits>(inputs);
+        VerifyToFloatArray<Float64SampleTypeTraits>(
+                std::vector<double>(inputs.begin(), inputs.end()));
+    }
+}
@@ -0,0 +1,160 @@
+//
+// Created by wang rl on 2022/7/14.
+//
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <gtest/gtest.h>
+
+#include "media/base/AudioBus.h"
+#include "media/base/AudioBusView.h"
+#include "media/base/CompactAudioBus.h"
+
+namespace mm {
+    static const int kChannels = 2;
+    // Not a multiple of the block size, so the last block is partial.
+    static const int kFrameCount = CompactAudioBus::kBlockFrames * 4 + 37;
+
+    // Fills |bus| with a sine whose amplitude changes per block, down to a
+    // very quiet one, and one silent block.
+    static void FillTestSignal(AudioBus* bus) {
+        for (int ch = 0; ch < bus->channels(); ++ch) {
+            for (int i = 0; i < bus->frames(); ++i) {
+                const int block = i / CompactAudioBus::kBlockFrames;
+                const float amplitude = block == 2 ? 0.0f : std::pow(0.01f, float(block));
+                bus->channel(ch)[i] = amplitude * std::sin(0.05f * float(i) + float(ch));
+            }
+        }
+    }
+
+    // Every sample is within half the scale of its block.
+    static void VerifyExpansion(const CompactAudioBus* compact, const AudioBus* expected,
+                                int startFrame, const AudioBusView& actual) {
+        for (int ch = 0; ch < actual.channels(); ++ch) {
+            for (int i = 0; i < actual.frames(); ++i) {
+                const int frame = startFrame + i;
+                const float scale =
+                        compact->blockScale(ch, frame / CompactAudioBus::kBlockFrames);
+                ASSERT_NEAR(expected->channel(ch)[frame], actual.channel(ch)[i],
+                            scale * 0.5f) << ch << " " << frame;
+            }
+        }
+    }
+
+    TEST(CompactAudioBusTest, Create) {
+        std::unique_ptr<CompactAudioBus> compact =
+                CompactAudioBus::Create(kChannels, kFrameCount);
+        EXPECT_EQ(kChannels, compact->channels());
+        EXPECT_EQ(kFrameCount, compact->frames());
+        // Half of the float samples, plus one scale per block.
+        EXPECT_EQ(size_t(kChannels) * 5 * (CompactAudioBus::kBlockFrames * 2 + 4),
+                  compact->memorySize());
+        // About half of an AudioBus for a second of audio.
+        EXPECT_LT(CompactAudioBus::CalculateMemorySize(kChannels, 48000),
+                  size_t(AudioBus::CalculateMemorySize(kChannels, 48000)) * 51 / 100);
+
+        std::unique_ptr<AudioBus> bus = AudioBus::Create(kChannels, kFrameCount);
+        FillTestSignal(bus.get());
+        compact->toAudioBus(0, bus.get());
+        EXPECT_TRUE(bus->areFramesZero());
+    }
+
+    TEST(CompactAudioBusTest, RoundTrip) {
+        std::unique_ptr<AudioBus> bus = AudioBus::Create(kChannels, kFrameCount);
+        FillTestSignal(bus.get());
+        std::unique_ptr<CompactAudioBus> compact =
+                CompactAudioBus::Create(kChannels, kFrameCount);
+        compact->fromAudioBus(bus.get());
+
+        // The scale follows the block peak, so quiet blocks keep their precision.
+        EXPECT_NEAR(1.0f / 32767.0f, compact->blockScale(0, 0), 1e-7f);
+        EXPECT_LT(compact->blockScale(0, 1), 1e-6f);
+        EXPECT_EQ(0.0f, compact->blockScale(1, 2));
+
+        std::unique_ptr<AudioBus> result = AudioBus::Create(kChannels, kFrameCount);
+        compact->toAudioBus(0, result.get());
+        VerifyExpansion(compact.get(), bus.get(), 0, AudioBusView(result.get()));
+        for (int i = 0; i < CompactAudioBus::kBlockFrames; ++i)
+            ASSERT_EQ(0.0f, result->channel(1)[2 * CompactAudioBus::kBlockFrames + i]);
+
+        // Expanding a range which starts and ends inside of blocks.
+        std::unique_ptr<AudioBus> partial = AudioBus::Create(kChannels, 300);
+        compact->toAudioBus(100, partial.get());
+        VerifyExpansion(compact.get(), bus.get(), 100, AudioBusView(partial.get()));
+        EXPECT_EQ(result->channel(0)[250], partial->channel(0)[150]);
+    }
+
+    // Blocks can be compacted one at a time, e.g. while decoding.
+    TEST(CompactAudioBusTest, FromAudioBusAtOffset) {
+        std::unique_ptr<AudioBus> bus = AudioBus::Create(kChannels, kFrameCount);
+        FillTestSignal(bus.get());
+        std::unique_ptr<CompactAudioBus> compact =
+                CompactAudioBus::Create(kChannels, kFrameCount);
+        for (int frame = 0; frame < kFrameCount; frame += CompactAudioBus::kBlockFrames) {
+            const int frames = std::min(CompactAudioBus::kBlockFrames, kFrameCount - frame);
+            compact->fromAudioBus(AudioBusView(bus.get(), frame, frames), frame);
+        }
+
+        std::unique_ptr<CompactAudioBus> whole =
+                CompactAudioBus::Create(kChannels, kFrameCount);
+        whole->fromAudioBus(bus.get());
+        for (int ch = 0; ch < kChannels; ++ch) {
+            EXPECT_EQ(0, memcmp(whole->channel(ch), compact->channel(ch),
+                                sizeof(int16_t) * kFrameCount));
+        }
+
+        // A short write zeroes the rest of its block.
+        compact->fromAudioBus(AudioBusView(bus.get(), 0, 10), 0);
+        EXPECT_NE(0, compact->channel(0)[9]);
+        for (int i = 10; i < CompactAudioBus::kBlockFrames; ++i)
+            ASSERT_EQ(0, compact->channel(0)[i]);
+        EXPECT_EQ(whole->channel(0)[CompactAudioBus::kBlockFrames],
+                  compact->channel(0)[CompactAudioBus::kBlockFrames]);
+    }
+
+    // Blocks too quiet for their inverse scale to be finite, i.e. denormal or
+    // tiny peaks, come back as silence rather than full scale samples.
+    TEST(CompactAudioBusTest, RoundTripDenormals) {
+        const float denormal = std::numeric_limits<float>::denorm_min() * 1000;
+        ASSERT_LT(denormal, std::numeric_limits<float>::min());
+        std::unique_ptr<AudioBus> bus = AudioBus::Create(kChannels, kFrameCount);
+        for (int i = 0; i < kFrameCount; ++i) {
+            const int block = i / CompactAudioBus::kBlockFrames;
+            // Denormals only; denormals mixed with zeros and of both signs;
+            // 1e-40f; a normal but tiny peak; a sine for reference.
+            float value = 0.5f * std::sin(0.05f * float(i));
+            if (block == 0)
+                value = denormal;
+            else if (block == 1)
+                value = i % 3 == 0 ? 0.0f : (i % 2 ? denormal : -denormal);
+            else if (block == 2)
+                value = 1e-40f;
+            else if (block == 3)
+                value = i % 2 ? 1e-36f : 0.0f;
+            bus->channel(0)[i] = value;
+            bus->channel(1)[i] = -value;
+        }
+        std::unique_ptr<CompactAudioBus> compact =
+                CompactAudioBus::Create(kChannels, kFrameCount);
+        compact->fromAudioBus(bus.get());
+
+        std::unique_ptr<AudioBus> result = AudioBus::Create(kChannels, kFrameCount);
+        compact->toAudioBus(0, result.get());
+        for (int ch = 0; ch < kChannels; ++ch) {
+            for (int block = 0; block < 4; ++block) {
+                EXPECT_EQ(0.0f, compact->blockScale(ch, block));
+                for (int i = 0; i < CompactAudioBus::kBlockFrames; ++i) {
+                    const int frame = block * CompactAudioBus::kBlockFrames + i;
+                    ASSERT_EQ(0, compact->channel(ch)[frame]) << ch << " " << frame;
+                    ASSERT_EQ(0.0f, result->channel(ch)[frame]) << ch << " " << frame;
+                }
+            }
+        }
+        const int start = 4 * CompactAudioBus::kBlockFrames;
+        VerifyExpansion(compact.get(), bus.get(), start,
+                        AudioBusView(result.get(), start, kFrameCount - start));
+    }
+}
@@ -0,0 +1,91 @@
+//
+// Created by wang rl on 2022/7/10.
+//
+
+#include <algorithm>
+#include <memory>
+#include <gtest/gtest.h>
+
+#include "media/ffmpeg/ffmpeg_audio_bus.h"
+
+namespace mm {
+    static const int kChannels = 2;
+    static const int kFrameCount = 1024;
+
+    static std::unique_ptr<AVFrame, ScopedPtrAVFreeFrame> CreateFrame(
+            AVSampleFormat format) {
+        std::unique_ptr<AVFrame, ScopedPtrAVFreeFrame> frame(av_frame_alloc());
+        frame->format = format;
+        frame->nb_samples = kFrameCount;
+        frame->channels = kChannels;
+        frame->channel_layout = AV_CH_LAYOUT_STEREO;
+        frame->sample_rate = 44100;
+        EXPECT_EQ(0, av_frame_get_buffer(frame.get(), 0));
+        return frame;
+    }
+
+    // Verify the bus points into the frame and keeps it alive after the
+    // decoder released its reference.
+    TEST(FFmpegAudioBusTest, WrapsPlanes) {
+        std::unique_ptr<AVFrame, ScopedPtrAVFreeFrame> frame =
+                CreateFrame(AV_SAMPLE_FMT_FLTP);
+        for (int ch = 0; ch < kChannels; ++ch) {
+            auto* data = reinterpret_cast<float*>(frame->extended_data[ch]);
+            std::fill(data, data + kFrameCount, ch + 0.5f);
+        }
+
+        std::unique_ptr<FFmpegAudioBus> bus =
+                FFmpegAudioBus::Wrap(frame.get(), kFrameCount - 10);
+        ASSERT_TRUE(bus);
+        EXPECT_EQ(kChannels, bus->channels());
+        EXPECT_EQ(kFrameCount - 10, bus->frames());
+        for (int ch = 0; ch < kChannels; ++ch)
+            EXPECT_EQ(reinterpret_cast<float*>(frame->extended_data[ch]), bus->channel(ch));
+
+        // Drop the original reference, like AudioFileReader does after each frame.
+        frame.reset();
+        for (int ch = 0; ch < kChannels; ++ch) {
+            for (int i = 0; i < bus->frames(); ++i)
+                ASSERT_EQ(ch + 0.5f, bus->channel(ch)[i]);
+        }
+        bus->scale(2);
+        EXPECT_EQ(3.0f, bus->channel(1)[0]);
+    }
+
+    // Verify the referenced frame buffers are counted as decoder memory until
+    // the bus is destroyed.
+    TEST(FFmpegAudioBusTest, CountsFrameBuffers) {
+        std::unique_ptr<AVFrame, ScopedPtrAVFreeFrame> frame =
+                CreateFrame(AV_SAMPLE_FMT_FLTP);
+        size_t size = 0;
+        for (const AVBufferRef* buf : frame->buf) {
+            if (buf)
+                size += size_t(buf->size);
+        }
+        ASSERT_GT(size, 0U);
+
+        const MemoryStats before = GetMemoryStats(MemoryTag::kDecoder);
+        std::unique_ptr<FFmpegAudioBus> bus = FFmpegAudioBus::Wrap(frame.get(), kFrameCount);
+        ASSERT_TRUE(bus);
+        EXPECT_EQ(size, bus->memorySize());
+        EXPECT_EQ(before.current_bytes + int64_t(size),
+                  GetMemoryStats(MemoryTag::kDecoder).current_bytes);
+
+        frame.reset();
+        bus.reset();
+        EXPECT_EQ(before.current_bytes, GetMemoryStats(MemoryTag::kDecoder).current_bytes);
+    }
+
+    // Verify frames which can't be wrapped are rejected.
+    TEST(FFmpegAudioBusTest, RejectsUnsupportedFrames) {
+        std::unique_ptr<AVFrame, ScopedPtrAVFreeFrame> interleaved =
+                CreateFrame(AV_SAMPLE_FMT_FLT);
+        EXPECT_FALSE(FFmpegAudioBus::Wrap(interleaved.get(), kFrameCount));
+
+        std::unique_ptr<AVFrame, ScopedPtrAVFreeFrame> planar =
+                CreateFrame(AV_SAMPLE_FMT_FLTP);
+        EXPECT_FALSE(FFmpegAudioBus::Wrap(planar.get(), kFrameCount + 1));
+        EXPECT_FALSE(FFmpegAudioBus::Wrap(planar.get(), 0));
+        EXPECT_TRUE(FFmpegAudioBus::Wrap(planar.get(), kFrameCount));
+    }
+}
@@ -0,0 +1,155 @@
+//
+// Created by wang rl on 2022/7/20.
+//
+
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <gtest/gtest.h>
+#include "media/ffmpeg/ffmpeg_deleters.h"
+#include "media/filters/ffmpeg_glue.h"
+#include "media/filters/in_memory_url_protocol.h"
+#include "media/filters/mmap_url_protocol.h"
+
+namespace mm {
+    static const char kResDir[] = "res";
+    // Times every file is demuxed per buffer size.
+    static const int kIterations = 20;
+
+    // Forwards to an InMemoryUrlProtocol and counts the bytes it copies. Reads
+    // into the AVIO buffer are staged, AVIO copies them once more on their way
+    // to the packets.
+    class CopyCountingProtocol : public FFmpegURLProtocol {
+    public:
+        explicit CopyCountingProtocol(InMemoryUrlProtocol* protocol) : protocol_(protocol) {}
+
+        void set_avio_context(const AVIOContext* avio_context) { avio_context_ = avio_context; }
+
+        int Read(int size, uint8_t* data) override {
+            const int result = protocol_->Read(size, data);
+            if (result > 0) {
+                copied_bytes_ += result;
+                if (data >= avio_context_->buffer &&
+                    data < avio_context_->buffer + avio_context_->buffer_size)
+                    staged_bytes_ += result;
+            }
+            return result;
+        }
+
+        bool GetPosition(int64_t* position_out) override {
+            return protocol_->GetPosition(position_out);
+        }
+
+        bool SetPosition(int64_t position) override { return protocol_->SetPosition(position); }
+
+        bool GetSize(int64_t* size_out) override { return protocol_->GetSize(size_out); }
+
+        int PreferredBufferSize() const override { return protocol_->PreferredBufferSize(); }
+
+        bool PrefersDirectReads() const override { return protocol_->PrefersDirectReads(); }
+
+        // Bytes copied by the protocol and then by AVIO out of its buffer.
+        int64_t total_copied_bytes() const { return copied_bytes_ + staged_bytes_; }
+
+    private:
+        InMemoryUrlProtocol* protocol_;
+        const AVIOContext* avio_context_ = nullptr;
+        int64_t copied_bytes_ = 0;
+        int64_t staged_bytes_ = 0;
+    };
+
+    // Demuxes the files in res/ with a range of AVIO buffer sizes and reports
+    // the throughput in MB of container data per second.
+    TEST(FFmpegGluePerfTest, BufferSize) {
+        if (!std::filesystem::exists(kResDir))
+            GTEST_SKIP() << kResDir << " not found, run from the source root";
+
+        for (const auto& entry : std::filesystem::directory_iterator(kResDir)) {
+            auto file = std::make_shared<MemoryMappedFile>();
+            if (!entry.is_regular_file() || !file->Initialize(entry.path().string()))
+                continue;
+
+            // 0 is the size preferred by the protocol.
+            bool printed_header = false;
+            for (int buffer_size : {0, 4 * 1024, 16 * 1024, 32 * 1024, 64 * 1024,
+                                    256 * 1024, 1024 * 1024}) {
+                int64_t packets = 0;
+                int effective_size = 0;
+                bool opened = true;
+                auto start = std::chrono::steady_clock::now();
+                for (int i = 0; i < kIterations && opened; ++i) {
+                    MmapUrlProtocol protocol(file, false);
+                    FFmpegGlue glue(&protocol, buffer_size);
+                    effective_size = glue.buffer_size();
+                    opened = glue.OpenContext();
+                    std::unique_ptr<AVPacket, ScopedPtrAVFreePacket> packet(av_packet_alloc());
+                    while (opened && av_read_frame(glue.format_context(), packet.get()) >= 0) {
+                        ++packets;
+                        av_packet_unref(packet.get());
+                    }
+                }
+                std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+                // Files FFmpeg can't probe, e.g. raw PCM, are skipped.
+                if (!opened)
+                    break;
+
+                if (!printed_header) {
+                    printf("%s (%zu bytes)\n", entry.path().filename().string().c_str(),
+                           file->length());
+                    printed_header = true;
+                }
+                printf("  buffer %8d%s %8.1f MB/s, %lld packets\n", effective_size,
+                       buffer_size ? "          " : " (default)",
+                       double(file->length()) * kIterations / elapsed.count() / 1e6,
+                       static_cast<long long>(packets / kIterations));
+            }
+        }
+    }
+
+    // Demuxes the files in res/ from memory, staged through the AVIO buffer and
+    // in direct mode, and reports the bytes copied per second of audio.
+    TEST(FFmpegGluePerfTest, DirectReads) {
+        if (!std::filesystem::exists(kResDir))
+            GTEST_SKIP() << kResDir << " not found, run from the source root";
+
+        for (const auto& entry : std::filesystem::directory_iterator(kResDir)) {
+            MemoryMappedFile file;
+            if (!entry.is_regular_file() || !file.Initialize(entry.path().string()))
+                continue;
+
+            int64_t buffered_packets = -1;
+            for (bool direct : {false, true}) {
+                InMemoryUrlProtocol in_memory(file.data(), int64_t(file.length()), false, direct);
+                CopyCountingProtocol protocol(&in_memory);
+                FFmpegGlue glue(&protocol);
+                protocol.set_avio_context(glue.format_context()->pb);
+                // Files FFmpeg can't probe, e.g. raw PCM, are skipped.
+                if (!glue.OpenContext() ||
+                    avformat_find_stream_info(glue.format_context(), nullptr) < 0 ||
+                    glue.format_context()->duration <= 0)
+                    break;
+
+                int64_t packets = 0;
+                auto start = std::chrono::steady_clock::now();
+                std::unique_ptr<AVPacket, ScopedPtrAVFreePacket> packet(av_packet_alloc());
+                while (av_read_frame(glue.format_context(), packet.get()) >= 0) {
+                    ++packets;
+                    av_packet_unref(packet.get());
+                }
+                std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+                // Both modes must demux the same packets.
+                if (direct)
+                    EXPECT_EQ(buffered_packets, packets) << entry.path();
+                buffered_packets = packets;
+
+                const double seconds = double(glue.format_context()->duration) / AV_TIME_BASE;
+                printf("%-32s %-8s buffer %7d %10.0f bytes copied per second of audio, "
+                       "%8.1f MB/s\n", entry.path().filename().string().c_str(),
+                       direct ? "direct" : "buffered", glue.buffer_size(),
+                       protocol.total_copied_bytes() / seconds,
+                       double(file.length()) / elapsed.count() / 1e6);
+            }
+        }
+    }
+}
@@ -0,0 +1,80 @@
+//
+// Created by wang rl on 2022/7/14.
+//
+
+#include <memory>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "media/base/AudioSampleTypes.h"
+#include "media/ffmpeg/ffmpeg_sample_conversion.h"
+
+namespace mm {
+    static const int kChannels = 3;
+    static const int kFrameCount = 37;
+
+    // Sample value of |frame| of |channel|, spread over the nominal range.
+    static float TestValue(int channel, int frame) {
+        return float((frame * 7 + channel * 13) % 41) / 20.0f - 1.0f;
+    }
+
+    // Encodes the test values in the format described by |SampleTypeTraits|,
+    // converts them with the function for |format| and compares the result with
+    // the scalar conversion.
+    template<class SampleTypeTraits>
+    static void VerifyFormat(AVSampleFormat format, bool planar) {
+        using ValueType = typename SampleTypeTraits::ValueType;
+        SCOPED_TRACE(format);
+        const ConvertToAudioBusFunction convert = GetConvertToAudioBusFunction(format);
+        ASSERT_TRUE(convert);
+
+        std::vector<std::vector<ValueType>> planes(kChannels);
+        std::vector<ValueType> interleaved;
+        for (int frame = 0; frame < kFrameCount; ++frame) {
+            for (int ch = 0; ch < kChannels; ++ch) {
+                const ValueType value =
+                        SampleTypeTraits::FromFloat(TestValue(ch, frame));
+                planes[ch].push_back(value);
+                interleaved.push_back(value);
+            }
+        }
+        std::vector<const uint8_t*> data;
+        if (planar) {
+            for (const auto& plane : planes)
+                data.push_back(reinterpret_cast<const uint8_t*>(plane.data()));
+        } else {
+            data.push_back(reinterpret_cast<const uint8_t*>(interleaved.data()));
+        }
+
+        // Only the requested frames are written.
+        std::unique_ptr<AudioBus> bus = AudioBus::Create(kChannels, kFrameCount + 1);
+        bus->zero();
+        convert(data.data(), kFrameCount, bus.get());
+        for (int ch = 0; ch < kChannels; ++ch) {
+            for (int frame = 0; frame < kFrameCount; ++frame) {
+                ASSERT_EQ(SampleTypeTraits::ToFloat(planes[ch][frame]),
+                          bus->channel(ch)[frame]) << ch << " " << frame;
+            }
+            EXPECT_EQ(0.0f, bus->channel(ch)[kFrameCount]);
+        }
+    }
+
+    // Verify every planar and interleaved PCM format is converted.
+    TEST(FFmpegSampleConversionTest, AllFormats) {
+        VerifyFormat<UnsignedInt8SampleTypeTraits>(AV_SAMPLE_FMT_U8, false);
+        VerifyFormat<SignedInt16SampleTypeTraits>(AV_SAMPLE_FMT_S16, false);
+        VerifyFormat<SignedInt32SampleTypeTraits>(AV_SAMPLE_FMT_S32, false);
+        VerifyFormat<FixedSampleTypeTraits<int64_t>>(AV_SAMPLE_FMT_S64, false);
+        VerifyFormat<Float32SampleTypeTraits>(AV_SAMPLE_FMT_FLT, false);
+        VerifyFormat<Float64SampleTypeTraits>(AV_SAMPLE_FMT_DBL, false);
+        VerifyFormat<UnsignedInt8SampleTypeTraits>(AV_SAMPLE_FMT_U8P, true);
+        VerifyFormat<SignedInt16SampleTypeTraits>(AV_SAMPLE_FMT_S16P, true);
+        VerifyFormat<SignedInt32SampleTypeTraits>(AV_SAMPLE_FMT_S32P, true);
+        VerifyFormat<FixedSampleTypeTraits<int64_t>>(AV_SAMPLE_FMT_S64P, true);
+        VerifyFormat<Float32SampleTypeTraits>(AV_SAMPLE_FMT_FLTP, true);
+        VerifyFormat<Float64SampleTypeTraits>(AV_SAMPLE_FMT_DBLP, true);
+
+        EXPECT_FALSE(GetConvertToAudioBusFunction(AV_SAMPLE_FMT_NONE));
+        EXPECT_FALSE(GetConvertToAudioBusFunction(AV_SAMPLE_FMT_NB));
+    }
+}
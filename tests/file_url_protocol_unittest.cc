@@ -0,0 +1,63 @@
+//
+// Created by WangRuiLing on 2022/7/19.
+//
+
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include "media/filters/file_url_protocol.h"
+#include "tests/url_protocol_test_util.h"
+
+namespace mm {
+    class FileUrlProtocolTest : public UrlProtocolTest {};
+
+    TEST_F(FileUrlProtocolTest, Read) {
+        for (int read_ahead : {0, 1000, 4096, FileUrlProtocol::kDefaultReadAhead}) {
+            for (int read_size : {1, 333, 4096, 32768, 200000}) {
+                SCOPED_TRACE(testing::Message() << "read_ahead " << read_ahead
+                                                << ", read_size " << read_size);
+                auto protocol = FileUrlProtocol::Open(path_, read_ahead);
+                ASSERT_TRUE(protocol);
+                EXPECT_EQ(data_, ReadAll(protocol.get(), read_size));
+            }
+        }
+    }
+
+    TEST_F(FileUrlProtocolTest, ReadWithNegativeOrZeroSize) {
+        auto protocol = FileUrlProtocol::Open(path_);
+        ASSERT_TRUE(protocol);
+
+        uint8_t out;
+        EXPECT_EQ(AVERROR(EIO), protocol->Read(-2, &out));
+        EXPECT_EQ(0, protocol->Read(0, &out));
+    }
+
+    TEST_F(FileUrlProtocolTest, OpenMissingFile) {
+        EXPECT_FALSE(FileUrlProtocol::Open(path_ + ".missing"));
+    }
+
+    TEST_F(FileUrlProtocolTest, SetPosition) {
+        auto protocol = FileUrlProtocol::Open(path_, 1000);
+        ASSERT_TRUE(protocol);
+
+        TestSetPosition(protocol.get());
+    }
+
+    TEST_F(FileUrlProtocolTest, SharedFd) {
+        auto owner = FileUrlProtocol::Open(path_, 4096);
+        ASSERT_TRUE(owner);
+
+        std::vector<std::vector<uint8_t>> results(4);
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < results.size(); ++t) {
+            threads.emplace_back([this, &owner, &results, t]() {
+                FileUrlProtocol protocol(owner->fd(), 4096);
+                results[t] = ReadAll(&protocol, int(100 + t * 777));
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+        for (const auto& result : results)
+            EXPECT_EQ(data_, result);
+    }
+}
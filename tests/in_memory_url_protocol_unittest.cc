@@ -46,4 +46,32 @@ namespace mm {
         EXPECT_EQ(1, protocol.Read(1, &out));
         EXPECT_EQ(kData[i], out);
     }
+
+    TEST(InMemoryUrlProtocolTest, PreferredBufferSize) {
+        EXPECT_EQ(0, InMemoryUrlProtocol(kData, sizeof(kData), false).PreferredBufferSize());
+        EXPECT_EQ(InMemoryUrlProtocol::kStreamingBufferSize,
+                  InMemoryUrlProtocol(kData, sizeof(kData), true).PreferredBufferSize());
+
+        InMemoryUrlProtocol protocol(kData, sizeof(kData), false);
+        EXPECT_EQ(FFmpegGlue::kDefaultBufferSize, FFmpegGlue(&protocol).buffer_size());
+        EXPECT_EQ(8192, FFmpegGlue(&protocol, 8192).buffer_size());
+    }
+
+    TEST(InMemoryUrlProtocolTest, Direct) {
+        InMemoryUrlProtocol buffered(kData, sizeof(kData), false);
+        EXPECT_FALSE(buffered.PrefersDirectReads());
+        FFmpegGlue buffered_glue(&buffered);
+        EXPECT_EQ(0, buffered_glue.format_context()->pb->direct);
+
+        InMemoryUrlProtocol protocol(kData, sizeof(kData), false, true);
+        EXPECT_TRUE(protocol.PrefersDirectReads());
+        FFmpegGlue glue(&protocol);
+        EXPECT_EQ(InMemoryUrlProtocol::kDirectBufferSize, glue.buffer_size());
+        EXPECT_EQ(1, glue.format_context()->pb->direct);
+
+        // Reads are the same in either mode.
+        uint8_t out[sizeof(kData)];
+        EXPECT_EQ(4, protocol.Read(sizeof(out), out));
+        EXPECT_EQ(0, memcmp(out, kData, sizeof(out)));
+    }
 }
\ No newline at end of file
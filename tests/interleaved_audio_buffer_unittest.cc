@@ -0,0 +1,149 @@
+//
+// Created by wang rl on 2022/7/12.
+//
+
+#include <cstring>
+#include <memory>
+#include <gtest/gtest.h>
+
+#include "media/base/InterleavedAudioBuffer.h"
+
+namespace mm {
+    static const int kChannels = 2;
+    static const int kFrameCount = 160;
+
+    // Verify the allocation and the frame layout.
+    TEST(InterleavedAudioBufferTest, Create) {
+        for (int alignment : {int(AudioBus::kSSEAlignment),
+                              int(AudioBus::kCacheLineAlignment)}) {
+            std::unique_ptr<InterleavedAudioBufferS16> buffer =
+                    InterleavedAudioBufferS16::Create(kChannels, kFrameCount, alignment);
+            EXPECT_EQ(kChannels, buffer->channels());
+            EXPECT_EQ(kFrameCount, buffer->frames());
+            EXPECT_EQ(kChannels * kFrameCount * sizeof(int16_t), buffer->sizeInBytes());
+            EXPECT_TRUE(IsAligned(buffer->data(), alignment));
+            EXPECT_EQ(buffer->data() + 3 * kChannels, buffer->frame(3));
+        }
+
+        // Unsigned formats are zeroed to their zero point.
+        std::unique_ptr<InterleavedAudioBuffer<UnsignedInt8SampleTypeTraits>> u8 =
+                InterleavedAudioBuffer<UnsignedInt8SampleTypeTraits>::Create(
+                        kChannels, kFrameCount);
+        u8->zero();
+        for (int i = 0; i < kChannels * kFrameCount; ++i)
+            ASSERT_EQ(128, u8->data()[i]);
+    }
+
+    // Verify a wrapped buffer works on the caller's memory.
+    TEST(InterleavedAudioBufferTest, WrapMemory) {
+        std::vector<int16_t> samples(kChannels * kFrameCount, 7);
+        std::unique_ptr<InterleavedAudioBufferS16> buffer =
+                InterleavedAudioBufferS16::WrapMemory(kChannels, kFrameCount,
+                                                      samples.data());
+        EXPECT_EQ(samples.data(), buffer->data());
+        buffer->zeroFramesPartial(1, 2);
+        EXPECT_EQ(7, samples[1]);
+        EXPECT_EQ(0, samples[2]);
+        EXPECT_EQ(0, samples[5]);
+        EXPECT_EQ(7, samples[6]);
+    }
+
+    // Verify frames are copied between buffers, also within one buffer.
+    TEST(InterleavedAudioBufferTest, CopyPartialFramesTo) {
+        std::unique_ptr<InterleavedAudioBufferS16> buffer =
+                InterleavedAudioBufferS16::Create(kChannels, kFrameCount);
+        for (int i = 0; i < kChannels * kFrameCount; ++i)
+            buffer->data()[i] = int16_t(i);
+
+        std::unique_ptr<InterleavedAudioBufferS16> dest =
+                InterleavedAudioBufferS16::Create(kChannels, kFrameCount);
+        dest->zero();
+        buffer->copyPartialFramesTo(10, 20, 5, dest.get());
+        EXPECT_EQ(0, dest->frame(4)[1]);
+        EXPECT_EQ(20, dest->frame(5)[0]);
+        EXPECT_EQ(59, dest->frame(24)[1]);
+        EXPECT_EQ(0, dest->frame(25)[0]);
+
+        buffer->copyPartialFramesTo(0, 20, 1, buffer.get());
+        EXPECT_EQ(0, buffer->frame(1)[0]);
+        EXPECT_EQ(39, buffer->frame(20)[1]);
+    }
+
+    // Verify the conversion to and from AudioBus round trips s16. The float to
+    // s16 conversion truncates, so positive values may come back one lower.
+    TEST(InterleavedAudioBufferTest, AudioBusRoundTrip) {
+        std::unique_ptr<InterleavedAudioBufferS16> buffer =
+                InterleavedAudioBufferS16::Create(kChannels, kFrameCount);
+        for (int i = 0; i < kChannels * kFrameCount; ++i)
+            buffer->data()[i] = int16_t((i * 409) % 65536 - 32768);
+
+        std::unique_ptr<AudioBus> bus = AudioBus::Create(kChannels, kFrameCount);
+        buffer->toAudioBus(bus.get());
+        EXPECT_EQ(SignedInt16SampleTypeTraits::ToFloat(buffer->frame(7)[1]),
+                  bus->channel(1)[7]);
+
+        std::unique_ptr<InterleavedAudioBufferS16> result =
+                InterleavedAudioBufferS16::Create(kChannels, kFrameCount);
+        result->fromAudioBus(bus.get());
+        for (int i = 0; i < kChannels * kFrameCount; ++i)
+            ASSERT_NEAR(buffer->data()[i], result->data()[i], 1) << i;
+
+        // A shorter source zeroes the remaining frames.
+        std::unique_ptr<InterleavedAudioBufferS16> partial =
+                InterleavedAudioBufferS16::Create(kChannels, kFrameCount);
+        partial->fromAudioBus(AudioBusView(bus.get(), 0, kFrameCount / 2));
+        EXPECT_EQ(0, memcmp(result->data(), partial->data(), result->sizeInBytes() / 2));
+        for (int i = kFrameCount / 2; i < kFrameCount; ++i)
+            ASSERT_EQ(0, partial->frame(i)[0]);
+
+        // Only the frames of the buffer are written to a longer bus.
+        std::unique_ptr<AudioBus> longer = AudioBus::Create(kChannels, kFrameCount + 8);
+        longer->zero();
+        longer->channel(0)[kFrameCount] = 0.5f;
+        buffer->toAudioBus(longer.get());
+        EXPECT_EQ(0.5f, longer->channel(0)[kFrameCount]);
+    }
+
+    // Verify conversions between formats match the scalar traits, and the same
+    // format is copied bit-exact, including f32 values outside of [-1, 1].
+    TEST(InterleavedAudioBufferTest, ConvertTo) {
+        std::unique_ptr<InterleavedAudioBufferS16> s16 =
+                InterleavedAudioBufferS16::Create(kChannels, kFrameCount);
+        for (int i = 0; i < kChannels * kFrameCount; ++i)
+            s16->data()[i] = int16_t((i * 409) % 65536 - 32768);
+
+        std::unique_ptr<InterleavedAudioBufferS16> sameFormat =
+                InterleavedAudioBufferS16::Create(kChannels, kFrameCount);
+        s16->convertTo(sameFormat.get());
+        EXPECT_EQ(0, memcmp(s16->data(), sameFormat->data(), s16->sizeInBytes()));
+
+        std::unique_ptr<InterleavedAudioBufferS24> s24 =
+                InterleavedAudioBufferS24::Create(kChannels, kFrameCount);
+        s16->convertTo(s24.get());
+        for (int i = 0; i < kChannels * kFrameCount; ++i) {
+            const PackedInt24 expected = SignedInt24PackedSampleTypeTraits::FromFloat(
+                    SignedInt16SampleTypeTraits::ToFloat(s16->data()[i]));
+            ASSERT_EQ(0, memcmp(&expected, &s24->data()[i], sizeof(expected))) << i;
+        }
+
+        // Partial conversions only touch their frames.
+        std::unique_ptr<InterleavedAudioBuffer<Float32SampleTypeTraits>> f32 =
+                InterleavedAudioBuffer<Float32SampleTypeTraits>::Create(kChannels,
+                                                                        kFrameCount);
+        f32->zero();
+        s24->convertPartialFramesTo(10, 20, 5, f32.get());
+        EXPECT_EQ(0.0f, f32->frame(4)[1]);
+        EXPECT_EQ(SignedInt24PackedSampleTypeTraits::ToFloat(s24->frame(10)[0]),
+                  f32->frame(5)[0]);
+        EXPECT_EQ(SignedInt24PackedSampleTypeTraits::ToFloat(s24->frame(29)[1]),
+                  f32->frame(24)[1]);
+        EXPECT_EQ(0.0f, f32->frame(25)[0]);
+
+        f32->frame(0)[0] = 1.5f;
+        std::unique_ptr<InterleavedAudioBuffer<Float32SampleTypeTraits>> f32Copy =
+                InterleavedAudioBuffer<Float32SampleTypeTraits>::Create(kChannels,
+                                                                        kFrameCount);
+        f32->convertTo(f32Copy.get());
+        EXPECT_EQ(0, memcmp(f32->data(), f32Copy->data(), f32->sizeInBytes()));
+    }
+}
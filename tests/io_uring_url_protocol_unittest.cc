@@ -0,0 +1,202 @@
+//
+// Created by WangRuiLing on 2022/7/22.
+//
+
+#include <condition_variable>
+#include <fcntl.h>
+#include <mutex>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include <gtest/gtest.h>
+#include "media/filters/io_uring_url_protocol.h"
+#include "tests/url_protocol_test_util.h"
+
+namespace mm {
+    class IoUringUrlProtocolTest : public UrlProtocolTest {
+    protected:
+        // Returns a context with few small buffers, so that the tests run out
+        // of them, or nullptr if io_uring is unavailable.
+        static std::unique_ptr<IoUringContext> CreateContext(int buffer_count = 4) {
+            IoUringContext::Options options;
+            options.queue_depth = 16;
+            options.buffer_count = buffer_count;
+            options.buffer_size = 4096;
+            return IoUringContext::Create(options);
+        }
+    };
+
+    TEST_F(IoUringUrlProtocolTest, Read) {
+        auto context = CreateContext();
+        if (!context)
+            GTEST_SKIP() << "io_uring is unavailable";
+
+        for (int read_size : {1, 333, 4096, 32768}) {
+            SCOPED_TRACE(read_size);
+            auto protocol = IoUringUrlProtocol::Open(path_, context.get());
+            ASSERT_TRUE(protocol);
+            EXPECT_TRUE(protocol->uses_io_uring());
+            EXPECT_EQ(data_, ReadAll(protocol.get(), read_size));
+        }
+    }
+
+    TEST_F(IoUringUrlProtocolTest, ReadWithoutRegisteredBuffers) {
+        auto context = CreateContext(0);
+        if (!context)
+            GTEST_SKIP() << "io_uring is unavailable";
+        EXPECT_EQ(0, context->buffer_count());
+
+        auto protocol = IoUringUrlProtocol::Open(path_, context.get());
+        ASSERT_TRUE(protocol);
+        EXPECT_EQ(data_, ReadAll(protocol.get(), 1000));
+    }
+
+    TEST_F(IoUringUrlProtocolTest, FallBackToPRead) {
+        auto protocol = IoUringUrlProtocol::Open(path_, nullptr);
+        ASSERT_TRUE(protocol);
+        EXPECT_FALSE(protocol->uses_io_uring());
+        EXPECT_EQ(data_, ReadAll(protocol.get(), 1000));
+
+        uint8_t out;
+        EXPECT_EQ(AVERROR(EIO), protocol->Read(-2, &out));
+        EXPECT_EQ(0, protocol->Read(0, &out));
+    }
+
+    TEST_F(IoUringUrlProtocolTest, OpenMissingFile) {
+        EXPECT_FALSE(IoUringUrlProtocol::Open(path_ + ".missing", nullptr));
+    }
+
+    TEST_F(IoUringUrlProtocolTest, SetPosition) {
+        auto context = CreateContext();
+        auto protocol = IoUringUrlProtocol::Open(path_, context.get());
+        ASSERT_TRUE(protocol);
+
+        TestSetPosition(protocol.get());
+    }
+
+    // Seeks into the window being read ahead, which is then used, and away from
+    // it, which drops it.
+    TEST_F(IoUringUrlProtocolTest, SeekAroundReadAhead) {
+        auto context = CreateContext();
+        if (!context)
+            GTEST_SKIP() << "io_uring is unavailable";
+        auto protocol = IoUringUrlProtocol::Open(path_, context.get());
+        ASSERT_TRUE(protocol);
+
+        uint8_t out[100];
+        for (int64_t position : {int64_t(0), int64_t(4096 + 10), int64_t(50000), int64_t(16384)}) {
+            SCOPED_TRACE(position);
+            EXPECT_TRUE(protocol->SetPosition(position));
+            EXPECT_EQ(int(sizeof(out)), protocol->Read(sizeof(out), out));
+            EXPECT_EQ(0, memcmp(out, data_.data() + position, sizeof(out)));
+        }
+    }
+
+    TEST_F(IoUringUrlProtocolTest, ConcurrentStreams) {
+        auto context = CreateContext();
+        if (!context)
+            GTEST_SKIP() << "io_uring is unavailable";
+
+        // More streams than buffers and queue entries.
+        std::vector<std::vector<uint8_t>> results(32);
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < results.size(); ++t) {
+            threads.emplace_back([this, &context, &results, t]() {
+                auto protocol = IoUringUrlProtocol::Open(path_, context.get());
+                if (protocol)
+                    results[t] = ReadAll(protocol.get(), int(100 + t * 777));
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+        for (const auto& result : results)
+            EXPECT_EQ(data_, result);
+        EXPECT_GE(context->submitted_reads(), context->submit_calls());
+        EXPECT_FALSE(context->broken());
+    }
+
+    // The completion thread's io_uring_enter() fails while another thread is in
+    // io_uring_enter() submitting. The read being submitted must complete once,
+    // with its data, and the read queued behind it must fail.
+    TEST_F(IoUringUrlProtocolTest, EnterFailsDuringSubmit) {
+        auto context = CreateContext(0);
+        if (!context)
+            GTEST_SKIP() << "io_uring is unavailable";
+        int pipe_fds[2];
+        ASSERT_EQ(0, pipe(pipe_fds));
+        const int fd = open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+        ASSERT_GE(fd, 0);
+
+        std::mutex lock;
+        std::condition_variable changed;
+        bool block_submit = false;
+        bool submitting = false;
+        bool fail_wait = false;
+        context->SetEnterHookForTesting([&](unsigned to_submit) {
+            std::unique_lock<std::mutex> hook_lock(lock);
+            if (to_submit == 0) {
+                changed.wait(hook_lock, [&] { return fail_wait; });
+                return EBADF;
+            }
+            if (block_submit) {
+                submitting = true;
+                changed.notify_all();
+                // broken() takes the context's lock, which the submitter
+                // doesn't hold here.
+                while (!context->broken())
+                    changed.wait_for(hook_lock, std::chrono::milliseconds(1));
+            }
+            return 0;
+        });
+
+        // The kernel holds on to a read of the empty pipe, so the completion
+        // thread waits in the kernel.
+        uint8_t pipe_out[4];
+        IoUringContext::Request pipe_read;
+        context->Submit(&pipe_read, pipe_fds[0], 0, sizeof(pipe_out), pipe_out, -1);
+
+        {
+            std::lock_guard<std::mutex> hook_lock(lock);
+            block_submit = true;
+        }
+        uint8_t submitted_out[100];
+        IoUringContext::Request submitted_read;
+        std::thread submitter([&]() {
+            context->Submit(&submitted_read, fd, 1000, sizeof(submitted_out), submitted_out, -1);
+        });
+        {
+            std::unique_lock<std::mutex> hook_lock(lock);
+            changed.wait(hook_lock, [&] { return submitting; });
+        }
+        // Queued behind the read being submitted, the kernel never sees it.
+        uint8_t queued_out[100];
+        IoUringContext::Request queued_read;
+        context->Submit(&queued_read, fd, 2000, sizeof(queued_out), queued_out, -1);
+        {
+            std::lock_guard<std::mutex> hook_lock(lock);
+            fail_wait = true;
+        }
+        changed.notify_all();
+        submitter.join();
+
+        EXPECT_TRUE(context->broken());
+        EXPECT_EQ(int(sizeof(submitted_out)), context->Wait(&submitted_read));
+        EXPECT_EQ(0, memcmp(submitted_out, data_.data() + 1000, sizeof(submitted_out)));
+        EXPECT_EQ(-EBADF, context->Wait(&queued_read));
+
+        // The completion thread polls for the pipe read, which the kernel took.
+        ASSERT_EQ(4, write(pipe_fds[1], "data", 4));
+        EXPECT_EQ(4, context->Wait(&pipe_read));
+
+        // Later reads use pread().
+        uint8_t out[100];
+        EXPECT_EQ(int(sizeof(out)), context->Read(fd, 3000, sizeof(out), out, -1));
+        EXPECT_EQ(0, memcmp(out, data_.data() + 3000, sizeof(out)));
+
+        // Destroying the context checks that every read completed exactly once.
+        context.reset();
+        close(fd);
+        close(pipe_fds[0]);
+        close(pipe_fds[1]);
+    }
+}
@@ -0,0 +1,95 @@
+//
+// Created by wang rl on 2022/7/18.
+//
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "base/files/MemoryMappedFile.h"
+
+namespace mm {
+    class MemoryMappedFileTest : public testing::Test {
+    protected:
+        void SetUp() override {
+            path_ = (std::filesystem::temp_directory_path() /
+                     ("memory_mapped_file_" + std::to_string(::testing::UnitTest::GetInstance()
+                             ->random_seed()) + ".bin")).string();
+        }
+
+        void TearDown() override {
+            std::filesystem::remove(path_);
+        }
+
+        void WriteFile(const std::vector<uint8_t>& data) {
+            std::ofstream ofs(path_, std::ios::binary | std::ios::trunc);
+            ofs.write(reinterpret_cast<const char*>(data.data()), long(data.size()));
+        }
+
+        std::string path_;
+    };
+
+    TEST_F(MemoryMappedFileTest, Map) {
+        std::vector<uint8_t> data(100000);
+        for (size_t i = 0; i < data.size(); ++i)
+            data[i] = uint8_t(i * 7);
+        WriteFile(data);
+
+        MemoryMappedFile file;
+        ASSERT_TRUE(file.Initialize(path_));
+        EXPECT_TRUE(file.IsValid());
+        ASSERT_EQ(data.size(), file.length());
+        EXPECT_EQ(0, memcmp(data.data(), file.data(), data.size()));
+
+        for (auto access : {MemoryMappedFile::Access::kSequential,
+                            MemoryMappedFile::Access::kRandom,
+                            MemoryMappedFile::Access::kNormal}) {
+            file.Advise(access);
+        }
+        EXPECT_EQ(0, memcmp(data.data(), file.data(), data.size()));
+    }
+
+    TEST_F(MemoryMappedFileTest, EmptyFile) {
+        WriteFile({});
+
+        MemoryMappedFile file;
+        ASSERT_TRUE(file.Initialize(path_));
+        EXPECT_TRUE(file.IsValid());
+        EXPECT_EQ(0U, file.length());
+        EXPECT_EQ(nullptr, file.data());
+        file.Advise(MemoryMappedFile::Access::kSequential);
+    }
+
+    TEST_F(MemoryMappedFileTest, MissingFile) {
+        MemoryMappedFile file;
+        EXPECT_FALSE(file.Initialize(path_ + ".missing"));
+        EXPECT_FALSE(file.IsValid());
+        EXPECT_EQ(nullptr, file.data());
+    }
+
+    TEST_F(MemoryMappedFileTest, SharedBetweenThreads) {
+        std::vector<uint8_t> data(1 << 20);
+        for (size_t i = 0; i < data.size(); ++i)
+            data[i] = uint8_t(i >> 3);
+        WriteFile(data);
+
+        auto file = std::make_shared<MemoryMappedFile>();
+        ASSERT_TRUE(file->Initialize(path_));
+
+        std::vector<int> matches(4);
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < matches.size(); ++t) {
+            threads.emplace_back([file, &data, &matches, t]() {
+                matches[t] = memcmp(file->data(), data.data(), data.size()) == 0;
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+        for (int match : matches)
+            EXPECT_TRUE(match);
+    }
+}
@@ -0,0 +1,99 @@
+//
+// Created by wang rl on 2022/7/16.
+//
+
+#include <memory>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "base/memory/AlignedMemory.h"
+#include "base/memory/MemoryStats.h"
+#include "media/base/AudioBus.h"
+#include "media/base/AudioBusPool.h"
+
+namespace mm {
+    // Other tests allocate untagged memory or cache memory, so every test only
+    // looks at the change of the counters it causes.
+    TEST(MemoryStatsTest, AlignedAlloc) {
+        const MemoryStats before = GetMemoryStats(MemoryTag::kDecoder);
+        void* ptr = AlignedAlloc(1000, 64, MemoryTag::kDecoder);
+        EXPECT_TRUE(IsAligned(ptr, 64));
+
+        MemoryStats stats = GetMemoryStats(MemoryTag::kDecoder);
+        EXPECT_EQ(before.current_bytes + 1000, stats.current_bytes);
+        EXPECT_EQ(before.allocations + 1, stats.allocations);
+        EXPECT_EQ(before.frees, stats.frees);
+        EXPECT_LE(stats.current_bytes, stats.peak_bytes);
+
+        AlignedFree(ptr);
+        stats = GetMemoryStats(MemoryTag::kDecoder);
+        EXPECT_EQ(before.current_bytes, stats.current_bytes);
+        EXPECT_EQ(before.frees + 1, stats.frees);
+    }
+
+    TEST(MemoryStatsTest, Peak) {
+        const int64_t base = GetMemoryStats(MemoryTag::kDsp).current_bytes;
+        // Above kMemoryStatsBatchBytes, so the peak is exact.
+        const size_t kSize = 4 * kMemoryStatsBatchBytes;
+        void* a = AlignedAlloc(kSize, 16, MemoryTag::kDsp);
+        void* b = AlignedAlloc(kSize, 16, MemoryTag::kDsp);
+        AlignedFree(a);
+        AlignedFree(b);
+        const MemoryStats stats = GetMemoryStats(MemoryTag::kDsp);
+        EXPECT_EQ(base, stats.current_bytes);
+        EXPECT_LE(base + 2 * int64_t(kSize), stats.peak_bytes);
+    }
+
+    // Memory freed on another thread than it was allocated on, and counters of
+    // exited threads, are still accounted.
+    TEST(MemoryStatsTest, Threads) {
+        const MemoryStats before = GetMemoryStats(MemoryTag::kCache);
+        std::vector<void*> allocations(8);
+        std::thread([&allocations]() {
+            for (void*& ptr : allocations)
+                ptr = AlignedAlloc(100, 16, MemoryTag::kCache);
+        }).join();
+
+        MemoryStats stats = GetMemoryStats(MemoryTag::kCache);
+        EXPECT_EQ(before.current_bytes + 800, stats.current_bytes);
+        EXPECT_EQ(before.allocations + 8, stats.allocations);
+
+        for (void* ptr : allocations)
+            AlignedFree(ptr);
+        stats = GetMemoryStats(MemoryTag::kCache);
+        EXPECT_EQ(before.current_bytes, stats.current_bytes);
+        EXPECT_EQ(before.frees + 8, stats.frees);
+    }
+
+    TEST(MemoryStatsTest, AudioBus) {
+        const MemoryStats before = GetMemoryStats(MemoryTag::kDecoder);
+        std::unique_ptr<AudioBus> bus =
+                AudioBus::Create(2, 1024, AudioBus::kChannelAlignment, MemoryTag::kDecoder);
+        EXPECT_EQ(size_t(AudioBus::CalculateMemorySize(2, 1024)), bus->memorySize());
+        EXPECT_EQ(before.current_bytes + int64_t(bus->memorySize()),
+                  GetMemoryStats(MemoryTag::kDecoder).current_bytes);
+
+        std::unique_ptr<float, AlignedFreeDeleter> data(static_cast<float*>(AlignedAlloc(
+                AudioBus::CalculateMemorySize(2, 1024), AudioBus::kChannelAlignment)));
+        std::unique_ptr<AudioBus> wrapped = AudioBus::WrapMemory(2, 1024, data.get());
+        EXPECT_EQ(0U, wrapped->memorySize());
+
+        AudioBusPool pool(64, MemoryTag::kDecoder);
+        {
+            AudioBusPool::ScopedAudioBus pooled = pool.Create(2, 1000);
+            EXPECT_EQ(before.allocations + 2,
+                      GetMemoryStats(MemoryTag::kDecoder).allocations);
+        }
+        pool.clear();
+        bus.reset();
+        EXPECT_EQ(before.current_bytes, GetMemoryStats(MemoryTag::kDecoder).current_bytes);
+    }
+
+    TEST(MemoryStatsTest, TagNames) {
+        EXPECT_STREQ("untagged", MemoryTagName(MemoryTag::kUntagged));
+        EXPECT_STREQ("decoder", MemoryTagName(MemoryTag::kDecoder));
+        EXPECT_STREQ("dsp", MemoryTagName(MemoryTag::kDsp));
+        EXPECT_STREQ("cache", MemoryTagName(MemoryTag::kCache));
+    }
+}
@@ -0,0 +1,66 @@
+//
+// Created by WangRuiLing on 2022/7/18.
+//
+
+#include <memory>
+#include <gtest/gtest.h>
+#include "media/filters/mmap_url_protocol.h"
+#include "tests/url_protocol_test_util.h"
+
+namespace mm {
+    class MmapUrlProtocolTest : public UrlProtocolTest {};
+
+    TEST_F(MmapUrlProtocolTest, Read) {
+        // Reads of one byte up to several pages, most of them straddling page
+        // boundaries.
+        for (int read_size : {1, 333, 4096, 32768}) {
+            SCOPED_TRACE(read_size);
+            auto protocol = MmapUrlProtocol::Open(path_);
+            ASSERT_TRUE(protocol);
+            EXPECT_EQ(data_, ReadAll(protocol.get(), read_size));
+        }
+    }
+
+    TEST_F(MmapUrlProtocolTest, SetPosition) {
+        auto protocol = MmapUrlProtocol::Open(path_);
+        ASSERT_TRUE(protocol);
+
+        TestSetPosition(protocol.get());
+
+        // Across the boundary of the first and second page.
+        uint8_t out[100];
+        EXPECT_TRUE(protocol->SetPosition(4096 - 50));
+        EXPECT_EQ(int(sizeof(out)), protocol->Read(sizeof(out), out));
+        EXPECT_EQ(0, memcmp(out, data_.data() + 4096 - 50, sizeof(out)));
+    }
+
+    TEST_F(MmapUrlProtocolTest, PreferredBufferSize) {
+        auto protocol = MmapUrlProtocol::Open(path_);
+        ASSERT_TRUE(protocol);
+        EXPECT_EQ(MmapUrlProtocol::kBufferSize, protocol->PreferredBufferSize());
+        EXPECT_EQ(MmapUrlProtocol::kBufferSize, FFmpegGlue(protocol.get()).buffer_size());
+
+        auto streaming = MmapUrlProtocol::Open(path_, true);
+        ASSERT_TRUE(streaming);
+        EXPECT_EQ(InMemoryUrlProtocol::kStreamingBufferSize, streaming->PreferredBufferSize());
+    }
+
+    TEST_F(MmapUrlProtocolTest, OpenMissingFile) {
+        EXPECT_FALSE(MmapUrlProtocol::Open(path_ + ".missing"));
+    }
+
+    TEST_F(MmapUrlProtocolTest, SharedMapping) {
+        auto file = std::make_shared<MemoryMappedFile>();
+        ASSERT_TRUE(file->Initialize(path_));
+        auto first = std::make_unique<MmapUrlProtocol>(file, false);
+        MmapUrlProtocol second(file, false);
+        EXPECT_EQ(first->file(), second.file());
+
+        // Positions are independent, and the mapping outlives either protocol.
+        EXPECT_TRUE(first->SetPosition(2));
+        first.reset();
+        file.reset();
+
+        EXPECT_EQ(data_, ReadAll(&second, 1000));
+    }
+}
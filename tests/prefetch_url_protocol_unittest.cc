@@ -0,0 +1,138 @@
+//
+// Created by WangRuiLing on 2022/7/21.
+//
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <vector>
+#include <gtest/gtest.h>
+#include "media/filters/in_memory_url_protocol.h"
+#include "media/filters/prefetch_url_protocol.h"
+#include "tests/url_protocol_test_util.h"
+
+namespace mm {
+    // Lets the test decide how many reads may complete; the others block until
+    // allowed, like reads from slow storage.
+    class GatedUrlProtocol : public InMemoryUrlProtocol {
+    public:
+        GatedUrlProtocol(const uint8_t* data, int64_t size)
+                : InMemoryUrlProtocol(data, size, false) {}
+
+        int Read(int size, uint8_t* data) override {
+            {
+                std::unique_lock<std::mutex> lock(lock_);
+                ++started_;
+                changed_.notify_all();
+                changed_.wait(lock, [this] { return completed_ < allowed_; });
+                ++completed_;
+            }
+            return InMemoryUrlProtocol::Read(size, data);
+        }
+
+        // Allows |count| reads in total.
+        void Allow(int64_t count) {
+            std::lock_guard<std::mutex> lock(lock_);
+            allowed_ = count;
+            changed_.notify_all();
+        }
+
+        // Waits until |count| reads were started.
+        void WaitForReads(int64_t count) {
+            std::unique_lock<std::mutex> lock(lock_);
+            changed_.wait(lock, [this, count] { return started_ >= count; });
+        }
+
+    private:
+        std::mutex lock_;
+        std::condition_variable changed_;
+        int64_t allowed_ = 0;
+        int64_t started_ = 0;
+        int64_t completed_ = 0;
+    };
+
+    class PrefetchUrlProtocolTest : public UrlProtocolTest {};
+
+    TEST_F(PrefetchUrlProtocolTest, Read) {
+        for (int block_size : {1000, 4096, PrefetchUrlProtocol::kDefaultBlockSize}) {
+            for (int read_size : {1, 777, 4096, 200000}) {
+                SCOPED_TRACE(testing::Message() << "block_size " << block_size
+                                                << ", read_size " << read_size);
+                InMemoryUrlProtocol in_memory(data_.data(), int64_t(data_.size()), false);
+                PrefetchUrlProtocol protocol(&in_memory, block_size, 3);
+                EXPECT_EQ(data_, ReadAll(&protocol, read_size));
+                EXPECT_GT(protocol.hits() + protocol.misses(), 0);
+            }
+        }
+    }
+
+    TEST_F(PrefetchUrlProtocolTest, ReadWithNegativeOrZeroSize) {
+        InMemoryUrlProtocol in_memory(data_.data(), int64_t(data_.size()), false);
+        PrefetchUrlProtocol protocol(&in_memory);
+
+        uint8_t out;
+        EXPECT_EQ(AVERROR(EIO), protocol.Read(-2, &out));
+        EXPECT_EQ(0, protocol.Read(0, &out));
+    }
+
+    TEST_F(PrefetchUrlProtocolTest, SetPosition) {
+        InMemoryUrlProtocol in_memory(data_.data(), int64_t(data_.size()), false);
+        PrefetchUrlProtocol protocol(&in_memory, 1000, 4);
+
+        TestSetPosition(&protocol);
+
+        int64_t size;
+        ASSERT_TRUE(protocol.GetSize(&size));
+        uint8_t out[10];
+        std::mt19937 generator(42);
+        for (int i = 0; i < 200; ++i) {
+            // Mostly short forward skips, which stay in the ring, and some jumps.
+            int64_t position;
+            EXPECT_TRUE(protocol.GetPosition(&position));
+            if (i % 4 == 0)
+                position = generator() % data_.size();
+            else
+                position = std::min<int64_t>(position + generator() % 1500, size);
+            SCOPED_TRACE(position);
+            EXPECT_TRUE(protocol.SetPosition(position));
+
+            const int expected = int(std::min<int64_t>(sizeof(out), size - position));
+            if (expected == 0) {
+                EXPECT_EQ(AVERROR_EOF, protocol.Read(sizeof(out), out));
+                continue;
+            }
+            // A read may stop at the end of a block.
+            int read = 0;
+            while (read < expected) {
+                const int result = protocol.Read(expected - read, out + read);
+                ASSERT_GT(result, 0);
+                read += result;
+            }
+            EXPECT_EQ(0, memcmp(out, data_.data() + position, expected));
+        }
+        EXPECT_GT(protocol.restarts(), 0);
+    }
+
+    TEST_F(PrefetchUrlProtocolTest, ReadsAhead) {
+        GatedUrlProtocol gated(data_.data(), int64_t(data_.size()));
+        PrefetchUrlProtocol protocol(&gated, 4096, 8);
+
+        // Once the fifth read started, the first four blocks are in the ring
+        // and reading them doesn't wait.
+        gated.Allow(4);
+        gated.WaitForReads(5);
+        std::vector<uint8_t> out(4 * 4096);
+        // No ASSERTs until the gate is open, the prefetch thread would block
+        // the destructor.
+        for (int i = 0; i < 4; ++i)
+            EXPECT_EQ(4096, protocol.Read(4096, out.data() + i * 4096));
+        EXPECT_EQ(4, protocol.hits());
+        EXPECT_EQ(0, protocol.misses());
+
+        gated.Allow(INT64_MAX);
+        const std::vector<uint8_t> rest = ReadAll(&protocol, 4096);
+        out.insert(out.end(), rest.begin(), rest.end());
+        EXPECT_EQ(data_, out);
+    }
+}
@@ -0,0 +1,89 @@
+//
+// Created by WangRuiLing on 2022/7/22.
+//
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include "media/filters/file_url_protocol.h"
+#include "media/filters/io_uring_url_protocol.h"
+
+namespace mm {
+    static const int kFileSize = 16 * 1024 * 1024;
+    // AVIO's default buffer size, the size of the reads FFmpeg issues.
+    static const int kReadSize = 32 * 1024;
+    // Times every stream reads the file.
+    static const int kPasses = 4;
+
+    // Reads |path| on |streams| threads at once, each through its own protocol
+    // from |open|, and returns the seconds taken.
+    static double ReadConcurrently(
+            int streams, const std::function<std::unique_ptr<FFmpegURLProtocol>()>& open) {
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (int t = 0; t < streams; ++t) {
+            threads.emplace_back([&open]() {
+                std::vector<uint8_t> buffer(kReadSize);
+                for (int pass = 0; pass < kPasses; ++pass) {
+                    std::unique_ptr<FFmpegURLProtocol> protocol = open();
+                    int64_t total = 0;
+                    int result;
+                    while ((result = protocol->Read(kReadSize, buffer.data())) > 0)
+                        total += result;
+                    EXPECT_EQ(kFileSize, total);
+                }
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count();
+    }
+
+    // Reads one file from 1 to 32 streams at once in AVIO sized reads, with
+    // FileUrlProtocol (pread() into a read-ahead window) and with
+    // IoUringUrlProtocol, and reports the throughput. The file is in the page
+    // cache, so this measures the cost of the read paths, not of the storage.
+    TEST(UrlProtocolPerfTest, ConcurrentStreams) {
+        auto context = IoUringContext::Create();
+        if (!context)
+            GTEST_SKIP() << "io_uring is unavailable";
+
+        const std::string path =
+                (std::filesystem::temp_directory_path() / "url_protocol_perftest.bin").string();
+        {
+            std::vector<char> data(kFileSize, 1);
+            std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+            ofs.write(data.data(), long(data.size()));
+        }
+
+        const double megabytes = double(kFileSize) * kPasses / 1e6;
+        for (int streams : {1, 4, 16, 32}) {
+            // The same window size as the io_uring buffers, and the default.
+            const double pread_small = ReadConcurrently(streams, [&path]() {
+                return FileUrlProtocol::Open(path, 64 * 1024);
+            });
+            const double pread_default = ReadConcurrently(streams, [&path]() {
+                return FileUrlProtocol::Open(path);
+            });
+
+            const int64_t calls = context->submit_calls();
+            const int64_t reads = context->submitted_reads();
+            const double io_uring = ReadConcurrently(streams, [&path, &context]() {
+                return IoUringUrlProtocol::Open(path, context.get());
+            });
+            const double batch = double(context->submitted_reads() - reads) /
+                                 double(context->submit_calls() - calls);
+
+            printf("%2d streams  pread 64 KB %7.0f MB/s  pread 256 KB %7.0f MB/s  "
+                   "io_uring %7.0f MB/s, %.2f reads per submission\n",
+                   streams, megabytes * streams / pread_small,
+                   megabytes * streams / pread_default, megabytes * streams / io_uring, batch);
+        }
+        std::filesystem::remove(path);
+    }
+}
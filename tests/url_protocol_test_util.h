@@ -0,0 +1,92 @@
+//
+// Created by WangRuiLing on 2022/7/22.
+//
+
+#ifndef MULTIMEDIA_URL_PROTOCOL_TEST_UTIL_H
+#define MULTIMEDIA_URL_PROTOCOL_TEST_UTIL_H
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "media/filters/ffmpeg_glue.h"
+
+namespace mm {
+    // Fixture shared by the tests of FFmpegURLProtocol implementations. Every
+    // test gets |data_| written to its own temporary file at |path_|.
+    class UrlProtocolTest : public testing::Test {
+    protected:
+        // Not a multiple of any block or buffer size used by the tests.
+        static constexpr size_t kDataSize = 100003;
+
+        UrlProtocolTest() : data_(kDataSize) {
+            for (size_t i = 0; i < data_.size(); ++i)
+                data_[i] = uint8_t(i * 13 + (i >> 8));
+        }
+
+        void SetUp() override {
+            // ctest may run the tests of one suite in parallel processes.
+            const testing::TestInfo* info =
+                    testing::UnitTest::GetInstance()->current_test_info();
+            path_ = (std::filesystem::temp_directory_path() /
+                     (std::string(info->test_suite_name()) + "." + info->name() + ".bin"))
+                    .string();
+            std::ofstream ofs(path_, std::ios::binary | std::ios::trunc);
+            ofs.write(reinterpret_cast<const char*>(data_.data()), long(data_.size()));
+        }
+
+        void TearDown() override {
+            std::filesystem::remove(path_);
+        }
+
+        // Reads until the end in reads of |read_size| bytes.
+        std::vector<uint8_t> ReadAll(FFmpegURLProtocol* protocol, int read_size) {
+            std::vector<uint8_t> out;
+            std::vector<uint8_t> buffer(read_size);
+            int result;
+            while ((result = protocol->Read(read_size, buffer.data())) > 0)
+                out.insert(out.end(), buffer.begin(), buffer.begin() + result);
+            EXPECT_EQ(AVERROR_EOF, result);
+            return out;
+        }
+
+        // Checks the bounds of SetPosition(), then reads after seeking forward,
+        // back by a little and close to the end. |protocol| must read |data_|.
+        void TestSetPosition(FFmpegURLProtocol* protocol) {
+            int64_t size;
+            EXPECT_TRUE(protocol->GetSize(&size));
+            EXPECT_EQ(int64_t(data_.size()), size);
+            EXPECT_FALSE(protocol->SetPosition(-1));
+            EXPECT_FALSE(protocol->SetPosition(size + 1));
+
+            uint8_t out[10];
+            EXPECT_TRUE(protocol->SetPosition(size));
+            EXPECT_EQ(AVERROR_EOF, protocol->Read(1, out));
+
+            for (int64_t position : {int64_t(5000), int64_t(5500), int64_t(4990), int64_t(99998)}) {
+                SCOPED_TRACE(position);
+                EXPECT_TRUE(protocol->SetPosition(position));
+                const int expected = int(std::min<int64_t>(sizeof(out), size - position));
+                // A read may stop at the end of a window or block.
+                int read = 0;
+                while (read < expected) {
+                    const int result = protocol->Read(expected - read, out + read);
+                    ASSERT_GT(result, 0);
+                    read += result;
+                }
+                EXPECT_EQ(0, memcmp(out, data_.data() + position, expected));
+                int64_t position_out;
+                EXPECT_TRUE(protocol->GetPosition(&position_out));
+                EXPECT_EQ(position + expected, position_out);
+            }
+        }
+
+        std::string path_;
+        std::vector<uint8_t> data_;
+    };
+}
+
+#endif //MULTIMEDIA_URL_PROTOCOL_TEST_UTIL_H
@@ -0,0 +1,128 @@
+//
+// Created by wang rl on 2022/7/14.
+//
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "common/Utilities.h"
+
+namespace mm {
+    // The conversion as it was before it was vectorized.
+    static int16_t ReferenceFloatToPcm16(float fval) {
+        fval += 1.0;
+        fval *= 32768.0f;
+        auto sample = static_cast<int32_t>(fval);
+        if (sample < 0) sample = 0;
+        else if (sample > 0x0FFFF) sample = 0x0FFFF;
+        sample -= 32768;
+        return static_cast<int16_t>(sample);
+    }
+
+    // Verify the vectorized conversion matches the scalar one, at any offset.
+    TEST(UtilitiesTest, ConvertFloatToPcm16) {
+        std::vector<float> source = {-2.0f, -1.0f, 1.0f, 2.0f, 0.0f, -0.0f,
+                                     std::nextafter(1.0f, 0.0f),
+                                     std::nextafter(-1.0f, 0.0f)};
+        for (int i = -100003; i <= 100003; ++i)
+            source.push_back(float(i) / 100000.0f);
+
+        for (int offset = 0; offset < 8; ++offset) {
+            const int count = int(source.size()) - offset;
+            std::vector<int16_t> result(count);
+            convertFloatToPcm16(source.data() + offset, result.data(), count);
+            for (int i = 0; i < count; ++i)
+                ASSERT_EQ(ReferenceFloatToPcm16(source[offset + i]), result[i]) << i;
+        }
+
+        // NaN maps to the lowest value.
+        const float nan = std::numeric_limits<float>::quiet_NaN();
+        int16_t result;
+        convertFloatToPcm16(&nan, &result, 1);
+        EXPECT_EQ(-32768, result);
+    }
+
+    TEST(UtilitiesTest, ConvertPcm16ToFloat) {
+        std::vector<int16_t> source;
+        for (int value = -32768; value <= 32767; ++value)
+            source.push_back(int16_t(value));
+        std::vector<float> result(source.size());
+        convertPcm16ToFloat(source.data() + 1, result.data(), int(source.size()) - 1);
+        for (size_t i = 0; i + 1 < source.size(); ++i)
+            ASSERT_EQ(source[i + 1] / 32768.0f, result[i]) << i;
+    }
+
+    // Converts |source| in chunks of |chunkSize| samples.
+    static std::vector<int16_t> ConvertInChunks(const std::vector<float>& source,
+                                                int chunkSize, Pcm16Dither& dither) {
+        std::vector<int16_t> result(source.size());
+        for (size_t offset = 0; offset < source.size(); offset += chunkSize) {
+            const int count = std::min(chunkSize, int(source.size() - offset));
+            convertFloatToPcm16(source.data() + offset, result.data() + offset, count,
+                                dither);
+        }
+        return result;
+    }
+
+    // Verify the dithered output only depends on the seed and the input, and
+    // that the dither is unbiased and within +-1 LSB of the plain conversion.
+    TEST(UtilitiesTest, TpdfDither) {
+        static const int kSamples = 48000;
+        // A -80 dBFS sine, which truncation alone turns into a square wave.
+        std::vector<float> source(kSamples);
+        for (int i = 0; i < kSamples; ++i)
+            source[i] = 1e-4f * float(std::sin(2 * M_PI * i / 48.0));
+
+        Pcm16Dither dither(Pcm16Dither::Mode::kTpdf, 2, 1234);
+        const std::vector<int16_t> whole = ConvertInChunks(source, kSamples, dither);
+        for (int chunkSize : {1, 3, 7, 480}) {
+            dither.reset();
+            EXPECT_EQ(whole, ConvertInChunks(source, chunkSize, dither)) << chunkSize;
+        }
+
+        Pcm16Dither otherSeed(Pcm16Dither::Mode::kTpdf, 2, 99);
+        EXPECT_NE(whole, ConvertInChunks(source, kSamples, otherSeed));
+
+        double error = 0;
+        for (int i = 0; i < kSamples; ++i) {
+            // Truncation quantizes to the LSB at or below the value.
+            const double exact = (double(source[i]) + 1.0) * 32768.0 - 32768.0;
+            ASSERT_LE(std::abs(whole[i] - exact), 2.0) << i;
+            error += whole[i] - (exact - 0.5);
+        }
+        EXPECT_NEAR(0.0, error / kSamples, 0.05);
+    }
+
+    // Verify noise shaping keeps the signal level and moves the error to high
+    // frequencies: the error of adjacent samples is negatively correlated.
+    TEST(UtilitiesTest, NoiseShapedDither) {
+        static const int kSamples = 48000;
+        std::vector<float> source(kSamples);
+        for (int i = 0; i < kSamples; ++i)
+            source[i] = 0.3f * float(std::sin(2 * M_PI * i / 100.0));
+
+        Pcm16Dither dither(Pcm16Dither::Mode::kNoiseShaped, 1, 7);
+        const std::vector<int16_t> whole = ConvertInChunks(source, kSamples, dither);
+        dither.reset();
+        EXPECT_EQ(whole, ConvertInChunks(source, 5, dither));
+
+        std::vector<double> errors(kSamples);
+        double mean = 0;
+        for (int i = 0; i < kSamples; ++i) {
+            errors[i] = whole[i] - ((double(source[i]) + 1.0) * 32768.0 - 32768.0);
+            mean += errors[i];
+        }
+        mean /= kSamples;
+        // The shaped error has no DC, not even the truncation bias.
+        EXPECT_NEAR(0.0, mean, 0.01);
+
+        double correlation = 0, energy = 0;
+        for (int i = 1; i < kSamples; ++i) {
+            correlation += (errors[i] - mean) * (errors[i - 1] - mean);
+            energy += (errors[i] - mean) * (errors[i] - mean);
+        }
+        EXPECT_LT(correlation / energy, -0.3);
+    }
+}
@@ -0,0 +1,181 @@
+//
+// Created by wang rl on 2022/7/4.
+//
+
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "base/cpu/CPU.h"
+#include "base/memory/AlignedMemory.h"
+#include "media/base/VectorMath.h"
+#include "media/base/VectorMathTesting.h"
+
+namespace mm {
+    static const int kBenchmarkIterations = 200000;
+    static const float kScale = 0.5;
+    // One 1024-frame processing block.
+    static const int kVectorSize = 1024;
+    // Number of inputs of the FMIX() benchmark.
+    static const int kMixInputs = 8;
+
+    class VectorMathPerfTest : public testing::Test {
+    public:
+        VectorMathPerfTest() {
+            // Initialize input and output vectors.
+            mInputVector.reset(static_cast<float*>(AlignedAlloc(
+                    sizeof(float) * kVectorSize, vector_math::kRequiredAlignment)));
+            mOutputVector.reset(static_cast<float*>(AlignedAlloc(
+                    sizeof(float) * kVectorSize, vector_math::kRequiredAlignment)));
+            std::fill(mInputVector.get(), mInputVector.get() + kVectorSize, 1.0f);
+            std::fill(mOutputVector.get(), mOutputVector.get() + kVectorSize, 0.0f);
+        }
+
+        VectorMathPerfTest(const VectorMathPerfTest&) = delete;
+
+        VectorMathPerfTest& operator=(const VectorMathPerfTest&) = delete;
+
+        // Runs |function| kBenchmarkIterations times and prints the number of
+        // calls per second under |name|.
+        template<typename Function>
+        void runBenchmark(const char* name, Function function) {
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < kBenchmarkIterations; ++i)
+                function();
+            std::chrono::duration<double> elapsed =
+                    std::chrono::steady_clock::now() - start;
+            printf("%-16s %12.0f runs/s (%d floats)\n", name,
+                   kBenchmarkIterations / elapsed.count(), kVectorSize);
+        }
+
+        void runFMulBenchmark(const char* name,
+                              void (* fn)(const float[], float, int, float[])) {
+            runBenchmark(name, [&]() {
+                fn(mInputVector.get(), kScale, kVectorSize, mOutputVector.get());
+            });
+        }
+
+        void runFMacBenchmark(const char* name,
+                              void (* fn)(const float[], float, int, float[])) {
+            runBenchmark(name, [&]() {
+                fn(mInputVector.get(), kScale, kVectorSize, mOutputVector.get());
+            });
+        }
+
+        // Mixes kMixInputs copies of the input vector into the output.
+        void runFMixBenchmark(const char* name,
+                              void (* fn)(const float* const[], const float[], int,
+                                          int, float[], bool)) {
+            std::vector<const float*> sources(kMixInputs, mInputVector.get());
+            std::vector<float> gains(kMixInputs, 1.0f / kMixInputs);
+            runBenchmark(name, [&]() {
+                fn(sources.data(), gains.data(), kMixInputs, kVectorSize,
+                   mOutputVector.get(), true);
+            });
+        }
+
+        void runFClampBenchmark(const char* name,
+                                void (* fn)(const float[], int, float[])) {
+            runBenchmark(name, [&]() {
+                fn(mInputVector.get(), kVectorSize, mOutputVector.get());
+            });
+        }
+
+        void runIsZeroBenchmark(const char* name, bool (* fn)(const float[], int)) {
+            // Worst case for the early exit: every value has to be inspected.
+            std::fill(mInputVector.get(), mInputVector.get() + kVectorSize, 0.0f);
+            volatile bool result = false;
+            runBenchmark(name, [&]() {
+                result = fn(mInputVector.get(), kVectorSize);
+            });
+            EXPECT_TRUE(result);
+        }
+
+        void runFStatsBenchmark(const char* name,
+                                vector_math::Statistics (* fn)(const float[], int,
+                                                               float)) {
+            volatile float result = 0;
+            runBenchmark(name, [&]() {
+                result = fn(mInputVector.get(), kVectorSize, 1.0f).sum_squares;
+            });
+            EXPECT_EQ(float(kVectorSize), result);
+        }
+
+    protected:
+        std::unique_ptr<float[], AlignedFreeDeleter> mInputVector;
+        std::unique_ptr<float[], AlignedFreeDeleter> mOutputVector;
+    };
+
+    // Benchmark FMUL() with each optimized implementation.
+    TEST_F(VectorMathPerfTest, FMUL) {
+        runFMulBenchmark("FMUL_C", vector_math::FMUL_C);
+#if defined(ARCH_CPU_X86_FAMILY)
+        runFMulBenchmark("FMUL_SSE", vector_math::FMUL_SSE);
+#endif
+#if defined(MM_ENABLE_AVX2)
+        if (CPU::Get().has_avx2())
+            runFMulBenchmark("FMUL_AVX2", vector_math::FMUL_AVX2);
+#endif
+    }
+
+    // Benchmark FMAC() with each optimized implementation.
+    TEST_F(VectorMathPerfTest, FMAC) {
+        runFMacBenchmark("FMAC_C", vector_math::FMAC_C);
+#if defined(ARCH_CPU_X86_FAMILY)
+        runFMacBenchmark("FMAC_SSE", vector_math::FMAC_SSE);
+#endif
+#if defined(MM_ENABLE_AVX2)
+        if (CPU::Get().has_avx2())
+            runFMacBenchmark("FMAC_AVX2", vector_math::FMAC_AVX2);
+#endif
+    }
+
+    // Benchmark FMIX() with each optimized implementation.
+    TEST_F(VectorMathPerfTest, FMIX) {
+        runFMixBenchmark("FMIX_C", vector_math::FMIX_C);
+#if defined(ARCH_CPU_X86_FAMILY)
+        runFMixBenchmark("FMIX_SSE", vector_math::FMIX_SSE);
+#endif
+#if defined(MM_ENABLE_AVX2)
+        if (CPU::Get().has_avx2())
+            runFMixBenchmark("FMIX_AVX2", vector_math::FMIX_AVX2);
+#endif
+    }
+
+    // Benchmark FCLAMP() with each optimized implementation.
+    TEST_F(VectorMathPerfTest, FCLAMP) {
+        runFClampBenchmark("FCLAMP_C", vector_math::FCLAMP_C);
+#if defined(ARCH_CPU_X86_FAMILY)
+        runFClampBenchmark("FCLAMP_SSE", vector_math::FCLAMP_SSE);
+#endif
+#if defined(MM_ENABLE_AVX2)
+        if (CPU::Get().has_avx2())
+            runFClampBenchmark("FCLAMP_AVX2", vector_math::FCLAMP_AVX2);
+#endif
+    }
+
+    // Benchmark IsZero() with each optimized implementation.
+    TEST_F(VectorMathPerfTest, IsZero) {
+        runIsZeroBenchmark("IsZero_C", vector_math::IsZero_C);
+#if defined(ARCH_CPU_X86_FAMILY)
+        runIsZeroBenchmark("IsZero_SSE", vector_math::IsZero_SSE);
+#endif
+#if defined(MM_ENABLE_AVX2)
+        if (CPU::Get().has_avx2())
+            runIsZeroBenchmark("IsZero_AVX2", vector_math::IsZero_AVX2);
+#endif
+    }
+
+    // Benchmark FSTATS() with each optimized implementation.
+    TEST_F(VectorMathPerfTest, FSTATS) {
+        runFStatsBenchmark("FSTATS_C", vector_math::FSTATS_C);
+#if defined(ARCH_CPU_X86_FAMILY)
+        runFStatsBenchmark("FSTATS_SSE", vector_math::FSTATS_SSE);
+#endif
+#if defined(MM_ENABLE_AVX2)
+        if (CPU::Get().has_avx2())
+            runFStatsBenchmark("FSTATS_AVX2", vector_math::FSTATS_AVX2);
+#endif
+    }
+}
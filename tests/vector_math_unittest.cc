@@ -0,0 +1,479 @@
+//
+// Created by wang rl on 2022/7/4.
+//
+
+#include <cmath>
+#include <memory>
+#include <gtest/gtest.h>
+
+#include "base/cpu/CPU.h"
+#include "base/memory/AlignedMemory.h"
+#include "media/base/VectorMath.h"
+#include "media/base/VectorMathTesting.h"
+
+namespace mm {
+    // Default test values.
+    static const float kScale = 0.5;
+    static const float kInputFillValue = 1.0;
+    static const float kOutputFillValue = 3.0;
+    // Use an odd size so the optimized versions also have to handle a tail.
+    static const int kVectorSize = 8192 + 3;
+
+    class VectorMathTest : public testing::Test {
+    public:
+        VectorMathTest() {
+            // Initialize input and output vectors.
+            mInputVector.reset(static_cast<float*>(AlignedAlloc(
+                    sizeof(float) * kVectorSize, vector_math::kRequiredAlignment)));
+            mOutputVector.reset(static_cast<float*>(AlignedAlloc(
+                    sizeof(float) * kVectorSize, vector_math::kRequiredAlignment)));
+        }
+
+        VectorMathTest(const VectorMathTest&) = delete;
+
+        VectorMathTest& operator=(const VectorMathTest&) = delete;
+
+        void fillTestVectors(float input, float output) {
+            // Setup input and output vectors.
+            std::fill(mInputVector.get(), mInputVector.get() + kVectorSize, input);
+            std::fill(mOutputVector.get(), mOutputVector.get() + kVectorSize, output);
+        }
+
+        void verifyOutput(float value) {
+            for (int i = 0; i < kVectorSize; ++i)
+                ASSERT_FLOAT_EQ(value, mOutputVector[i]) << "i = " << i;
+        }
+
+    protected:
+        std::unique_ptr<float[], AlignedFreeDeleter> mInputVector;
+        std::unique_ptr<float[], AlignedFreeDeleter> mOutputVector;
+    };
+
+    // Ensure each optimized vector_math::FMUL() method returns the same value.
+    TEST_F(VectorMathTest, FMUL) {
+        static const float kResult = kInputFillValue * kScale;
+
+        {
+            SCOPED_TRACE("FMUL");
+            fillTestVectors(kInputFillValue, kOutputFillValue);
+            vector_math::FMUL_C(mInputVector.get(), kScale, kVectorSize,
+                                mOutputVector.get());
+            verifyOutput(kResult);
+        }
+
+#if defined(ARCH_CPU_X86_FAMILY)
+        {
+            SCOPED_TRACE("FMUL_SSE");
+            fillTestVectors(kInputFillValue, kOutputFillValue);
+            vector_math::FMUL_SSE(mInputVector.get(), kScale, kVectorSize,
+                                  mOutputVector.get());
+            verifyOutput(kResult);
+        }
+#endif
+
+#if defined(MM_ENABLE_AVX2)
+        if (CPU::Get().has_avx2()) {
+            SCOPED_TRACE("FMUL_AVX2");
+            fillTestVectors(kInputFillValue, kOutputFillValue);
+            vector_math::FMUL_AVX2(mInputVector.get(), kScale, kVectorSize,
+                                   mOutputVector.get());
+            verifyOutput(kResult);
+        }
+#endif
+
+        {
+            SCOPED_TRACE("FMUL unaligned");
+            // Start one element into the buffers so the scalar prologue runs.
+            fillTestVectors(kInputFillValue, kOutputFillValue);
+            vector_math::FMUL(mInputVector.get() + 1, kScale, kVectorSize - 1,
+                              mOutputVector.get() + 1);
+            mOutputVector[0] = kResult;
+            verifyOutput(kResult);
+        }
+    }
+
+    // Ensure each optimized vector_math::FMAC() method returns the same value.
+    TEST_F(VectorMathTest, FMAC) {
+        static const float kResult = kInputFillValue * kScale + kOutputFillValue;
+        using FMACFunction = void (*)(const float[], float, int, float[]);
+        std::vector<std::pair<const char*, FMACFunction>> functions = {
+                {"FMAC_C", vector_math::FMAC_C},
+                {"FMAC",   vector_math::FMAC},
+#if defined(ARCH_CPU_X86_FAMILY)
+                {"FMAC_SSE", vector_math::FMAC_SSE},
+#endif
+        };
+#if defined(MM_ENABLE_AVX2)
+        if (CPU::Get().has_avx2())
+            functions.emplace_back("FMAC_AVX2", vector_math::FMAC_AVX2);
+#endif
+
+        for (const auto& function : functions) {
+            SCOPED_TRACE(function.first);
+            fillTestVectors(kInputFillValue, kOutputFillValue);
+            function.second(mInputVector.get(), kScale, kVectorSize,
+                            mOutputVector.get());
+            verifyOutput(kResult);
+
+            // Start one element into the buffers so the scalar prologue runs.
+            fillTestVectors(kInputFillValue, kOutputFillValue);
+            function.second(mInputVector.get() + 1, kScale, kVectorSize - 1,
+                            mOutputVector.get() + 1);
+            mOutputVector[0] = kResult;
+            verifyOutput(kResult);
+        }
+    }
+
+    // Ensure each optimized vector_math::FMIX() method sums in input order, so
+    // the results are identical for any number of inputs, with and without
+    // clipping, and with |dest| being one of the inputs.
+    TEST_F(VectorMathTest, FMIX) {
+        using FMIXFunction =
+                void (*)(const float* const[], const float[], int, int, float[], bool);
+        std::vector<std::pair<const char*, FMIXFunction>> functions = {
+                {"FMIX_C", vector_math::FMIX_C},
+                {"FMIX",   vector_math::FMIX},
+#if defined(ARCH_CPU_X86_FAMILY)
+                {"FMIX_SSE", vector_math::FMIX_SSE},
+#endif
+        };
+#if defined(MM_ENABLE_AVX2)
+        if (CPU::Get().has_avx2())
+            functions.emplace_back("FMIX_AVX2", vector_math::FMIX_AVX2);
+#endif
+
+        const int kMaxInputs = 70;
+        const int kLength = 1000 + 3;
+        std::vector<std::vector<float>> inputs(kMaxInputs,
+                                               std::vector<float>(kLength + 1));
+        std::vector<const float*> sources;
+        std::vector<float> gains;
+        for (int k = 0; k < kMaxInputs; ++k) {
+            for (int i = 0; i <= kLength; ++i)
+                inputs[k][i] = float((i * 37 + k * 11) % 200 - 100) / 100.0f;
+            // Offset every other input so the loads are misaligned.
+            sources.push_back(inputs[k].data() + k % 2);
+            gains.push_back(0.05f * (k % 7) + 0.1f);
+        }
+
+        for (int count : {0, 1, 2, 5, kMaxInputs}) {
+            for (bool clip : {false, true}) {
+                std::vector<float> expected(kLength);
+                for (int i = 0; i < kLength; ++i) {
+                    float sum = count ? sources[0][i] * gains[0] : 0.0f;
+                    for (int k = 1; k < count; ++k)
+                        sum += sources[k][i] * gains[k];
+                    expected[i] = clip ? std::min(std::max(sum, -1.0f), 1.0f) : sum;
+                }
+
+                for (const auto& function : functions) {
+                    SCOPED_TRACE(testing::Message() << function.first << " count "
+                                                    << count << " clip " << clip);
+                    fillTestVectors(0.0f, kOutputFillValue);
+                    function.second(sources.data(), gains.data(), count, kLength,
+                                    mOutputVector.get() + 1, clip);
+                    ASSERT_EQ(kOutputFillValue, mOutputVector[0]);
+                    ASSERT_EQ(0, memcmp(expected.data(), mOutputVector.get() + 1,
+                                        sizeof(float) * kLength));
+                    ASSERT_EQ(kOutputFillValue, mOutputVector[kLength + 1]);
+                }
+            }
+        }
+
+        // Accumulate into one of the inputs.
+        std::vector<float> expected(kLength);
+        for (int i = 0; i < kLength; ++i)
+            expected[i] = sources[0][i] * gains[0] + sources[1][i] * gains[1];
+        for (const auto& function : functions) {
+            SCOPED_TRACE(function.first);
+            std::vector<float> dest(inputs[1].begin() + 1, inputs[1].end());
+            const float* aliased[] = {sources[0], dest.data()};
+            function.second(aliased, gains.data(), 2, kLength, dest.data(), false);
+            ASSERT_EQ(0, memcmp(expected.data(), dest.data(), sizeof(float) * kLength));
+        }
+    }
+
+    // Ensure each optimized vector_math::FRAMP() method matches the scalar
+    // version exactly and follows the closed form.
+    TEST_F(VectorMathTest, FRAMP) {
+        using FRAMPFunction = void (*)(const float[], float, float, int, float[]);
+        std::vector<std::pair<const char*, FRAMPFunction>> functions = {
+                {"FRAMP",   vector_math::FRAMP},
+#if defined(ARCH_CPU_X86_FAMILY)
+                {"FRAMP_SSE", vector_math::FRAMP_SSE},
+#endif
+        };
+#if defined(MM_ENABLE_AVX2)
+        if (CPU::Get().has_avx2())
+            functions.emplace_back("FRAMP_AVX2", vector_math::FRAMP_AVX2);
+#endif
+
+        const float kStart = 0.25f;
+        const float kIncrement = 0.5f / kVectorSize;
+        std::vector<float> expected(kVectorSize);
+        for (int i = 0; i < kVectorSize; ++i)
+            mInputVector[i] = float(i % 200 - 100) / 100.0f;
+        vector_math::FRAMP_C(mInputVector.get(), kStart, kIncrement, kVectorSize,
+                             expected.data());
+        for (int i = 0; i < kVectorSize; ++i) {
+            ASSERT_NEAR(mInputVector[i] * (kStart + i * double(kIncrement)),
+                        expected[i], 1e-6);
+        }
+
+        for (const auto& function : functions) {
+            SCOPED_TRACE(function.first);
+            // Start one element into the output so the scalar prologue runs.
+            for (int offset : {0, 1}) {
+                std::fill(mOutputVector.get(), mOutputVector.get() + kVectorSize, 0.0f);
+                function.second(mInputVector.get() + offset, kStart, kIncrement,
+                                kVectorSize - offset, mOutputVector.get() + offset);
+                for (int i = offset; i < kVectorSize; ++i) {
+                    ASSERT_EQ(mInputVector[i] * (kStart + float(i - offset) * kIncrement),
+                              mOutputVector[i]) << i;
+                }
+            }
+            std::copy(expected.begin(), expected.end(), mOutputVector.get());
+            function.second(mInputVector.get(), kStart, kIncrement, kVectorSize,
+                            mInputVector.get());
+            ASSERT_EQ(0, memcmp(expected.data(), mInputVector.get(),
+                                sizeof(float) * kVectorSize));
+            for (int i = 0; i < kVectorSize; ++i)
+                mInputVector[i] = float(i % 200 - 100) / 100.0f;
+        }
+    }
+
+    // Ensure each optimized vector_math::FEXPRAMP() method matches the scalar
+    // version exactly and stays close to the closed form over a long ramp.
+    TEST_F(VectorMathTest, FEXPRAMP) {
+        using FEXPRAMPFunction = void (*)(const float[], float, float, int, float[]);
+        std::vector<std::pair<const char*, FEXPRAMPFunction>> functions = {
+                {"FEXPRAMP",   vector_math::FEXPRAMP},
+#if defined(ARCH_CPU_X86_FAMILY)
+                {"FEXPRAMP_SSE", vector_math::FEXPRAMP_SSE},
+#endif
+        };
+#if defined(MM_ENABLE_AVX2)
+        if (CPU::Get().has_avx2())
+            functions.emplace_back("FEXPRAMP_AVX2", vector_math::FEXPRAMP_AVX2);
+#endif
+
+        // From -60 dB to 0 dB.
+        const float kStart = 0.001f;
+        const float kRatio = float(std::pow(1000.0, 1.0 / kVectorSize));
+        fillTestVectors(kInputFillValue, kOutputFillValue);
+        std::vector<float> expected(kVectorSize);
+        vector_math::FEXPRAMP_C(mInputVector.get(), kStart, kRatio, kVectorSize,
+                                expected.data());
+        for (int i = 0; i < kVectorSize; ++i) {
+            const double gain = kStart * std::pow(double(kRatio), i);
+            ASSERT_NEAR(gain, expected[i], gain * 2e-5) << i;
+        }
+
+        for (const auto& function : functions) {
+            SCOPED_TRACE(function.first);
+            for (int len : {kVectorSize, 5}) {
+                std::fill(mOutputVector.get(), mOutputVector.get() + kVectorSize, 0.0f);
+                function.second(mInputVector.get(), kStart, kRatio, len,
+                                mOutputVector.get() + 1);
+                ASSERT_EQ(0, memcmp(expected.data(), mOutputVector.get() + 1,
+                                    sizeof(float) * (len - 1)));
+            }
+        }
+    }
+
+    // Ensure each optimized vector_math::FCROSSFADE() method matches the scalar
+    // version exactly and keeps the power constant.
+    TEST_F(VectorMathTest, FCROSSFADE) {
+        using FCROSSFADEFunction =
+                void (*)(const float[], const float[], float, float, int, float[]);
+        std::vector<std::pair<const char*, FCROSSFADEFunction>> functions = {
+                {"FCROSSFADE",   vector_math::FCROSSFADE},
+#if defined(ARCH_CPU_X86_FAMILY)
+                {"FCROSSFADE_SSE", vector_math::FCROSSFADE_SSE},
+#endif
+        };
+#if defined(MM_ENABLE_AVX2)
+        if (CPU::Get().has_avx2())
+            functions.emplace_back("FCROSSFADE_AVX2", vector_math::FCROSSFADE_AVX2);
+#endif
+
+        const float kIncrement = float(std::acos(0.0) / kVectorSize);
+        std::vector<float> ones(kVectorSize, 1.0f);
+        std::vector<float> zeros(kVectorSize, 0.0f);
+        std::vector<float> cosines(kVectorSize);
+        std::vector<float> sines(kVectorSize);
+        vector_math::FCROSSFADE_C(ones.data(), zeros.data(), 0, kIncrement,
+                                  kVectorSize, cosines.data());
+        vector_math::FCROSSFADE_C(zeros.data(), ones.data(), 0, kIncrement,
+                                  kVectorSize, sines.data());
+        for (int i = 0; i < kVectorSize; ++i) {
+            ASSERT_NEAR(std::cos(i * double(kIncrement)), cosines[i], 1e-5) << i;
+            ASSERT_NEAR(std::sin(i * double(kIncrement)), sines[i], 1e-5) << i;
+            ASSERT_NEAR(1.0, cosines[i] * cosines[i] + sines[i] * sines[i], 2e-6);
+        }
+
+        for (int i = 0; i < kVectorSize; ++i) {
+            mInputVector[i] = float(i % 200 - 100) / 100.0f;
+            mOutputVector[i] = float(i % 50) / 50.0f;
+        }
+        std::vector<float> expected(kVectorSize);
+        vector_math::FCROSSFADE_C(mInputVector.get(), mOutputVector.get(), 0.1f,
+                                  kIncrement, kVectorSize, expected.data());
+        for (const auto& function : functions) {
+            SCOPED_TRACE(function.first);
+            std::vector<float> in(mOutputVector.get(), mOutputVector.get() + kVectorSize);
+            // Write into one of the sources.
+            function.second(mInputVector.get(), in.data(), 0.1f, kIncrement,
+                            kVectorSize, in.data());
+            ASSERT_EQ(0, memcmp(expected.data(), in.data(), sizeof(float) * kVectorSize));
+        }
+    }
+
+    // Ensure each optimized vector_math::FCLAMP() method matches the scalar
+    // Float32SampleTypeTraits clipping, including NaN and infinities.
+    TEST_F(VectorMathTest, FCLAMP) {
+        const float kValues[] = {-5.0f, -1.0f, -0.5f, -0.0f, 0.0f, 0.25f, 1.0f,
+                                 5.0f, std::numeric_limits<float>::infinity(),
+                                 -std::numeric_limits<float>::infinity(),
+                                 std::numeric_limits<float>::quiet_NaN()};
+        for (int i = 0; i < kVectorSize; ++i)
+            mInputVector[i] = kValues[i % std::size(kValues)];
+
+        std::unique_ptr<float[], AlignedFreeDeleter> expected(static_cast<float*>(
+                AlignedAlloc(sizeof(float) * kVectorSize,
+                             vector_math::kRequiredAlignment)));
+        vector_math::FCLAMP_C(mInputVector.get(), kVectorSize, expected.get());
+        for (int i = 0; i < kVectorSize; ++i) {
+            ASSERT_LE(expected[i], 1.0f);
+            ASSERT_GE(expected[i], -1.0f);
+        }
+
+        auto verify = [&]() {
+            ASSERT_EQ(0, memcmp(expected.get(), mOutputVector.get(),
+                                sizeof(float) * kVectorSize));
+        };
+
+#if defined(ARCH_CPU_X86_FAMILY)
+        {
+            SCOPED_TRACE("FCLAMP_SSE");
+            std::fill(mOutputVector.get(), mOutputVector.get() + kVectorSize, 0.0f);
+            vector_math::FCLAMP_SSE(mInputVector.get(), kVectorSize,
+                                    mOutputVector.get());
+            verify();
+        }
+#endif
+
+#if defined(MM_ENABLE_AVX2)
+        if (CPU::Get().has_avx2()) {
+            SCOPED_TRACE("FCLAMP_AVX2");
+            std::fill(mOutputVector.get(), mOutputVector.get() + kVectorSize, 0.0f);
+            vector_math::FCLAMP_AVX2(mInputVector.get(), kVectorSize,
+                                     mOutputVector.get());
+            verify();
+        }
+#endif
+
+        {
+            SCOPED_TRACE("FCLAMP");
+            std::fill(mOutputVector.get(), mOutputVector.get() + kVectorSize, 0.0f);
+            vector_math::FCLAMP(mInputVector.get(), kVectorSize, mOutputVector.get());
+            verify();
+        }
+    }
+
+    // Ensure each optimized vector_math::IsZero() method finds a single non-zero
+    // value at any position.
+    TEST_F(VectorMathTest, IsZero) {
+        using IsZeroFunction = bool (*)(const float[], int);
+        std::vector<std::pair<const char*, IsZeroFunction>> functions = {
+                {"IsZero_C", vector_math::IsZero_C},
+                {"IsZero",   vector_math::IsZero},
+#if defined(ARCH_CPU_X86_FAMILY)
+                {"IsZero_SSE", vector_math::IsZero_SSE},
+#endif
+        };
+#if defined(MM_ENABLE_AVX2)
+        if (CPU::Get().has_avx2())
+            functions.emplace_back("IsZero_AVX2", vector_math::IsZero_AVX2);
+#endif
+
+        for (const auto& function : functions) {
+            SCOPED_TRACE(function.first);
+            fillTestVectors(0.0f, 0.0f);
+            EXPECT_TRUE(function.second(mInputVector.get(), kVectorSize));
+
+            mInputVector[kVectorSize / 2] = -0.0f;
+            EXPECT_TRUE(function.second(mInputVector.get(), kVectorSize));
+
+            for (int i : {0, 1, 17, kVectorSize / 2, kVectorSize - 1}) {
+                mInputVector[i] = 0.001f;
+                EXPECT_FALSE(function.second(mInputVector.get(), kVectorSize)) << i;
+                mInputVector[i] = std::numeric_limits<float>::quiet_NaN();
+                EXPECT_FALSE(function.second(mInputVector.get(), kVectorSize)) << i;
+                mInputVector[i] = 0.0f;
+            }
+        }
+    }
+
+    // Ensure each optimized vector_math::FSTATS() method agrees with the scalar
+    // version, also for unaligned input, NaN and values beyond the clip level.
+    TEST_F(VectorMathTest, FSTATS) {
+        using FSTATSFunction = vector_math::Statistics (*)(const float[], int, float);
+        std::vector<std::pair<const char*, FSTATSFunction>> functions = {
+                {"FSTATS", vector_math::FSTATS},
+#if defined(ARCH_CPU_X86_FAMILY)
+                {"FSTATS_SSE", vector_math::FSTATS_SSE},
+#endif
+        };
+#if defined(MM_ENABLE_AVX2)
+        if (CPU::Get().has_avx2())
+            functions.emplace_back("FSTATS_AVX2", vector_math::FSTATS_AVX2);
+#endif
+
+        for (int i = 0; i < kVectorSize; ++i)
+            mInputVector[i] = float(i % 9) / 4.0f - 1.0f;
+        mInputVector[kVectorSize / 3] = -1.5f;
+        mInputVector[kVectorSize / 2] = std::numeric_limits<float>::quiet_NaN();
+
+        // Skip the NaN for the sums.
+        const int len = kVectorSize / 2;
+        const vector_math::Statistics expected =
+                vector_math::FSTATS_C(mInputVector.get(), len, 1.0f);
+        EXPECT_FLOAT_EQ(1.5f, expected.peak);
+        EXPECT_EQ(std::count_if(mInputVector.get(), mInputVector.get() + len,
+                                [](float value) { return std::fabs(value) >= 1.0f; }),
+                  expected.clipped);
+
+        for (const auto& function : functions) {
+            SCOPED_TRACE(function.first);
+            for (int offset : {0, 1, 3}) {
+                const vector_math::Statistics expectedOffset =
+                        vector_math::FSTATS_C(mInputVector.get() + offset,
+                                              len - offset, 1.0f);
+                const vector_math::Statistics stats =
+                        function.second(mInputVector.get() + offset, len - offset, 1.0f);
+                EXPECT_EQ(expectedOffset.peak, stats.peak) << offset;
+                EXPECT_EQ(expectedOffset.clipped, stats.clipped) << offset;
+                EXPECT_NEAR(expectedOffset.sum, stats.sum, 1e-2) << offset;
+                EXPECT_NEAR(expectedOffset.sum_squares, stats.sum_squares,
+                            1e-5 * expectedOffset.sum_squares) << offset;
+            }
+
+            // NaN is neither a peak nor clipped.
+            const vector_math::Statistics stats =
+                    function.second(mInputVector.get(), kVectorSize, 1.0f);
+            EXPECT_FLOAT_EQ(1.5f, stats.peak);
+            EXPECT_TRUE(std::isnan(stats.sum));
+            EXPECT_EQ(expected.clipped +
+                      vector_math::FSTATS_C(mInputVector.get() + len,
+                                            kVectorSize - len, 1.0f).clipped,
+                      stats.clipped);
+
+            const vector_math::Statistics empty =
+                    function.second(mInputVector.get(), 0, 1.0f);
+            EXPECT_EQ(0.0f, empty.peak);
+            EXPECT_EQ(0.0f, empty.sum);
+            EXPECT_EQ(0, empty.clipped);
+        }
+    }
+}